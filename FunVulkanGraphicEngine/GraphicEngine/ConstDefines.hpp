@@ -11,6 +11,28 @@
 namespace GE
 {
 	constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+	// Reorder imported meshes for the vertex cache, overdraw and fetch locality before they are cached
+	constexpr bool OPTIMIZE_IMPORTED_MESHES = true;
+	// Simplified levels built for imported meshes on top of the full one, 0 turns lod generation off
+	constexpr uint32_t MESH_LOD_LEVELS = 4;
+	// Every level of an imported mesh is split into clusters this small, each culled on its own before drawing
+	constexpr uint32_t MESH_CLUSTER_MAX_VERTICES = 64;
+	constexpr uint32_t MESH_CLUSTER_MAX_TRIANGLES = 124;
+	// Frustum and back face culling of the clusters on the CPU. Off draws every level whole
+	constexpr bool CULL_MESH_CLUSTERS = true;
+	// Mounted at startup when it sits in the working directory. Built by the AssetPacker tool
+	constexpr const char* ASSET_PACK_PATH = "assets.gepk";
+	// Streamed textures start out with the mip levels no larger than this, the finer ones follow one per frame
+	constexpr uint32_t TEXTURE_STREAM_TAIL_SIZE = 64;
+	// Decoded color textures no larger than this share atlas pages instead of getting an image and sampler each
+	constexpr uint32_t ATLAS_MAX_TEXTURE_SIZE = 256;
+	constexpr uint32_t ATLAS_PAGE_SIZE = 2048;
+	// Bytes of the persistently mapped buffer every upload is staged in. Grows when the uploads in flight need more
+	constexpr VkDeviceSize STAGING_RING_SIZE = 64ull * 1024 * 1024;
+	// Streamed uploads copy on a transfer only queue family when the device has one, next to rendering instead of in between
+	constexpr bool USE_TRANSFER_QUEUE = true;
+	// Load timings, memory use and draw statistics on the console. Errors and warnings print either way
+	constexpr bool PRINT_ENGINE_STATS = false;
 	using ErrorMessage = std::string;
 
 
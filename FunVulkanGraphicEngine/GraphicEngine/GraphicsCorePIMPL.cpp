@@ -1,11 +1,74 @@
 #include "GraphicEngine/GraphicsCorePIMPL.hpp"
+#include "GraphicEngine/Utility/AssetPack.hpp"
+#include "GraphicEngine/Utility/FileMapping.hpp"
+#include "GraphicEngine/Utility/MeshClusters.hpp"
 
+#include <algorithm>
+#include <filesystem>
 #include <iostream>
+#include <unordered_map>
 
 namespace GE
 {
 	PipelinesIdMapping& pipelineMappingsController = PipelinesIdMapping::getInstance();
 
+	// Everything pumped in one frame shares a single upload submission. The cap only bounds how long that frame gets
+	constexpr size_t MaxTextureUploadsPerFrame = 32;
+
+	// A level is good enough while its simplification error covers less than this many pixels
+	constexpr float MaxLodErrorPixels = 1.0f;
+	constexpr auto LodReportInterval = std::chrono::seconds(5);
+
+	/// @brief Coarsest level of the mesh that still looks like the full one at its projected size.
+	/// ubo holds the camera view and projection, its model matrix is the one before dequantizing
+	MeshLod selectLod(const VerticesInternal& mesh, const UniformBufferObject& ubo, float viewportHeight)
+	{
+		if (mesh.lods.empty()) return { 0, mesh.indexCount, 0.0f };
+
+		const glm::vec3 center = glm::vec3(ubo.view * ubo.model * glm::vec4(mesh.boundsCenter, 1.0f));
+		const float scale = std::max({ glm::length(glm::vec3(ubo.model[0])), glm::length(glm::vec3(ubo.model[1])), glm::length(glm::vec3(ubo.model[2])) });
+		// Camera inside or right at the bounds keeps the full mesh
+		const float distance = std::max(glm::length(center) - mesh.boundsRadius * scale, 0.1f);
+		// proj[1][1] is 1 / tan(fov / 2), negative once y is flipped for vulkan
+		const float pixelsPerUnit = std::abs(ubo.proj[1][1]) * viewportHeight * 0.5f / distance;
+
+		size_t chosen = 0;
+		for (size_t i = 1; i < mesh.lods.size(); i++) {
+			if (mesh.lods[i].error * scale * pixelsPerUnit <= MaxLodErrorPixels) chosen = i;
+		}
+		return mesh.lods[chosen];
+	}
+
+	/// @brief Index ranges of lod left once its clusters are culled against the camera in ubo. Neighboring visible clusters
+	/// merge into one range. Meshes without clusters come back whole
+	std::vector<IndexRange> visibleRanges(const VerticesInternal& mesh, const MeshLod& lod, const UniformBufferObject& ubo, size_t& clustersTested, size_t& clustersCulled)
+	{
+		if (!CULL_MESH_CLUSTERS || mesh.clusters.empty()) return { { lod.firstIndex, lod.indexCount } };
+
+		const uint32_t lodEnd = lod.firstIndex + lod.indexCount;
+		const auto first = std::lower_bound(mesh.clusters.begin(), mesh.clusters.end(), lod.firstIndex, [](const MeshCluster& cluster, uint32_t index) { return cluster.firstIndex < index; });
+		const auto last = std::lower_bound(first, mesh.clusters.end(), lodEnd, [](const MeshCluster& cluster, uint32_t index) { return cluster.firstIndex < index; });
+		clustersTested += static_cast<size_t>(last - first);
+
+		// Bounds are in model space, before dequantizing
+		const Util::ClusterCuller culler(ubo.proj * ubo.view * ubo.model, ubo.view * ubo.model);
+		if (!culler.sphereVisible(mesh.boundsCenter, mesh.boundsRadius)) {
+			clustersCulled += static_cast<size_t>(last - first);
+			return {};
+		}
+
+		std::vector<IndexRange> ranges;
+		for (auto cluster = first; cluster != last; ++cluster) {
+			if (!culler.sphereVisible(cluster->center, cluster->radius) || culler.backFacing(*cluster)) {
+				clustersCulled++;
+				continue;
+			}
+			if (!ranges.empty() && ranges.back().firstIndex + ranges.back().indexCount == cluster->firstIndex) ranges.back().indexCount += cluster->indexCount;
+			else ranges.push_back({ cluster->firstIndex, cluster->indexCount });
+		}
+		return ranges;
+	}
+
 	std::vector<ShaderLoadInfo> DefaultShaderInfo2() {
 		ShaderLoadInfo i1; i1.fileName = "shaders/vert.spv"; i1.name = "main"; i1.type = ShaderType::Vertex;
 		ShaderLoadInfo i2; i2.fileName = "shaders/frag.spv"; i2.name = "main"; i2.type = ShaderType::Fragment;
@@ -21,7 +84,13 @@ namespace GE
 
 	GraphicsCorePIMPL::GraphicsCorePIMPL(){}
 	GraphicsCorePIMPL::~GraphicsCorePIMPL() {
+		textureLoader.Free();
+		useUploadBatch(nullptr);
+		uploadBatch.Free();
+		textureAtlas.Free();
 		graphicObjectController.clear();
+		Util::useStagingRing(nullptr);
+		stagingRing.Free();
 		swapchainHandle.Free();
 		for(auto & graphicPipeline : graphicPipelines) graphicPipeline->Free();
 		commandPool.Free();
@@ -36,6 +105,12 @@ namespace GE
 
 	ErrorMessage GraphicsCorePIMPL::init()
 	{
+		// Before anything is loaded, files the pack holds are read from it and everything else from the disk
+		if (std::filesystem::exists(ASSET_PACK_PATH)) {
+			if (auto errorMessage = Util::mountAssetPack(ASSET_PACK_PATH); !errorMessage.empty()) std::cout << "WARNING asset pack not mounted: " << errorMessage << std::endl;
+			else if constexpr (PRINT_ENGINE_STATS) std::cout << "Mounted " << ASSET_PACK_PATH << " with " << Util::mountedAssetPack()->entryCount() << " files" << std::endl;
+		}
+
 		try {
 			deviceGroup = GraphicDeviceGroup::CreateBaseGroup();
 		}
@@ -58,13 +133,45 @@ namespace GE
 		swapchainHandle.setCommandBuffer(commandPool.getCommandBuffers());
 
 
+		// Streamed uploads copy on the transfer queue when there is one, which then reads the staging ring as well
+		GraphicsUploadBatch::TransferQueue transferQueue{};
+		std::vector<uint32_t> stagingFamilies;
+		if (devices.queues.transferQueue != nullptr) {
+			const Util::QueueFamilyIndices families = Util::findQueueFamilies(devices.physicalDevice, devices.surface);
+			transferQueue = { devices.queues.transferQueue, *families.transferFamily, *families.graphicsFamily };
+			stagingFamilies = { *families.graphicsFamily, *families.transferFamily };
+			if constexpr (PRINT_ENGINE_STATS) std::cout << "Uploading on transfer queue family " << *families.transferFamily << std::endl;
+		}
+
+		// Before the first upload, so nothing stages into a buffer of its own
+		if (!stagingRing.init(devices.device, devices.physicalDevice, STAGING_RING_SIZE, stagingFamilies))
+		{
+			return std::string(stagingRing.getError());
+		}
+		Util::useStagingRing(&stagingRing);
+
 		graphicObjectController.init(devices.device, devices.physicalDevice, devices.queues.graphicsQueue);
+		if (!textureLoader.init(devices.device, devices.physicalDevice))
+		{
+			return std::string(textureLoader.getError());
+		}
+		if (!uploadBatch.init(devices.device, devices.physicalDevice, devices.queues.graphicsQueue, commandPool.getCommandPool(), transferQueue))
+		{
+			return std::string(uploadBatch.getError());
+		}
+		useUploadBatch(&uploadBatch);
+		if (!textureAtlas.init(devices.device, devices.physicalDevice))
+		{
+			return std::string(textureAtlas.getError());
+		}
 		
 		for (auto& pipelineData : pipelineMappingsController.getMetadataList())
 		{
 			graphicPipelines.push_back(pipelineMappingsController.getPipeline(pipelineData.first));
 			GraphicPipeline* graphicPipeline = graphicPipelines.back();
 			graphicPipeline->setShaders(pipelineData.second.shaders);
+			graphicPipeline->setTextured(pipelineData.second.textured);
+			graphicPipeline->setVertexLayout(pipelineData.second.vertexLayout);
 			graphicPipeline->setCommandBuffers(commandPool.getCommandBuffers());
 
 			graphicPipeline->setDevice(devices.device);
@@ -76,7 +183,7 @@ namespace GE
 			}	
 
 
-			graphicObjectController.initPipelineMeta(graphicPipeline->pipelineId, commandPool.getCommandPool(), graphicPipeline->Internals().descriptorSetLayout);
+			graphicObjectController.initPipelineMeta(graphicPipeline->pipelineId, commandPool.getCommandPool(), graphicPipeline->Internals().descriptorSetLayout, graphicPipeline->isTextured(), graphicPipeline->getVertexLayout());
 		}
 
 
@@ -87,6 +194,12 @@ namespace GE
 		glfwSetCursorPosCallback(deviceGroup.window->getGLFW(), cursorPositionCallbackHandler);
 		glfwSetScrollCallback(deviceGroup.window->getGLFW(), scrollCallbackHandler);
 
+		if constexpr (PRINT_ENGINE_STATS) {
+			const auto fileStats = Util::fileReadStats();
+			std::cout << "Startup file reads: " << fileStats.filesMapped << " mapped (" << fileStats.bytesMapped / 1024 << " KB), " << fileStats.filesRead << " read through the fallback, "
+				<< fileStats.bytesCopied / 1024 << " KB copied into " << fileStats.bufferAllocations << " heap buffers" << std::endl;
+		}
+
 		return "";
 	}
 
@@ -108,16 +221,43 @@ namespace GE
 
 		{
 			//bool state = objectPtr->verticesHandle.init(objectName, devices.device, devices.physicalDevice, devices.queues.graphicsQueue, graphicPipelines.front()->Internals().commandPool, graphicPipelines.front()->Internals().descriptorSetLayout);
-			bool state = objectPtr->verticesHandle.init(objectName, devices.device, devices.physicalDevice, devices.queues.graphicsQueue, commandPool.getCommandPool(), graphicPipelines.front()->Internals().descriptorSetLayout);
-			if (!state) {
-				return "ERROR with creating texture: " + std::string(objectPtr->verticesHandle.getError());
+			const VertexLayout vertexLayout = graphicPipelines.front()->getVertexLayout();
+			objectPtr->verticesHandle = graphicObjectController.acquireMesh(GraphicsMeshRegistry::keyForFile(objectName, vertexLayout), [&](VerticesHandle& mesh) {
+				return mesh.init(objectName, devices.device, devices.physicalDevice, devices.queues.graphicsQueue, commandPool.getCommandPool(), graphicPipelines.front()->Internals().descriptorSetLayout, vertexLayout);
+			});
+			if (!objectPtr->verticesHandle) {
+				return "ERROR with creating texture: " + graphicObjectController.getMeshError();
 			}
 		}
 		{
 			//bool state = objectPtr->textureHandle.init(textureName, devices.device, devices.physicalDevice, devices.queues.graphicsQueue, graphicPipelines.front()->Internals().commandPool, graphicPipelines.front()->Internals().descriptorSetLayout);
-			bool state = objectPtr->textureHandle.init(textureName, devices.device, devices.physicalDevice, devices.queues.graphicsQueue, commandPool.getCommandPool(), graphicPipelines.front()->Internals().descriptorSetLayout);
-			if (!state) {
-				return "ERROR with creating texture: " + std::string(objectPtr->textureHandle.getError());
+			MaterialDescription description;
+			description.pipelineId = objectPtr->pipelineId;
+			description.textureFile = std::string(textureName);
+			bool materialCreated = false;
+			objectPtr->material = graphicObjectController.acquireMaterial(description, [&](GraphicsMaterial&) { materialCreated = true; return true; });
+			if (!objectPtr->material) {
+				return "ERROR with creating texture: " + graphicObjectController.getMaterialError();
+			}
+			if (materialCreated) {
+				// Joins the frame's upload batch like the meshes, the material is drawn once it went through
+				std::weak_ptr<GraphicsMaterial> weakMaterial = objectPtr->material;
+				VkDescriptorSetLayout descriptorSetLayout = graphicPipelines.front()->Internals().descriptorSetLayout;
+				textureLoader.request(std::string(textureName), [this, weakMaterial, descriptorSetLayout](StagedTexture& staged) {
+					if (weakMaterial.expired()) return;
+					auto onReady = [weakMaterial](GraphicsTextureHandle& texture) {
+						auto material = weakMaterial.lock();
+						if (!texture.isReady() || !material) {
+							if (!texture.isReady()) std::cout << "ERROR loading texture " << texture.Internals().texture.textureFile << ": " << texture.getError() << std::endl;
+							texture.Free();
+							return;
+						}
+						material->setTexture(texture);
+					};
+					if (!uploadBatch.addTexture(staged, descriptorSetLayout, std::move(onReady))) {
+						std::cout << "ERROR loading texture " << staged.textureFile << ": " << uploadBatch.getError() << std::endl;
+					}
+				});
 			}
 		}
 
@@ -143,6 +283,13 @@ namespace GE
 			glfwPollEvents();
 
 			dispatchInputs();
+			// Textures decoded by the loader workers and the buffers of meshes created since the last frame are queued into the
+			// upload batch and go to the GPU in one submission. The frame is queued behind it without waiting, uploads of
+			// earlier frames that finished hand their textures and meshes over
+			textureLoader.pumpCompleted(MaxTextureUploadsPerFrame);
+			if (!textureAtlas.flush(uploadBatch)) { std::cout << "ERROR " << textureAtlas.getError() << std::endl; }
+			if (!uploadBatch.flush()) { std::cout << "ERROR " << uploadBatch.getError() << std::endl; }
+			if (!uploadBatch.poll()) { std::cout << "ERROR " << uploadBatch.getError() << std::endl; }
 			drawFrame();
 
 			if (shutdownFlag != nullptr && shutdownFlag->load() == true) { break; }
@@ -162,7 +309,7 @@ namespace GE
 						continue;
 					}
 
-					graphicObjectController.initPipelineMeta(pipeline->pipelineId, commandPool.getCommandPool(), pipeline->Internals().descriptorSetLayout);
+					graphicObjectController.initPipelineMeta(pipeline->pipelineId, commandPool.getCommandPool(), pipeline->Internals().descriptorSetLayout, pipeline->isTextured(), pipeline->getVertexLayout());
 				}
 
 			}
@@ -234,23 +381,65 @@ namespace GE
 				swapchainHandle.beginRenderPass(currentFrame, imageIndex, background);
 				for (auto& pipe : graphicPipelines)
 				{
-					auto ids = graphicObjectController.getIds(pipe->pipelineId);
-					for (auto& id : ids)
+					// Objects sharing a material are drawn back to back under a single descriptor set bind
+					struct ObjectDraw { MeshPtr mesh; std::vector<IndexRange> ranges; ObjectPushConstants constants; };
+					struct MaterialDraws { MaterialPtr material; std::vector<ObjectDraw> draws; };
+					std::vector<MaterialDraws> materialDraws;
+					std::unordered_map<const GraphicsMaterial*, size_t> materialSlots;
+					for (auto id : graphicObjectController.getIds(pipe->pipelineId))
 					{
 						auto objPtr = graphicObjectController.retrieveObject(id);
-						auto uboData = objPtr->getUBO();
-						if (!objPtr->textureHandle.Internals().ubo.uniformBuffersMapped.empty())
-							memcpy(objPtr->textureHandle.Internals().ubo.uniformBuffersMapped[currentFrame], &uboData, sizeof(uboData));
+						if (!objPtr->verticesHandle || !objPtr->verticesHandle->isReady() || !objPtr->material || !objPtr->material->isReady()) continue; // still loading
+						const auto uboData = objPtr->getUBO();
+						auto& mesh = objPtr->verticesHandle->Internals();
+						trianglesFull += (mesh.lods.empty() ? mesh.indexCount : mesh.lods[0].indexCount) / 3;
+						ObjectDraw draw{ objPtr->verticesHandle, visibleRanges(mesh, selectLod(mesh, uboData, static_cast<float>(swapchainExtent.height)), uboData, clustersTested, clustersCulled) };
+						if (draw.ranges.empty()) continue; // every cluster culled
+						// dequantize takes quantized positions back to model space
+						draw.constants.modelViewProj = uboData.proj * uboData.view * uboData.model * mesh.dequantize;
+						auto [slot, added] = materialSlots.try_emplace(objPtr->material.get(), materialDraws.size());
+						if (added) materialDraws.push_back({ objPtr->material, {} });
+						materialDraws[slot->second].draws.push_back(std::move(draw));
 					}
+					if (materialDraws.empty()) continue;
+
 					swapchainHandle.bindPipeline(currentFrame, pipe->Internals().graphicsPipeline);
-					for (auto& id : ids)
+					for (auto& [material, draws] : materialDraws)
 					{
-						auto objPtr = graphicObjectController.retrieveObject(id);
-						swapchainHandle.drawVertices(currentFrame, pipe->Internals().pipelineLayout, objPtr->verticesHandle.Internals().indexBuffer, (uint32_t)objPtr->verticesHandle.Internals().indices.size(), objPtr->verticesHandle.Internals().vertexBuffer, objPtr->textureHandle.Internals().descriptorSets[currentFrame]);
+						// This frame's fence signalled, its descriptor set can take the constants and the sampler of newly streamed mip levels
+						material->prepareFrame(currentFrame);
+						swapchainHandle.bindDescriptorSet(currentFrame, pipe->Internals().pipelineLayout, material->descriptorSet(currentFrame));
+						descriptorSetBinds++;
+						for (auto& draw : draws)
+						{
+							auto& mesh = draw.mesh->Internals();
+							swapchainHandle.drawVertices(currentFrame, pipe->Internals().pipelineLayout, mesh.indexBuffer, mesh.indexType, draw.ranges, mesh.vertexBuffer, draw.constants);
+							objectDraws += draw.ranges.size();
+							for (const auto& range : draw.ranges) trianglesDrawn += range.indexCount / 3;
+						}
 					}
 				}
 				swapchainHandle.endRenderPass(currentFrame);
 			}
+			framesReported++;
+
+			if (auto now = std::chrono::steady_clock::now(); now - lastLodReport >= LodReportInterval) {
+				if constexpr (PRINT_ENGINE_STATS) {
+					if (trianglesFull > 0) std::cout << "LOD and culling drew " << trianglesDrawn << " of " << trianglesFull << " triangles over the last " << LodReportInterval.count() << " s" << std::endl;
+					if (clustersTested > 0) std::cout << "Culled " << clustersCulled << " of " << clustersTested << " clusters" << std::endl;
+					std::cout << "Meshes hold " << VerticesHandle::totalHostBytes() / 1024 << " KB of host memory" << std::endl;
+					std::cout << "Staging ring holds " << stagingRing.used() / 1024 << " of " << stagingRing.capacity() / 1024 << " KB" << std::endl;
+					if (framesReported > 0) std::cout << "Bound " << static_cast<double>(descriptorSetBinds) / framesReported << " descriptor sets for " << static_cast<double>(objectDraws) / framesReported << " draws per frame" << std::endl;
+				}
+				trianglesDrawn = 0;
+				trianglesFull = 0;
+				clustersTested = 0;
+				clustersCulled = 0;
+				descriptorSetBinds = 0;
+				objectDraws = 0;
+				framesReported = 0;
+				lastLodReport = now;
+			}
 
 
 			VkSubmitInfo submitInfo{};
@@ -8,11 +8,16 @@
 #include "GraphicEngine/GraphicsVertex.hpp"
 #include "GraphicEngine/GraphicsDevice.hpp"
 #include "GraphicEngine/GraphicsObjectController.hpp"
+#include "GraphicEngine/GraphicsTextureAtlas.hpp"
+#include "GraphicEngine/GraphicsTextureLoader.hpp"
+#include "GraphicEngine/GraphicsUploadBatch.hpp"
 #include "GraphicEngine/PipelinesIdMapping.hpp"
+#include "GraphicEngine/Utility/StagingRing.hpp"
 
 #include "include/input/InputBase.hpp"
 
 #include <array>
+#include <chrono>
 #include <functional>
 #include <queue>
 
@@ -65,6 +70,22 @@ namespace GE {
 
 		bool viewPortDirty{false};
 		GraphicsObjectController graphicObjectController;
+		/// @brief Every upload is staged in here, outlives everything that uploads
+		Util::StagingRing stagingRing;
+		GraphicsTextureLoader textureLoader;
+		GraphicsUploadBatch uploadBatch;
+		GraphicsTextureAtlas textureAtlas;
+
+		// Triangles drawn with the chosen lods and culled clusters against the full meshes, reported every few seconds
+		size_t trianglesDrawn{ 0 };
+		size_t trianglesFull{ 0 };
+		size_t clustersTested{ 0 };
+		size_t clustersCulled{ 0 };
+		// Material binds against draws, reported with the triangles as averages per frame
+		size_t descriptorSetBinds{ 0 };
+		size_t objectDraws{ 0 };
+		size_t framesReported{ 0 };
+		std::chrono::steady_clock::time_point lastLodReport{ std::chrono::steady_clock::now() };
 
 
 		std::atomic<bool>* shutdownFlag{nullptr};
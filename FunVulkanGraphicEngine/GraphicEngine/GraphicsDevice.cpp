@@ -172,6 +172,8 @@ namespace GE {
 		if (!indices.isComplete()) { throw std::runtime_error( "Fail to find queue family for the current device"); }
 		std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 		std::set<uint32_t> uniqueQueueFamilies = { *indices.graphicsFamily, *indices.presentFamily };
+		const bool useTransferQueue = USE_TRANSFER_QUEUE && indices.transferFamily.has_value();
+		if (useTransferQueue) { uniqueQueueFamilies.insert(*indices.transferFamily); }
 
 		// Queue priority (0.0 - 1.0 ) based on a float value system
 		float queuePriority = 1.0f;
@@ -185,8 +187,13 @@ namespace GE {
 		}
 
 
+		VkPhysicalDeviceFeatures supportedFeatures{};
+		vkGetPhysicalDeviceFeatures(instance->physicalDevice, &supportedFeatures);
+
 		VkPhysicalDeviceFeatures deviceFeatures{};
 		deviceFeatures.samplerAnisotropy = VK_TRUE;
+		// Lets .gtex textures stay block compressed on the GPU. Without it they are decompressed while loading
+		deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
 
 		// CreatInfo requires the 2 structures above.
 		VkDeviceCreateInfo createInfo{};
@@ -220,6 +227,7 @@ namespace GE {
 		// fill out our graphics queue witht the newly created logical device
 		vkGetDeviceQueue(instance->device, indices.graphicsFamily.value(), 0, &instance->queues.graphicsQueue);
 		vkGetDeviceQueue(instance->device, indices.presentFamily.value(), 0, &instance->queues.presentQueue);
+		if (useTransferQueue) { vkGetDeviceQueue(instance->device, indices.transferFamily.value(), 0, &instance->queues.transferQueue); }
 
 
 
@@ -0,0 +1,97 @@
+#include "GraphicEngine/GraphicsMaterial.hpp"
+
+#include <cstring>
+
+namespace GE
+{
+	GraphicsMaterial::GraphicsMaterial(MaterialDescription description) : materialDescription(std::move(description)) {}
+	GraphicsMaterial::~GraphicsMaterial() = default;
+
+	void GraphicsMaterial::Free()
+	{
+		texture.Free();
+		texture = GraphicsTextureHandle(); // not ready anymore, and a second Free is harmless
+	}
+	std::string_view GraphicsMaterial::getError() const { return texture.getError(); }
+	const MaterialDescription& GraphicsMaterial::description() const { return materialDescription; }
+	bool GraphicsMaterial::isReady() const { return texture.isReady(); }
+
+	void GraphicsMaterial::setTexture(GraphicsTextureHandle& texture)
+	{
+		Free();
+		this->texture = texture;
+	}
+
+	GraphicsTextureHandle& GraphicsMaterial::textureHandle() { return texture; }
+
+	void GraphicsMaterial::prepareFrame(size_t frame)
+	{
+		texture.bindResidentLevels(frame);
+
+		auto& mapped = texture.Internals().ubo.uniformBuffersMapped;
+		if (frame >= mapped.size()) return;
+		MaterialUniforms uniforms{};
+		uniforms.uvScaleOffset = texture.Internals().texture.uvScaleOffset; // the region of an atlas page, or the whole image
+		uniforms.tint = materialDescription.constants.tint;
+		std::memcpy(mapped[frame], &uniforms, sizeof(uniforms));
+	}
+
+	VkDescriptorSet GraphicsMaterial::descriptorSet(size_t frame) const { return texture.Internals().descriptorSets.at(frame); }
+
+
+
+	GraphicsMaterialRegistry::GraphicsMaterialRegistry() = default;
+	GraphicsMaterialRegistry::~GraphicsMaterialRegistry() = default;
+
+	GraphicsMaterialRegistry::Key GraphicsMaterialRegistry::keyFor(const MaterialDescription& description)
+	{
+		const glm::vec4& tint = description.constants.tint;
+		return std::to_string(description.pipelineId) + ":" + std::to_string(static_cast<uint32_t>(description.usage)) + ":" + (description.tiling ? "tiled" : "clamped")
+			+ ":" + std::to_string(tint.x) + "," + std::to_string(tint.y) + "," + std::to_string(tint.z) + "," + std::to_string(tint.w) + ":" + description.textureFile;
+	}
+
+	MaterialPtr GraphicsMaterialRegistry::acquire(const MaterialDescription& description, const Loader& loader)
+	{
+		const Key key = keyFor(description);
+		std::lock_guard lock(mutex);
+		if (auto iter = materials.find(key); iter != materials.end()) {
+			if (MaterialPtr existing = iter->second.lock()) return existing;
+		}
+
+		// The last object using it frees the uniform buffers, descriptor sets and texture
+		std::shared_ptr<GraphicsMaterial> material(new GraphicsMaterial(description), [](GraphicsMaterial* material) {
+			material->Free();
+			delete material;
+		});
+		if (!loader(*material)) {
+			currentError = std::string(material->getError());
+			return nullptr;
+		}
+
+		purgeExpired();
+		materials[key] = material;
+		return material;
+	}
+
+	size_t GraphicsMaterialRegistry::size() const
+	{
+		std::lock_guard lock(mutex);
+		size_t alive = 0;
+		for (auto& [_, material] : materials) alive += material.expired() ? 0 : 1;
+		return alive;
+	}
+
+	std::string GraphicsMaterialRegistry::getError() const
+	{
+		std::lock_guard lock(mutex);
+		return currentError;
+	}
+
+	void GraphicsMaterialRegistry::purgeExpired()
+	{
+		for (auto iter = materials.begin(); iter != materials.end();) {
+			if (iter->second.expired()) iter = materials.erase(iter);
+			else ++iter;
+		}
+	}
+}
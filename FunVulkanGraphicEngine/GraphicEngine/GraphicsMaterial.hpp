@@ -0,0 +1,91 @@
+#pragma once
+
+#include "GraphicEngine/GraphicsVertex.hpp"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace GE
+{
+	/// @brief Values a material hands its shaders next to the texture
+	struct MaterialConstants
+	{
+		glm::vec4 tint{ 1.0f }; // multiplies the sampled or vertex color
+	};
+
+	/// @brief Everything that makes objects draw with the same GPU state. Equal descriptions share one material
+	struct MaterialDescription
+	{
+		uint64_t pipelineId{ 0 };
+		std::string textureFile; // empty for untextured pipelines
+		TextureUsage usage{ TextureUsage::Color };
+		/// @brief Uvs outside [0,1] repeat the texture. Such textures keep an image of their own, atlas pages only clamp
+		bool tiling{ false };
+		MaterialConstants constants;
+	};
+
+	/// @brief Pipeline, texture and constants shared by every object drawn with them. Owns one descriptor set per frame
+	/// in flight, so the draw loop binds it once and only pushes each object's matrix after that
+	class GraphicsMaterial
+	{
+	public:
+		explicit GraphicsMaterial(MaterialDescription description);
+		~GraphicsMaterial();
+		GraphicsMaterial(const GraphicsMaterial&) = delete;
+		GraphicsMaterial& operator=(const GraphicsMaterial&) = delete;
+		void Free();
+		std::string_view getError() const;
+
+		const MaterialDescription& description() const;
+		/// @brief False until the texture arrived, objects using the material are skipped until then
+		bool isReady() const;
+
+		/// @brief Takes over texture, atlased or not. Its uniform buffers and descriptor sets become the material's
+		void setTexture(GraphicsTextureHandle& texture);
+		/// @brief The texture, e.g. to stream in more mip levels
+		GraphicsTextureHandle& textureHandle();
+
+		/// @brief Writes the constants into the uniform buffer of frame and points its set at newly streamed mip levels.
+		/// Only call once the frame's fence signalled
+		void prepareFrame(size_t frame);
+		VkDescriptorSet descriptorSet(size_t frame) const;
+
+	private:
+		MaterialDescription materialDescription;
+		GraphicsTextureHandle texture;
+	};
+	using MaterialPtr = std::shared_ptr<GraphicsMaterial>;
+
+
+	/// @brief Hands out shared materials, one per description no matter how many objects use it.
+	/// A material is freed when the last MaterialPtr goes away
+	class GraphicsMaterialRegistry
+	{
+	public:
+		using Key = std::string;
+		using Loader = std::function<bool(GraphicsMaterial&)>;
+
+		GraphicsMaterialRegistry();
+		~GraphicsMaterialRegistry();
+
+		static Key keyFor(const MaterialDescription& description);
+
+		/// @brief Returns the material for description. When there is none, loader sets up a new one which is then shared.
+		/// Returns nullptr when the loader fails, the reason can be read from getError()
+		MaterialPtr acquire(const MaterialDescription& description, const Loader& loader);
+
+		/// @brief Number of materials that are still alive
+		size_t size() const;
+		std::string getError() const;
+
+	private:
+		void purgeExpired();
+
+		std::unordered_map<Key, std::weak_ptr<GraphicsMaterial>> materials;
+		std::string currentError;
+		mutable std::mutex mutex;
+	};
+}
@@ -0,0 +1,77 @@
+#include "GraphicEngine/GraphicsMeshRegistry.hpp"
+#include "GraphicEngine/Utility/Hashing.hpp"
+
+#include <cstdio>
+
+namespace GE
+{
+	GraphicsMeshRegistry::GraphicsMeshRegistry() = default;
+	GraphicsMeshRegistry::~GraphicsMeshRegistry() = default;
+
+	// The same geometry packed for another pipeline is a different buffer. One kept on the host is a different mesh too,
+	// else whoever loaded it first decides whether the geometry can be read back
+	GraphicsMeshRegistry::Key GraphicsMeshRegistry::keyForFile(std::string_view filePath, VertexLayout vertexLayout, MeshResidency residency)
+	{
+		return "file:" + std::to_string(static_cast<uint32_t>(vertexLayout)) + ":" + std::to_string(static_cast<uint32_t>(residency)) + ":" + std::string(filePath);
+	}
+
+	// A hit hands out the buffers without looking at the geometry again, so one 64 bit hash is not enough to tell
+	// meshes apart. The key also holds both counts and a second hash of the bytes under another seed, two meshes
+	// only share buffers when all of them match
+	GraphicsMeshRegistry::Key GraphicsMeshRegistry::keyForContent(std::span<const Vertex> vertices, std::span<const uint32_t> indices, VertexLayout vertexLayout, MeshResidency residency)
+	{
+		constexpr uint64_t SecondSeed = 0x6a09e667f3bcc909ULL;
+		uint64_t hash = Util::hashBytes(vertices.data(), vertices.size() * sizeof(Vertex));
+		hash = Util::hashBytes(indices.data(), indices.size() * sizeof(uint32_t), hash);
+		uint64_t secondHash = Util::hashBytes(vertices.data(), vertices.size() * sizeof(Vertex), SecondSeed);
+		secondHash = Util::hashBytes(indices.data(), indices.size() * sizeof(uint32_t), secondHash ^ SecondSeed);
+
+		char text[80];
+		std::snprintf(text, sizeof(text), "%zu:%zu:%016llx%016llx", vertices.size(), indices.size(), static_cast<unsigned long long>(hash), static_cast<unsigned long long>(secondHash));
+		return "content:" + std::to_string(static_cast<uint32_t>(vertexLayout)) + ":" + std::to_string(static_cast<uint32_t>(residency)) + ":" + std::string(text);
+	}
+
+	MeshPtr GraphicsMeshRegistry::acquire(const Key& key, const Loader& loader)
+	{
+		std::lock_guard lock(mutex);
+		if (auto iter = meshes.find(key); iter != meshes.end()) {
+			if (MeshPtr existing = iter->second.lock()) return existing;
+		}
+
+		// The last owner frees the GPU buffers
+		std::shared_ptr<VerticesHandle> mesh(new VerticesHandle(), [](VerticesHandle* handle) {
+			handle->Free();
+			delete handle;
+		});
+		if (!loader(*mesh)) {
+			currentError = std::string(mesh->getError());
+			return nullptr;
+		}
+
+		purgeExpired();
+		meshes[key] = mesh;
+		return mesh;
+	}
+
+	size_t GraphicsMeshRegistry::size() const
+	{
+		std::lock_guard lock(mutex);
+		size_t alive = 0;
+		for (auto& [_, mesh] : meshes) alive += mesh.expired() ? 0 : 1;
+		return alive;
+	}
+
+	std::string GraphicsMeshRegistry::getError() const
+	{
+		std::lock_guard lock(mutex);
+		return currentError;
+	}
+
+	void GraphicsMeshRegistry::purgeExpired()
+	{
+		for (auto iter = meshes.begin(); iter != meshes.end();) {
+			if (iter->second.expired()) iter = meshes.erase(iter);
+			else ++iter;
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "GraphicEngine/GraphicsVertex.hpp"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace GE
+{
+	using MeshPtr = std::shared_ptr<const VerticesHandle>;
+
+	/// @brief Hands out shared GPU geometry. Every key owns at most one vertex/index buffer pair,
+	/// no matter how many objects draw it. The buffers are freed when the last MeshPtr goes away
+	class GraphicsMeshRegistry
+	{
+	public:
+		using Key = std::string;
+		using Loader = std::function<bool(VerticesHandle&)>;
+
+		GraphicsMeshRegistry();
+		~GraphicsMeshRegistry();
+
+		static Key keyForFile(std::string_view filePath, VertexLayout vertexLayout = VertexLayout::Float, MeshResidency residency = MeshResidency::BoundsOnly);
+		static Key keyForContent(std::span<const Vertex> vertices, std::span<const uint32_t> indices, VertexLayout vertexLayout = VertexLayout::Float, MeshResidency residency = MeshResidency::BoundsOnly);
+
+		/// @brief Returns the mesh stored under key. When there is none, loader fills a new handle which is then shared.
+		/// Returns nullptr when the loader fails, the reason can be read from getError()
+		MeshPtr acquire(const Key& key, const Loader& loader);
+
+		/// @brief Number of meshes that are still alive
+		size_t size() const;
+		std::string getError() const;
+
+	private:
+		void purgeExpired();
+
+		std::unordered_map<Key, std::weak_ptr<const VerticesHandle>> meshes;
+		std::string currentError;
+		mutable std::mutex mutex;
+	};
+}
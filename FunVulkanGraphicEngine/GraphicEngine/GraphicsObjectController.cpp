@@ -22,13 +22,15 @@ namespace GE
 		this->graphicsQueue = graphicsQueue;
 	}
 
-	void GraphicsObjectController::initPipelineMeta(uint64_t pipelineId, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout)
+	void GraphicsObjectController::initPipelineMeta(uint64_t pipelineId, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout, bool textured, VertexLayout vertexLayout)
 	{
 		std::lock_guard lock(mutex);
 		PipelineMetaInfo info;
 		info.pipelineId = pipelineId;
 		info.commandPool = commandPool;
 		info.descriptorSetLayout = descriptorSetLayout;
+		info.textured = textured;
+		info.vertexLayout = vertexLayout;
 		this->pipelineMetaInfoOptions.push_back(std::move(info));
 	}
 
@@ -44,9 +46,10 @@ namespace GE
 		std::lock_guard lock(mutex);
 		for (auto& [_, obj] : objectList)
 		{
-			obj->textureHandle.Free();
-			obj->verticesHandle.Free();
+			obj->material.reset();
+			obj->verticesHandle.reset(); // the registries free the buffers once nobody holds them
 		}
+		objectList.clear();
 	}
 	void GraphicsObjectController::remove(uint64_t id)
 	{
@@ -91,6 +94,37 @@ namespace GE
 		return pipelineMetaInfoOptions;
 	}
 
+	MeshPtr GraphicsObjectController::acquireMesh(const GraphicsMeshRegistry::Key& key, const GraphicsMeshRegistry::Loader& loader)
+	{
+		// The registry has its own lock, so a slow first load does not block the render loop
+		return meshRegistry.acquire(key, loader);
+	}
+
+	size_t GraphicsObjectController::meshCount() const
+	{
+		return meshRegistry.size();
+	}
+
+	std::string GraphicsObjectController::getMeshError() const
+	{
+		return meshRegistry.getError();
+	}
+
+	MaterialPtr GraphicsObjectController::acquireMaterial(const MaterialDescription& description, const GraphicsMaterialRegistry::Loader& loader)
+	{
+		return materialRegistry.acquire(description, loader);
+	}
+
+	size_t GraphicsObjectController::materialCount() const
+	{
+		return materialRegistry.size();
+	}
+
+	std::string GraphicsObjectController::getMaterialError() const
+	{
+		return materialRegistry.getError();
+	}
+
 	std::lock_guard<std::mutex> GraphicsObjectController::Lock()
 	{
 		return std::lock_guard(mutex);
@@ -99,8 +133,9 @@ namespace GE
 	void GraphicsObjectController::removeLockless(uint64_t id)
 	{
 		if (auto it = objectList.find(id); it != objectList.end()) {
-			it->second->textureHandle.Free();
-			it->second->verticesHandle.Free();
+			it->second->material.reset();
+			it->second->verticesHandle.reset();
+			objectList.erase(it);
 		}
 	}
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "GraphicEngine/GraphicsVertex.hpp"
+#include "GraphicEngine/GraphicsMaterial.hpp"
+#include "GraphicEngine/GraphicsMeshRegistry.hpp"
 #include <unordered_map>
 #include <mutex>
 #include <memory>
@@ -12,8 +14,8 @@ namespace GE
 
 	class GraphicObject {
 	public:
-		VerticesHandle verticesHandle;
-		GraphicsTextureHandle textureHandle;
+		MeshPtr verticesHandle; // shared with every other object drawing the same mesh
+		MaterialPtr material; // shared with every other object drawing with the same pipeline, texture and constants
 
 		UniformBufferObject getUBO() const;
 		void setUBO(const UniformBufferObject&);
@@ -33,13 +35,15 @@ namespace GE
 			uint64_t pipelineId;
 			VkCommandPool commandPool{ nullptr };
 			VkDescriptorSetLayout descriptorSetLayout{ nullptr };
+			bool textured{ true };
+			VertexLayout vertexLayout{ VertexLayout::Float };
 		};
 
 
 	public:
 		GraphicsObjectController() = default;
 		void init(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue);
-		void initPipelineMeta(uint64_t pipelineId, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout);
+		void initPipelineMeta(uint64_t pipelineId, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout, bool textured = true, VertexLayout vertexLayout = VertexLayout::Float);
 		void resetPipelineMeta();
 
 		void clear();
@@ -52,12 +56,24 @@ namespace GE
 
 		std::vector<PipelineMetaInfo> getOptions() const;
 
+		/// @brief Shared geometry for key, loading it through loader the first time. See GraphicsMeshRegistry
+		MeshPtr acquireMesh(const GraphicsMeshRegistry::Key& key, const GraphicsMeshRegistry::Loader& loader);
+		size_t meshCount() const;
+		std::string getMeshError() const;
+
+		/// @brief Shared material for description, set up through loader the first time. See GraphicsMaterialRegistry
+		MaterialPtr acquireMaterial(const MaterialDescription& description, const GraphicsMaterialRegistry::Loader& loader);
+		size_t materialCount() const;
+		std::string getMaterialError() const;
+
 		std::lock_guard<std::mutex> Lock();
 
 	private:
 		void removeLockless(uint64_t id);
 
 		std::unordered_map<uint64_t, GraphObjPtr> objectList;
+		GraphicsMeshRegistry meshRegistry;
+		GraphicsMaterialRegistry materialRegistry;
 		uint64_t currentCounter = 1;
 
 
@@ -1,13 +1,16 @@
 #include "GraphicEngine/GraphicsPipeline.hpp"
 #include "GraphicEngine/GraphicsQueue.hpp"
+#include "GraphicEngine/Utility/AssetPack.hpp"
 #include "GraphicEngine/Utility/DeviceSupport.hpp"
+#include "GraphicEngine/Utility/FileMapping.hpp"
 
 #include <filesystem>
 
 namespace
 {
 	// helper function to create a shader object.
-	VkShaderModule createShaderModule(VkDevice device, const std::vector<char>& code)
+	// code has to stay 4 byte aligned, which mapped files and heap buffers both are
+	VkShaderModule createShaderModule(VkDevice device, std::span<const char> code)
 	{
 		VkShaderModuleCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -92,7 +95,7 @@ namespace GE
 	{
 		for (auto& shader : shaders)
 		{
-			if (!std::filesystem::exists(shader.fileName))
+			if (!Util::assetExists(shader.fileName))
 			{
 				currentError = "Shader file " + shader.fileName + " doesn't exist.";
 				return false;
@@ -105,6 +108,22 @@ namespace GE
 	{
 		return shaderLoadInfoList;
 	}
+	void GraphicPipeline::setTextured(bool textured)
+	{
+		this->textured = textured;
+	}
+	bool GraphicPipeline::isTextured() const
+	{
+		return textured;
+	}
+	void GraphicPipeline::setVertexLayout(VertexLayout layout)
+	{
+		vertexLayout = layout;
+	}
+	VertexLayout GraphicPipeline::getVertexLayout() const
+	{
+		return vertexLayout;
+	}
 
 	bool GraphicPipeline::initPipeline(VkPhysicalDevice physicalDevice, VkFormat swapChainImageFormat, VkExtent2D swapchainExtent, VkSampleCountFlagBits msaaSamples, VkRenderPass renderPass)
 	{
@@ -116,7 +135,8 @@ namespace GE
 		uboLayoutBinding.descriptorCount = 1; // Can be represented as an array. allowing for skeleton movement
 
 		// The type of stages that will be used in this stage. Can OR operation each bit
-		uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		// The material's uv region is read by the vertex shader, its tint by the fragment shader
+		uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 
 		// Used with image sampling descriptors
 		uboLayoutBinding.pImmutableSamplers = nullptr; // Optional
@@ -132,7 +152,7 @@ namespace GE
 		std::array<VkDescriptorSetLayoutBinding, 2> bindings = { uboLayoutBinding, samplerLayoutBinding };
 		VkDescriptorSetLayoutCreateInfo layoutInfo{};
 		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.bindingCount = textured ? static_cast<uint32_t>(bindings.size()) : 1; // untextured only has the ubo
 		layoutInfo.pBindings = bindings.data();
 
 
@@ -150,15 +170,21 @@ namespace GE
 
 		for (auto& shaderStage : shaderLoadInfoList)
 		{
-			std::vector<char> shaderCode = Util::readFile(shaderStage.fileName);
-			VkShaderModule shaderModule = createShaderModule(device, shaderCode);
+			// The module is created straight from the mapped file, the driver keeps its own copy
+			Util::MappedFile shaderCode;
+			if (!shaderCode.open(shaderStage.fileName)) {
+				for (auto module : shaderModulesObjs) vkDestroyShaderModule(device, module, nullptr);
+				currentError = std::string(shaderCode.getError());
+				return false;
+			}
+			VkShaderModule shaderModule = createShaderModule(device, shaderCode.span());
 			shaderModulesObjs.push_back(shaderModule);
 			shaderStagesObjs.push_back(createPipelineShaderInfo(device, shaderStage.name, shaderStage.type, shaderModule));
 		}
 
 
-		VkVertexInputBindingDescription bindingDescription = Vertex::getBindingDescription();
-		std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = Vertex::getAttributeDescriptions();
+		VkVertexInputBindingDescription bindingDescription = Vertex::getBindingDescription(vertexLayout);
+		std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions = Vertex::getAttributeDescriptions(vertexLayout);
 
 
 		// This struct describes the format that will be pass to the vertex shader in 2 ways
@@ -274,6 +300,13 @@ namespace GE
 
 		pipelineLayoutInfo.setLayoutCount = 1;
 		pipelineLayoutInfo.pSetLayouts = &internals.descriptorSetLayout;
+		// The object's matrix, pushed per draw so one descriptor set serves every object of a material
+		VkPushConstantRange objectRange{};
+		objectRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		objectRange.offset = 0;
+		objectRange.size = sizeof(ObjectPushConstants);
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &objectRange;
 		if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &internals.pipelineLayout) != VK_SUCCESS) {
 			currentError = "failed to create pipeline layout!";
 			return false;
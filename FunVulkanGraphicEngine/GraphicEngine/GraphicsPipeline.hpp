@@ -45,6 +45,12 @@ namespace GE
 		
 		bool setShaders(const std::vector<ShaderLoadInfo>&);
 		std::vector<ShaderLoadInfo> getShaders()const;
+		/// @brief Untextured pipelines only bind the uniform buffer. Must be set before initPipeline
+		void setTextured(bool textured);
+		bool isTextured() const;
+		/// @brief Vertex buffer layout the pipeline reads. Meshes drawn with it must be uploaded in the same layout. Must be set before initPipeline
+		void setVertexLayout(VertexLayout layout);
+		VertexLayout getVertexLayout() const;
 		bool initPipeline(VkPhysicalDevice physicalDevice, VkFormat swapChainImageFormat, VkExtent2D swapchainExtent, VkSampleCountFlagBits msaaSamples, VkRenderPass renderPass);
 
 
@@ -55,6 +61,8 @@ namespace GE
 
 		/// @brief Used within pipeline to load in the shader programs
 		std::vector<ShaderLoadInfo> shaderLoadInfoList;
+		bool textured{ true };
+		VertexLayout vertexLayout{ VertexLayout::Float };
 
 		VkDevice device;
 		ErrorMessage currentError;
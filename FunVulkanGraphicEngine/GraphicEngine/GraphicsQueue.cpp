@@ -31,19 +31,23 @@ namespace GE::Util
 		// Finding a queue family that supports VK_QQUEUES_GRAPHICS_BIT
 		int i = 0;
 		for (const auto& queueFamily : queueFamilies) {
-			if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-				indices.graphicsFamily = i;
+			// Graphics and compute families can transfer as well, only a family without them runs copies on its own hardware
+			if ((queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) && !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) && !indices.transferFamily.has_value()) {
+				indices.transferFamily = i;
 			}
 
-			VkBool32 presentSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+			// The transfer family may come after these, so the search goes on once they are found
+			if (!indices.isComplete()) {
+				if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+					indices.graphicsFamily = i;
+				}
 
-			if (presentSupport) {
-				indices.presentFamily = i;
-			}
+				VkBool32 presentSupport = false;
+				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
 
-			if (indices.isComplete()) {
-				break;
+				if (presentSupport) {
+					indices.presentFamily = i;
+				}
 			}
 
 			i++;
@@ -59,7 +63,8 @@ namespace std
 	std::ostream& operator<<(std::ostream& os, const GE::Util::QueueFamilyIndices& obj)
 	{
 		os << "QueueFamilyIndices{graphicsFamily=" << (obj.graphicsFamily.has_value() ? std::to_string(*obj.graphicsFamily) : "NA")
-			<< ",presentFamily=" << (obj.presentFamily.has_value() ? std::to_string(*obj.presentFamily) : "NA") << "}";
+			<< ",presentFamily=" << (obj.presentFamily.has_value() ? std::to_string(*obj.presentFamily) : "NA")
+			<< ",transferFamily=" << (obj.transferFamily.has_value() ? std::to_string(*obj.transferFamily) : "NA") << "}";
 		return os;
 	}
 }
\ No newline at end of file
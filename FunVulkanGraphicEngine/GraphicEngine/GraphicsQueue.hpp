@@ -16,6 +16,8 @@ namespace GE
 		VkQueue presentQueue;
 		// used to interact with the queues made from the logical devices (vkDevie). Command buffers for the pipeline.
 		VkQueue graphicsQueue;
+		// Copies only, runs next to the graphics queue. Null when the device has no transfer only family
+		VkQueue transferQueue{ nullptr };
 	};
 
 	namespace Util
@@ -24,6 +26,8 @@ namespace GE
 		{
 			std::optional<uint32_t> graphicsFamily;
 			std::optional<uint32_t> presentFamily;
+			// Family that can do transfers and nothing else, usually a DMA engine. Optional, uploads fall back to the graphics family
+			std::optional<uint32_t> transferFamily;
 
 			bool isComplete() const;
 
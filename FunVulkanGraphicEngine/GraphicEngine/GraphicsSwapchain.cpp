@@ -505,9 +505,15 @@ namespace GE
 		vkCmdBindPipeline(commandBuffers[currentFrame], VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 	}
 
-	void SwapchainHandle::drawVertices(uint32_t currentFrame, VkPipelineLayout pipelineLayout, VkBuffer indexBuffer, uint32_t indicesSize, VkBuffer verticesBuffer, VkDescriptorSet descriptorSet)
+	void SwapchainHandle::bindDescriptorSet(uint32_t currentFrame, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet)
 	{
-		vkCmdBindIndexBuffer(commandBuffers[currentFrame], indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+		// Binding our descriptor sets to the frame. Specifing that its for the graphics over the compute pipeline. 
+		vkCmdBindDescriptorSets(commandBuffers[currentFrame], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+	}
+
+	void SwapchainHandle::drawVertices(uint32_t currentFrame, VkPipelineLayout pipelineLayout, VkBuffer indexBuffer, VkIndexType indexType, const std::vector<IndexRange>& ranges, VkBuffer verticesBuffer, const ObjectPushConstants& objectConstants)
+	{
+		vkCmdBindIndexBuffer(commandBuffers[currentFrame], indexBuffer, 0, indexType);
 
 
 		// This is what is what uploading the input to the shader of the program
@@ -515,10 +521,11 @@ namespace GE
 		VkDeviceSize offsets[] = { 0 };
 		vkCmdBindVertexBuffers(commandBuffers[currentFrame], 0, 1, vertexBuffers, offsets);
 
-		// Binding our descriptor sets to the frame. Specifing that its for the graphics over the compute pipeline. 
-		vkCmdBindDescriptorSets(commandBuffers[currentFrame], VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+		// Written straight into the command buffer, no descriptor set or buffer per object
+		vkCmdPushConstants(commandBuffers[currentFrame], pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(ObjectPushConstants), &objectConstants);
 
-		vkCmdDrawIndexed(commandBuffers[currentFrame], indicesSize, 1, 0, 0, 0);
+		// What survived culling, the buffers and constants stay bound between the ranges
+		for (const auto& range : ranges) vkCmdDrawIndexed(commandBuffers[currentFrame], range.indexCount, 1, range.firstIndex, 0, 0);
 	}
 
 }
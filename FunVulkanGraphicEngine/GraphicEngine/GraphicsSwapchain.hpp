@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GraphicEngine/ConstDefines.hpp"
+#include "GraphicEngine/GraphicsVertex.hpp"
 
 #include <vector>
 #include <array>
@@ -94,8 +95,10 @@ namespace GE
 		bool beginRenderPass(uint32_t currentFrame, uint32_t imageIndex, const VkClearColorValue& backgroundColor);
 		/// Attaching the pipeline to handle the shaders stages
 		void bindPipeline(uint32_t currentFrame, VkPipeline pipeline);
-		/// begin raterizing and rending the data
-		void drawVertices(uint32_t currentFrame, VkPipelineLayout pipelineLayout, VkBuffer indexBuffer, uint32_t indicesSize, VkBuffer verticesBuffer, VkDescriptorSet descriptorSet);
+		/// Attaching a material's descriptor set, every draw after it samples its texture until the next bind
+		void bindDescriptorSet(uint32_t currentFrame, VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet);
+		/// begin raterizing and rending the data. One draw per range, the per object data goes in as push constants
+		void drawVertices(uint32_t currentFrame, VkPipelineLayout pipelineLayout, VkBuffer indexBuffer, VkIndexType indexType, const std::vector<IndexRange>& ranges, VkBuffer verticesBuffer, const ObjectPushConstants& objectConstants);
 		/// @Complete and Render out the computed information
 		bool endRenderPass(uint32_t currentFrame);
 		/// ------------------------------------------------------
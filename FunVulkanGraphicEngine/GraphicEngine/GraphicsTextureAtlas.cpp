@@ -0,0 +1,303 @@
+#include "GraphicEngine/GraphicsTextureAtlas.hpp"
+#include "GraphicEngine/Utility/MemorySupport.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+	// The coarsest page level is PageLevels - 1. A padding of that many halvings keeps one texel of border even there,
+	// and rects aligned to it downscale exactly, level by level
+	constexpr uint32_t PageLevels = 3;
+	constexpr uint32_t Padding = 1u << (PageLevels - 1);
+
+	uint32_t alignToPadding(uint32_t value) { return (value + Padding - 1) / Padding * Padding; }
+
+	float srgbToLinear(unsigned char value)
+	{
+		static const std::array<float, 256> table = [] {
+			std::array<float, 256> values{};
+			for (size_t i = 0; i < values.size(); i++) {
+				const float channel = static_cast<float>(i) / 255.0f;
+				values[i] = channel <= 0.04045f ? channel / 12.92f : std::pow((channel + 0.055f) / 1.055f, 2.4f);
+			}
+			return values;
+		}();
+		return table[value];
+	}
+
+	unsigned char linearToSrgb(float value)
+	{
+		const float channel = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+		return static_cast<unsigned char>(std::clamp(channel * 255.0f + 0.5f, 0.0f, 255.0f));
+	}
+
+	/// @brief Half size box filter of rgba texels. Color is averaged in linear light, the same as blitting an sRGB image does
+	std::vector<unsigned char> downscale(const std::vector<unsigned char>& texels, uint32_t width, uint32_t height)
+	{
+		const uint32_t halfWidth = width / 2;
+		const uint32_t halfHeight = height / 2;
+		std::vector<unsigned char> result(static_cast<size_t>(halfWidth) * halfHeight * 4);
+		for (uint32_t y = 0; y < halfHeight; y++) {
+			for (uint32_t x = 0; x < halfWidth; x++) {
+				const unsigned char* corners[4] = {
+					&texels[(static_cast<size_t>(y * 2) * width + x * 2) * 4],
+					&texels[(static_cast<size_t>(y * 2) * width + x * 2 + 1) * 4],
+					&texels[(static_cast<size_t>(y * 2 + 1) * width + x * 2) * 4],
+					&texels[(static_cast<size_t>(y * 2 + 1) * width + x * 2 + 1) * 4],
+				};
+				unsigned char* target = &result[(static_cast<size_t>(y) * halfWidth + x) * 4];
+				for (int channel = 0; channel < 3; channel++) {
+					float sum = 0.0f;
+					for (auto* corner : corners) sum += srgbToLinear(corner[channel]);
+					target[channel] = linearToSrgb(sum * 0.25f);
+				}
+				target[3] = static_cast<unsigned char>((corners[0][3] + corners[1][3] + corners[2][3] + corners[3][3] + 2) / 4);
+			}
+		}
+		return result;
+	}
+}
+
+namespace GE
+{
+	GraphicsTextureAtlas::GraphicsTextureAtlas() = default;
+	GraphicsTextureAtlas::~GraphicsTextureAtlas() { Free(); }
+
+	bool GraphicsTextureAtlas::init(VkDevice device, VkPhysicalDevice physicalDevice)
+	{
+		if (device == nullptr) {
+			currentError = "Must insert a valid device";
+			return false;
+		}
+		if (physicalDevice == nullptr)
+		{
+			currentError = "Must insert a valid physical device";
+			return false;
+		}
+		Free();
+		this->device = device;
+		this->physicalDevice = physicalDevice;
+		return true;
+	}
+
+	void GraphicsTextureAtlas::Free()
+	{
+		if (device != nullptr) {
+			for (auto& page : pages) {
+				TextureInternal& textureInfo = page.texture;
+				if (textureInfo.textureSampler != nullptr) vkDestroySampler(device, textureInfo.textureSampler, nullptr);
+				if (textureInfo.textureImageView != nullptr) vkDestroyImageView(device, textureInfo.textureImageView, nullptr);
+				if (textureInfo.textureImage != nullptr) vkDestroyImage(device, textureInfo.textureImage, nullptr);
+				if (textureInfo.textureImageMemory != nullptr) vkFreeMemory(device, textureInfo.textureImageMemory, nullptr);
+			}
+		}
+		pages.clear();
+		regions.clear();
+	}
+
+	std::string_view GraphicsTextureAtlas::getError() const { return currentError; }
+	size_t GraphicsTextureAtlas::pageCount() const { return pages.size(); }
+
+	bool GraphicsTextureAtlas::accepts(const StagedTexture& staged) const
+	{
+		// Baked containers come with their own mips and often block compression, those keep their image
+		return staged.error.empty() && staged.levels.empty() && staged.format == VK_FORMAT_R8G8B8A8_SRGB && staged.pixelSize == 4
+			&& staged.pictureWidth > 0 && staged.pictureHeight > 0
+			&& static_cast<uint32_t>(std::max(staged.pictureWidth, staged.pictureHeight)) <= ATLAS_MAX_TEXTURE_SIZE;
+	}
+
+	bool GraphicsTextureAtlas::addTexture(StagedTexture& staged, VkDescriptorSetLayout descriptorSetLayout, Completion onReady)
+	{
+		if (!staged.error.empty()) {
+			currentError = staged.error;
+			staged.Free(device);
+			return false;
+		}
+		if (device == nullptr) {
+			currentError = "texture atlas was not initialized";
+			return false;
+		}
+		if (descriptorSetLayout == nullptr)
+		{
+			currentError = "Must insert a valid descriptorSetLayout";
+			staged.Free(device);
+			return false;
+		}
+
+		Waiting waiting{ descriptorSetLayout, std::move(onReady) };
+		if (auto known = regions.find(staged.textureFile); known != regions.end()) {
+			// Packed before, every object using the file samples the same texels
+			staged.Free(device);
+			if (known->second.resident) hand(known->first, known->second, waiting);
+			else known->second.waiting.push_back(std::move(waiting));
+			return true;
+		}
+		if (!accepts(staged)) {
+			currentError = staged.textureFile + " does not fit the atlas";
+			staged.Free(device);
+			return false;
+		}
+
+		const uint32_t width = static_cast<uint32_t>(staged.pictureWidth);
+		const uint32_t height = static_cast<uint32_t>(staged.pictureHeight);
+		const uint32_t paddedWidth = alignToPadding(width + Padding * 2);
+		const uint32_t paddedHeight = alignToPadding(height + Padding * 2);
+
+		std::optional<Util::PackedRect> rect;
+		size_t pageIndex = 0;
+		for (; pageIndex < pages.size() && !rect; pageIndex++) rect = pages[pageIndex].packer.insert(paddedWidth, paddedHeight);
+		if (rect) pageIndex--;
+		else {
+			if (!addPage()) { staged.Free(device); return false; }
+			pageIndex = pages.size() - 1;
+			rect = pages[pageIndex].packer.insert(paddedWidth, paddedHeight);
+		}
+
+		Page& page = pages[pageIndex];
+		packTexels(page, *rect, static_cast<const unsigned char*>(staged.staging.mapped), width, height);
+		staged.Free(device);
+		page.pendingFiles.push_back(staged.textureFile);
+
+		const float pageSize = static_cast<float>(ATLAS_PAGE_SIZE);
+		Region region{ pageIndex, glm::vec4(width / pageSize, height / pageSize, (rect->x + Padding) / pageSize, (rect->y + Padding) / pageSize) };
+		region.waiting.push_back(std::move(waiting));
+		regions.emplace(staged.textureFile, std::move(region));
+
+		if constexpr (PRINT_ENGINE_STATS) std::cout << "Atlased " << staged.textureFile << " (" << width << "x" << height << ") into page " << pageIndex << " at " << rect->x << "," << rect->y
+			<< ", page " << static_cast<int>(page.packer.occupancy() * 100.0f) << "% full" << std::endl;
+		return true;
+	}
+
+	bool GraphicsTextureAtlas::flush(GraphicsUploadBatch& batch)
+	{
+		bool flushed = true;
+		for (auto& page : pages) {
+			if (page.pendingRegions.empty()) continue;
+
+			StagedTexture staging;
+			staging.textureFile = page.texture.textureFile;
+			const VkDeviceSize size = page.pendingTexels.size();
+			if (auto errorMessage = Util::allocateStaging(device, physicalDevice, size, staging.staging); !errorMessage.empty()) {
+				currentError = "staging buffer: " + errorMessage;
+				flushed = false;
+				continue;
+			}
+			std::memcpy(staging.staging.mapped, page.pendingTexels.data(), page.pendingTexels.size());
+
+			// Objects get their handles once the texels are on the GPU
+			auto onUploaded = [this, files = std::move(page.pendingFiles)]() {
+				for (const auto& file : files) {
+					auto found = regions.find(file);
+					if (found == regions.end()) continue;
+					found->second.resident = true;
+					std::vector<Waiting> waiting;
+					waiting.swap(found->second.waiting);
+					for (const auto& entry : waiting) hand(found->first, found->second, entry);
+				}
+			};
+			// Regions packed earlier are sampled already and have to survive the copy
+			const bool preserveContents = page.uploaded;
+			page.uploaded = true;
+			if (!batch.addRegions(page.texture.textureImage, 0, PageLevels, preserveContents, staging, std::move(page.pendingRegions), std::move(onUploaded))) {
+				currentError = std::string(batch.getError());
+				flushed = false;
+			}
+			page.pendingTexels.clear();
+			page.pendingRegions.clear();
+			page.pendingFiles.clear();
+		}
+		return flushed;
+	}
+
+	bool GraphicsTextureAtlas::addPage()
+	{
+		Page page{};
+		TextureInternal& textureInfo = page.texture;
+		textureInfo.mipLevels = PageLevels;
+		textureInfo.textureFormat = VK_FORMAT_R8G8B8A8_SRGB;
+		textureInfo.textureFile = "atlas page " + std::to_string(pages.size());
+
+		auto errorMessage = Util::createImage(device, physicalDevice, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, PageLevels, VK_SAMPLE_COUNT_1_BIT, textureInfo.textureFormat, VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureInfo.textureImage, textureInfo.textureImageMemory);
+		if (!errorMessage.empty()) { currentError = "createImage:" + errorMessage; return false; }
+		textureInfo.textureImageView = Util::CreateImageView(device, textureInfo.textureImage, textureInfo.textureFormat, VK_IMAGE_ASPECT_COLOR_BIT, PageLevels);
+
+		// Clamped, a region's uvs never leave it. No anisotropy, its footprint can reach past the padding into a neighbor
+		VkSamplerCreateInfo samplerInfo{};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_LINEAR;
+		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.anisotropyEnable = VK_FALSE;
+		samplerInfo.maxAnisotropy = 1.0f;
+		samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+		samplerInfo.unnormalizedCoordinates = VK_FALSE;
+		samplerInfo.compareEnable = VK_FALSE;
+		samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		samplerInfo.minLod = 0.0f;
+		samplerInfo.maxLod = static_cast<float>(PageLevels - 1);
+		if (vkCreateSampler(device, &samplerInfo, nullptr, &textureInfo.textureSampler) != VK_SUCCESS) {
+			vkDestroyImageView(device, textureInfo.textureImageView, nullptr);
+			vkDestroyImage(device, textureInfo.textureImage, nullptr);
+			vkFreeMemory(device, textureInfo.textureImageMemory, nullptr);
+			currentError = "failed to create atlas sampler!";
+			return false;
+		}
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(device, textureInfo.textureImage, &memoryRequirements);
+		textureInfo.memorySize = memoryRequirements.size;
+		page.packer.reset(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE);
+		if constexpr (PRINT_ENGINE_STATS) std::cout << "Created " << textureInfo.textureFile << ": " << ATLAS_PAGE_SIZE << "x" << ATLAS_PAGE_SIZE << " RGBA8_SRGB, " << PageLevels << " levels, "
+			<< textureInfo.memorySize / 1024 << " KB on the GPU" << std::endl;
+		pages.push_back(std::move(page));
+		return true;
+	}
+
+	void GraphicsTextureAtlas::packTexels(Page& page, const Util::PackedRect& rect, const unsigned char* pixels, uint32_t width, uint32_t height)
+	{
+		// Level 0 of the rect, the border texels of the image repeated out into the padding
+		std::vector<unsigned char> level(static_cast<size_t>(rect.width) * rect.height * 4);
+		for (uint32_t y = 0; y < rect.height; y++) {
+			const uint32_t sourceY = static_cast<uint32_t>(std::clamp<int64_t>(static_cast<int64_t>(y) - Padding, 0, height - 1));
+			for (uint32_t x = 0; x < rect.width; x++) {
+				const uint32_t sourceX = static_cast<uint32_t>(std::clamp<int64_t>(static_cast<int64_t>(x) - Padding, 0, width - 1));
+				std::memcpy(&level[(static_cast<size_t>(y) * rect.width + x) * 4], pixels + (static_cast<size_t>(sourceY) * width + sourceX) * 4, 4);
+			}
+		}
+
+		uint32_t levelWidth = rect.width;
+		uint32_t levelHeight = rect.height;
+		for (uint32_t mip = 0; mip < PageLevels; mip++) {
+			if (mip > 0) {
+				level = downscale(level, levelWidth, levelHeight);
+				levelWidth /= 2;
+				levelHeight /= 2;
+			}
+			VkBufferImageCopy region{};
+			region.bufferOffset = page.pendingTexels.size();
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = mip;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageOffset = { static_cast<int32_t>(rect.x >> mip), static_cast<int32_t>(rect.y >> mip), 0 };
+			region.imageExtent = { levelWidth, levelHeight, 1 };
+			page.pendingRegions.push_back(region);
+			page.pendingTexels.insert(page.pendingTexels.end(), level.begin(), level.end());
+		}
+	}
+
+	void GraphicsTextureAtlas::hand(const std::string& textureFile, const Region& region, const Waiting& waiting)
+	{
+		GraphicsTextureHandle handle;
+		handle.initAtlased(pages[region.page].texture, region.uvScaleOffset, textureFile, device, physicalDevice, waiting.descriptorSetLayout);
+		if (waiting.onReady) waiting.onReady(handle);
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "GraphicEngine/ConstDefines.hpp"
+#include "GraphicEngine/GraphicsVertex.hpp"
+#include "GraphicEngine/GraphicsUploadBatch.hpp"
+#include "GraphicEngine/Utility/SkylinePacker.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace GE
+{
+	/// @brief Packs small textures into shared pages, so they stop costing an image, its memory and a sampler each.
+	/// Pages are RGBA8 sRGB with a short mip chain. Every texture is padded by repeating its border texels, enough that the
+	/// coarsest page level never blends in a neighbor, and sits at a spot aligned to the coarsest level so every level of
+	/// the page holds an exact downscale of it. Objects reach their texture through the uv scale and offset of their
+	/// handle, which the vertex shader applies. Textures sampled with repeating uvs must not go into the atlas
+	class GraphicsTextureAtlas
+	{
+	public:
+		using Completion = GraphicsUploadBatch::Completion;
+
+		GraphicsTextureAtlas();
+		~GraphicsTextureAtlas();
+		GraphicsTextureAtlas(const GraphicsTextureAtlas&) = delete;
+		GraphicsTextureAtlas& operator=(const GraphicsTextureAtlas&) = delete;
+
+		bool init(VkDevice device, VkPhysicalDevice physicalDevice);
+		/// @brief Destroys the pages. Handles still sampling them must be gone or never used again
+		void Free();
+		std::string_view getError() const;
+
+		/// @brief True for decoded color textures no larger than ATLAS_MAX_TEXTURE_SIZE
+		bool accepts(const StagedTexture& staged) const;
+
+		/// @brief Packs staged into a page, a file packed before is shared instead. Takes over the staging buffer, success or not.
+		/// onReady runs once the texels are on the GPU with a handle sampling the page. The handle owns its uniform buffers
+		/// and descriptor sets, whoever keeps it has to Free it. onReady is not called when this returns false
+		bool addTexture(StagedTexture& staged, VkDescriptorSetLayout descriptorSetLayout, Completion onReady);
+
+		/// @brief Queues everything packed since the last flush into batch, one staging buffer and copy per page
+		bool flush(GraphicsUploadBatch& batch);
+
+		size_t pageCount() const;
+
+	private:
+		struct Page
+		{
+			TextureInternal texture;
+			Util::SkylinePacker packer;
+			bool uploaded{ false }; // until the first flush nothing in the page is worth keeping
+			// Every level of everything packed since the last flush, back to back, and where each goes
+			std::vector<unsigned char> pendingTexels;
+			std::vector<VkBufferImageCopy> pendingRegions;
+			std::vector<std::string> pendingFiles;
+		};
+
+		struct Waiting
+		{
+			VkDescriptorSetLayout descriptorSetLayout;
+			Completion onReady;
+		};
+
+		struct Region
+		{
+			size_t page;
+			glm::vec4 uvScaleOffset;
+			bool resident{ false };
+			std::vector<Waiting> waiting; // handles asked for before the texels reached the GPU
+		};
+
+		bool addPage();
+		/// @brief Pads, downscales and queues the texels of a width x height rgba image at rect of page
+		void packTexels(Page& page, const Util::PackedRect& rect, const unsigned char* pixels, uint32_t width, uint32_t height);
+		void hand(const std::string& textureFile, const Region& region, const Waiting& waiting);
+
+		VkDevice device{ nullptr };
+		VkPhysicalDevice physicalDevice{ nullptr };
+		std::string currentError;
+
+		std::vector<Page> pages;
+		std::map<std::string, Region> regions;
+	};
+}
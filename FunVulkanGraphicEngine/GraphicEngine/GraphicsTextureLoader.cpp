@@ -0,0 +1,135 @@
+#include "GraphicEngine/GraphicsTextureLoader.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace GE
+{
+	GraphicsTextureLoader::GraphicsTextureLoader() = default;
+	GraphicsTextureLoader::~GraphicsTextureLoader() { Free(); }
+
+	bool GraphicsTextureLoader::init(VkDevice device, VkPhysicalDevice physicalDevice, unsigned threadCount)
+	{
+		if (device == nullptr) {
+			currentError = "Must insert a valid device";
+			return false;
+		}
+		if (physicalDevice == nullptr)
+		{
+			currentError = "Must insert a valid physical device";
+			return false;
+		}
+		Free();
+		this->device = device;
+		this->physicalDevice = physicalDevice;
+
+		if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+		stopping = false;
+		for (unsigned i = 0; i < threadCount; i++) workers.emplace_back(&GraphicsTextureLoader::workerLoop, this);
+		return true;
+	}
+
+	void GraphicsTextureLoader::Free()
+	{
+		{
+			std::lock_guard lock(mutex);
+			stopping = true;
+		}
+		wakeWorkers.notify_all();
+		for (auto& worker : workers) worker.join();
+		workers.clear();
+
+		// Whatever was never handed to the render thread still owns its staging buffer
+		for (auto& job : finishedJobs) job.staged.Free(device);
+		finishedJobs.clear();
+		waitingJobs.clear();
+		jobsInFlight = 0;
+		levelJobsInFlight = 0;
+		burstCount = 0;
+	}
+
+	std::string_view GraphicsTextureLoader::getError() const { return currentError; }
+
+	void GraphicsTextureLoader::request(std::string filePath, Completion onComplete, uint32_t maxLevelSize, TextureUsage usage)
+	{
+		{
+			std::lock_guard lock(mutex);
+			if (jobsInFlight == 0) {
+				burstStart = std::chrono::steady_clock::now();
+				burstCount = 0;
+			}
+			jobsInFlight++;
+			burstCount++;
+			waitingJobs.push_back(Job{ std::move(filePath), std::move(onComplete), {}, maxLevelSize, usage });
+		}
+		wakeWorkers.notify_one();
+	}
+
+	void GraphicsTextureLoader::requestLevel(std::string filePath, uint32_t level, Completion onComplete)
+	{
+		{
+			std::lock_guard lock(mutex);
+			levelJobsInFlight++;
+			waitingJobs.push_back(Job{ std::move(filePath), std::move(onComplete), {}, 0, TextureUsage::Color, level });
+		}
+		wakeWorkers.notify_one();
+	}
+
+	size_t GraphicsTextureLoader::pumpCompleted(size_t maxCount)
+	{
+		size_t pumped = 0;
+		while (pumped < maxCount) {
+			Job job;
+			{
+				std::lock_guard lock(mutex);
+				if (finishedJobs.empty()) break;
+				job = std::move(finishedJobs.front());
+				finishedJobs.pop_front();
+			}
+
+			if (job.onComplete) job.onComplete(job.staged);
+			job.staged.Free(device); // no-op when the callback took the buffer
+			pumped++;
+
+			std::lock_guard lock(mutex);
+			if (job.level) { levelJobsInFlight--; continue; }
+			if (--jobsInFlight == 0 && burstCount > 1 && PRINT_ENGINE_STATS) {
+				const double burstMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - burstStart).count();
+				std::cout << "Loaded " << burstCount << " textures in " << burstMs << " ms with " << workers.size() << " decode workers" << std::endl;
+			}
+		}
+		return pumped;
+	}
+
+	size_t GraphicsTextureLoader::pending() const
+	{
+		std::lock_guard lock(mutex);
+		return jobsInFlight + levelJobsInFlight;
+	}
+
+	void GraphicsTextureLoader::workerLoop()
+	{
+		while (true) {
+			Job job;
+			{
+				std::unique_lock lock(mutex);
+				wakeWorkers.wait(lock, [this] { return stopping || !waitingJobs.empty(); });
+				if (stopping) return;
+				job = std::move(waitingJobs.front());
+				waitingJobs.pop_front();
+			}
+
+			decode(job);
+
+			std::lock_guard lock(mutex);
+			finishedJobs.push_back(std::move(job));
+		}
+	}
+
+	void GraphicsTextureLoader::decode(Job& job) const
+	{
+		// Decoding and the copy into the staging buffer happen here on the worker, the render thread only records the GPU transfer
+		if (job.level) stageTextureLevel(job.filePath, *job.level, device, physicalDevice, job.staged);
+		else stageTextureFile(job.filePath, device, physicalDevice, job.staged, job.maxLevelSize, job.usage);
+	}
+}
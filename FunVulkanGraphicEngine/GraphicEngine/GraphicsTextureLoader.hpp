@@ -0,0 +1,85 @@
+#pragma once
+
+#include "GraphicEngine/ConstDefines.hpp"
+#include "GraphicEngine/GraphicsVertex.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace GE
+{
+	/// @brief Decodes image files on a pool of worker threads.
+	/// Every worker decodes its image and writes the pixels into a host visible staging buffer it created itself.
+	/// The finished StagedTexture is queued until the render thread calls pumpCompleted, which hands it to the
+	/// completion callback so the GPU copy is recorded on the thread that owns the queue
+	class GraphicsTextureLoader
+	{
+	public:
+		using Completion = std::function<void(StagedTexture&)>;
+
+		GraphicsTextureLoader();
+		~GraphicsTextureLoader();
+		GraphicsTextureLoader(const GraphicsTextureLoader&) = delete;
+		GraphicsTextureLoader& operator=(const GraphicsTextureLoader&) = delete;
+
+		/// @brief Starts the workers. threadCount of 0 uses one per hardware thread
+		bool init(VkDevice device, VkPhysicalDevice physicalDevice, unsigned threadCount = 0);
+		/// @brief Stops the workers and frees the staging buffers nobody picked up. Must run before the device goes away
+		void Free();
+		std::string_view getError() const;
+
+		/// @brief Queues filePath for decoding. onComplete runs inside pumpCompleted once the pixels are staged,
+		/// also when decoding failed (StagedTexture::error is set then).
+		/// A maxLevelSize above 0 stages only the baked levels no larger than that, usage picks sRGB or linear formats.
+		/// See stageTextureFile
+		void request(std::string filePath, Completion onComplete, uint32_t maxLevelSize = 0, TextureUsage usage = TextureUsage::Color);
+		/// @brief Queues staging one more baked level of filePath, for streaming in what request left out.
+		/// Not counted in the load time reports
+		void requestLevel(std::string filePath, uint32_t level, Completion onComplete);
+
+		/// @brief Runs up to maxCount completions on the calling thread. Returns how many ran
+		size_t pumpCompleted(size_t maxCount = SIZE_MAX);
+
+		/// @brief Requests that have not been pumped yet
+		size_t pending() const;
+
+	private:
+		struct Job
+		{
+			std::string filePath;
+			Completion onComplete;
+			StagedTexture staged;
+			uint32_t maxLevelSize{ 0 };
+			TextureUsage usage{ TextureUsage::Color };
+			std::optional<uint32_t> level; // set for streamed levels
+		};
+
+		void workerLoop();
+		void decode(Job& job) const;
+
+		VkDevice device{ nullptr };
+		VkPhysicalDevice physicalDevice{ nullptr };
+		std::string currentError;
+
+		std::vector<std::thread> workers;
+		std::deque<Job> waitingJobs;
+		std::deque<Job> finishedJobs;
+		size_t jobsInFlight{ 0 };
+		size_t levelJobsInFlight{ 0 };
+		bool stopping{ false };
+		mutable std::mutex mutex;
+		std::condition_variable wakeWorkers;
+
+		// Reports how long a burst of requests took from the first request until the last one was pumped
+		std::chrono::steady_clock::time_point burstStart;
+		size_t burstCount{ 0 };
+	};
+}
@@ -0,0 +1,597 @@
+#include "GraphicEngine/GraphicsUploadBatch.hpp"
+#include "GraphicEngine/Utility/MemorySupport.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+	// Set by the renderer once its batch exists, read wherever meshes are created
+	std::atomic<GE::GraphicsUploadBatch*> sharedBatch{ nullptr };
+
+	VkImageMemoryBarrier imageBarrier(VkImage image, uint32_t baseMipLevel, uint32_t levelCount, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask,
+		uint32_t srcQueueFamily = VK_QUEUE_FAMILY_IGNORED, uint32_t dstQueueFamily = VK_QUEUE_FAMILY_IGNORED)
+	{
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.oldLayout = oldLayout; // VK_IMAGE_LAYOUT_UNDEFINED if we don't care about existing contents of image
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = srcQueueFamily; // used if we are transfering ownership between queues
+		barrier.dstQueueFamilyIndex = dstQueueFamily;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = baseMipLevel;
+		barrier.subresourceRange.levelCount = levelCount;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		barrier.srcAccessMask = srcAccessMask;
+		barrier.dstAccessMask = dstAccessMask;
+		return barrier;
+	}
+
+	VkBufferMemoryBarrier bufferBarrier(VkBuffer buffer, VkDeviceSize size, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask,
+		uint32_t srcQueueFamily = VK_QUEUE_FAMILY_IGNORED, uint32_t dstQueueFamily = VK_QUEUE_FAMILY_IGNORED)
+	{
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask = srcAccessMask;
+		barrier.dstAccessMask = dstAccessMask;
+		barrier.srcQueueFamilyIndex = srcQueueFamily;
+		barrier.dstQueueFamilyIndex = dstQueueFamily;
+		barrier.buffer = buffer;
+		barrier.offset = 0;
+		barrier.size = size;
+		return barrier;
+	}
+
+	void pipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags sourceStage, VkPipelineStageFlags destinationStage, const std::vector<VkImageMemoryBarrier>& barriers)
+	{
+		if (barriers.empty()) return;
+		vkCmdPipelineBarrier(commandBuffer,
+			sourceStage, destinationStage, 0,
+			0, nullptr,
+			0, nullptr,
+			static_cast<uint32_t>(barriers.size()), barriers.data());
+	}
+
+	/// @brief Where what staged holds goes in its image. Baked textures copy every staged level, the others only level 0
+	std::vector<VkBufferImageCopy> stagedRegions(const GE::StagedTexture& staged)
+	{
+		std::vector<VkBufferImageCopy> regions;
+		if (staged.levels.empty()) {
+			regions.push_back(VkBufferImageCopy{});
+			regions.back().imageExtent = { static_cast<uint32_t>(staged.pictureWidth), static_cast<uint32_t>(staged.pictureHeight), 1 };
+		}
+		for (size_t i = 0; i < staged.levels.size(); i++) {
+			regions.push_back(VkBufferImageCopy{});
+			regions.back().bufferOffset = staged.levels[i].offset;
+			regions.back().imageSubresource.mipLevel = staged.firstLevel + static_cast<uint32_t>(i);
+			regions.back().imageExtent = { staged.levels[i].width, staged.levels[i].height, 1 };
+		}
+		for (auto& region : regions) {
+			// Row length and image height of 0 means tightly packed, for block formats that means whole 4x4 blocks
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.baseArrayLayer = 0;
+			region.imageSubresource.layerCount = 1;
+			region.imageOffset = { 0, 0, 0 };
+		}
+		return regions;
+	}
+
+	/// @brief Region offsets are relative to the staging allocation, which usually sits somewhere inside the staging ring
+	void copyRegions(VkCommandBuffer commandBuffer, const GE::Util::StagingAllocation& staging, VkImage image, std::vector<VkBufferImageCopy> regions)
+	{
+		for (auto& region : regions) region.bufferOffset += staging.offset;
+		vkCmdCopyBufferToImage(commandBuffer, staging.buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+	}
+}
+
+namespace GE
+{
+	GraphicsUploadBatch::GraphicsUploadBatch() = default;
+	GraphicsUploadBatch::~GraphicsUploadBatch() { Free(); }
+
+	bool GraphicsUploadBatch::init(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, const TransferQueue& transfer)
+	{
+		if (device == nullptr) {
+			currentError = "Must insert a valid device";
+			return false;
+		}
+		if (physicalDevice == nullptr)
+		{
+			currentError = "Must insert a valid physical device";
+			return false;
+		}
+		if (graphicsQueue == nullptr || commandPool == nullptr)
+		{
+			currentError = "Must insert a valid queue and command pool";
+			return false;
+		}
+		Free();
+		this->device = device;
+		this->physicalDevice = physicalDevice;
+		this->graphicsQueue = graphicsQueue;
+		this->commandPool = commandPool;
+		if (transfer.queue == nullptr) return true;
+
+		// Command buffers of the transfer queue have to come from a pool of its family
+		VkCommandPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		poolInfo.queueFamilyIndex = transfer.family;
+		if (vkCreateCommandPool(device, &poolInfo, nullptr, &transferPool) != VK_SUCCESS)
+		{
+			currentError = "failed to create the transfer command pool";
+			transferPool = nullptr;
+			return false;
+		}
+		this->transfer = transfer;
+		return true;
+	}
+
+	bool GraphicsUploadBatch::Work::empty() const { return entries.empty() && regionEntries.empty() && bufferEntries.empty(); }
+
+	void GraphicsUploadBatch::Free()
+	{
+		for (auto& submission : submissions) {
+			if (submission.copyFence != nullptr) vkWaitForFences(device, 1, &submission.copyFence, VK_TRUE, UINT64_MAX);
+			if (submission.fence != nullptr) vkWaitForFences(device, 1, &submission.fence, VK_TRUE, UINT64_MAX);
+			destroy(submission);
+			release(submission.work, false);
+		}
+		submissions.clear();
+		release(pending, false);
+		if (transferPool != nullptr) vkDestroyCommandPool(device, transferPool, nullptr);
+		transferPool = nullptr;
+		transfer = TransferQueue();
+	}
+
+	void GraphicsUploadBatch::destroy(Submission& submission)
+	{
+		if (submission.copyFence != nullptr) vkDestroyFence(device, submission.copyFence, nullptr);
+		if (submission.copied != nullptr) vkDestroySemaphore(device, submission.copied, nullptr);
+		if (submission.copyCommandBuffer != nullptr) vkFreeCommandBuffers(device, transferPool, 1, &submission.copyCommandBuffer);
+		if (submission.fence != nullptr) vkDestroyFence(device, submission.fence, nullptr);
+		if (submission.commandBuffer != nullptr) vkFreeCommandBuffers(device, commandPool, 1, &submission.commandBuffer);
+		submission.copyFence = nullptr;
+		submission.copied = nullptr;
+		submission.copyCommandBuffer = nullptr;
+		submission.fence = nullptr;
+		submission.commandBuffer = nullptr;
+	}
+
+	void GraphicsUploadBatch::release(Work& work, bool keepTextures)
+	{
+		for (auto& entry : work.entries) {
+			entry.staged.Free(device);
+			if (!keepTextures) entry.handle.Free();
+		}
+		work.entries.clear();
+		// The images of streamed levels belong to their textures, the destination buffers to their meshes
+		for (auto& entry : work.regionEntries) entry.staged.Free(device);
+		work.regionEntries.clear();
+		for (auto& entry : work.bufferEntries) Util::freeStaging(device, entry.staging);
+		work.bufferEntries.clear();
+	}
+
+	std::string_view GraphicsUploadBatch::getError() const { return currentError; }
+	size_t GraphicsUploadBatch::size() const { return pending.entries.size() + pending.regionEntries.size() + pending.bufferEntries.size(); }
+	size_t GraphicsUploadBatch::inFlight() const { return submissions.size(); }
+	bool GraphicsUploadBatch::usesTransferQueue() const { return transfer.queue != nullptr; }
+
+	bool GraphicsUploadBatch::addTexture(StagedTexture& staged, VkDescriptorSetLayout descriptorSetLayout, Completion onReady)
+	{
+		if (!staged.error.empty()) {
+			currentError = staged.error;
+			staged.Free(device);
+			return false;
+		}
+		if (device == nullptr) {
+			currentError = "upload batch was not initialized";
+			return false;
+		}
+		if (descriptorSetLayout == nullptr)
+		{
+			currentError = "Must insert a valid descriptorSetLayout";
+			staged.Free(device);
+			return false;
+		}
+
+		Entry entry{ GraphicsTextureHandle(), staged, descriptorSetLayout, std::move(onReady) };
+		// The batch owns the staging memory from here on
+		staged.staging = Util::StagingAllocation();
+
+		if (!entry.handle.beginUpload(entry.staged, device, physicalDevice)) {
+			currentError = std::string(entry.handle.getError());
+			return false;
+		}
+		pending.entries.push_back(std::move(entry));
+		return true;
+	}
+
+	bool GraphicsUploadBatch::addLevels(StagedTexture& staged, const GraphicsTextureHandle& texture, LevelCompletion onReady)
+	{
+		if (!staged.error.empty()) {
+			currentError = staged.error;
+			staged.Free(device);
+			return false;
+		}
+		if (device == nullptr) {
+			currentError = "upload batch was not initialized";
+			return false;
+		}
+		const TextureInternal& textureInfo = texture.Internals().texture;
+		if (!texture.isReady() || textureInfo.textureImage == nullptr || staged.levels.empty() || staged.firstLevel + staged.levels.size() > textureInfo.residentLevel)
+		{
+			currentError = "streamed levels do not fit the texture " + textureInfo.textureFile;
+			staged.Free(device);
+			return false;
+		}
+
+		// Levels finer than the resident one are outside the texture's view, no descriptor reaches them while they are
+		// written. Their contents can go
+		const uint32_t levelCount = static_cast<uint32_t>(staged.levels.size());
+		return addRegions(textureInfo.textureImage, staged.firstLevel, levelCount, false, staged, stagedRegions(staged), std::move(onReady));
+	}
+
+	bool GraphicsUploadBatch::addRegions(VkImage image, uint32_t baseLevel, uint32_t levelCount, bool preserveContents, StagedTexture& staged, std::vector<VkBufferImageCopy> regions, LevelCompletion onReady)
+	{
+		if (device == nullptr) {
+			currentError = "upload batch was not initialized";
+			return false;
+		}
+		if (image == nullptr || levelCount == 0 || regions.empty() || staged.staging.empty())
+		{
+			currentError = "nothing to copy into the image";
+			staged.Free(device);
+			return false;
+		}
+
+		pending.regionEntries.push_back(RegionEntry{ image, baseLevel, levelCount, preserveContents, staged, std::move(regions), std::move(onReady) });
+		// The batch owns the staging memory from here on
+		staged.staging = Util::StagingAllocation();
+		return true;
+	}
+
+	bool GraphicsUploadBatch::addBuffer(Util::StagingAllocation& staging, VkBuffer destination, VkDeviceSize size, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess, LevelCompletion onReady)
+	{
+		BufferEntry entry{ staging, destination, size, dstStage, dstAccess, std::move(onReady) };
+		staging = Util::StagingAllocation();
+		if (device == nullptr) {
+			currentError = "upload batch was not initialized";
+			return false;
+		}
+		if (entry.staging.empty() || destination == nullptr || size == 0 || size > entry.staging.size)
+		{
+			currentError = "nothing to copy into the buffer";
+			Work dropped;
+			dropped.bufferEntries.push_back(std::move(entry));
+			release(dropped, false);
+			return false;
+		}
+		pending.bufferEntries.push_back(std::move(entry));
+		return true;
+	}
+
+	void GraphicsUploadBatch::recordCopies(VkCommandBuffer commandBuffer, const Work& work, bool release) const
+	{
+		const auto& entries = work.entries;
+		const auto& regionEntries = work.regionEntries;
+		// Released resources belong to nobody until the graphics queue acquires them, the destination stage does not matter
+		const uint32_t srcFamily = release ? transfer.family : VK_QUEUE_FAMILY_IGNORED;
+		const uint32_t dstFamily = release ? transfer.graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+
+		// Fresh buffers have nothing to wait for. Whoever reads them afterwards waits for all the copies at once
+		VkPipelineStageFlags bufferStages = release ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : 0;
+		std::vector<VkBufferMemoryBarrier> bufferBarriers;
+		for (const auto& entry : work.bufferEntries) {
+			VkBufferCopy copyRegion{};
+			copyRegion.srcOffset = entry.staging.offset;
+			copyRegion.size = entry.size;
+			vkCmdCopyBuffer(commandBuffer, entry.staging.buffer, entry.destination, 1, &copyRegion);
+
+			bufferBarriers.push_back(bufferBarrier(entry.destination, entry.size, VK_ACCESS_TRANSFER_WRITE_BIT, release ? 0 : entry.dstAccess, srcFamily, dstFamily));
+			if (!release) bufferStages |= entry.dstStage;
+		}
+		if (!bufferBarriers.empty()) {
+			vkCmdPipelineBarrier(commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT, bufferStages, 0,
+				0, nullptr,
+				static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+				0, nullptr);
+		}
+		if (entries.empty() && regionEntries.empty()) return;
+
+		// Barriers of every image go into one vkCmdPipelineBarrier per step, so the driver sees one dependency per step
+		// instead of one per texture
+		std::vector<VkImageMemoryBarrier> barriers;
+		barriers.reserve(entries.size());
+
+		// Don't care about the contents until the copy, every level goes to TRANSFER_DST. Fresh images were never owned by
+		// the graphics family. Streamed levels were, but they sit outside every view of their texture and the submission
+		// that last touched them finished before the texture was handed out, so nothing on the graphics queue can race the
+		// writes. Discarding contents owned by another family is valid without a release, the acquire at the end hands
+		// them back
+		for (const auto& entry : entries) {
+			const TextureInternal& textureInfo = entry.handle.Internals().texture;
+			barriers.push_back(imageBarrier(textureInfo.textureImage, 0, textureInfo.mipLevels, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT));
+		}
+		for (const auto& entry : regionEntries) {
+			if (!entry.preserveContents) barriers.push_back(imageBarrier(entry.image, entry.baseLevel, entry.levelCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT));
+		}
+		// Transfer is not a real graphic pipeline stage. Its a pseudo stage where the transfer is happening
+		pipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, barriers);
+
+		// Images updated in place keep their texels, and frames submitted earlier may still sample them. They stay on the
+		// graphics queue, recordFinish copies into them there
+		if (!release) {
+			barriers.clear();
+			for (const auto& entry : regionEntries) {
+				if (entry.preserveContents) barriers.push_back(imageBarrier(entry.image, entry.baseLevel, entry.levelCount, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT));
+			}
+			pipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, barriers);
+		}
+
+		// Baked textures copy every staged level, the others only level 0 and blit the rest in recordFinish
+		for (const auto& entry : entries) copyRegions(commandBuffer, entry.staged.staging, entry.handle.Internals().texture.textureImage, stagedRegions(entry.staged));
+		for (const auto& entry : regionEntries) {
+			if (!release || !entry.preserveContents) copyRegions(commandBuffer, entry.staged.staging, entry.image, entry.regions);
+		}
+		if (!release) return;
+
+		// Release to the graphics family. Textures that still need their mips stay in TRANSFER_DST for the blits, the
+		// layout changes happen once, the acquire in recordFinish repeats the same transitions
+		barriers.clear();
+		for (const auto& entry : entries) {
+			const TextureInternal& textureInfo = entry.handle.Internals().texture;
+			const VkImageLayout newLayout = entry.staged.levels.empty() ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barriers.push_back(imageBarrier(textureInfo.textureImage, 0, textureInfo.mipLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, newLayout, VK_ACCESS_TRANSFER_WRITE_BIT, 0, srcFamily, dstFamily));
+		}
+		for (const auto& entry : regionEntries) {
+			if (!entry.preserveContents) barriers.push_back(imageBarrier(entry.image, entry.baseLevel, entry.levelCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, 0, srcFamily, dstFamily));
+		}
+		pipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, barriers);
+	}
+
+	void GraphicsUploadBatch::recordFinish(VkCommandBuffer commandBuffer, const Work& work, bool acquire) const
+	{
+		const auto& entries = work.entries;
+		const auto& regionEntries = work.regionEntries;
+		std::vector<VkImageMemoryBarrier> barriers;
+
+		if (acquire) {
+			// Mirrors the release barriers of recordCopies. The semaphore wait covers every stage, the source side of the
+			// acquire chains onto it
+			VkPipelineStageFlags acquireStages = 0;
+			std::vector<VkBufferMemoryBarrier> bufferBarriers;
+			for (const auto& entry : work.bufferEntries) {
+				bufferBarriers.push_back(bufferBarrier(entry.destination, entry.size, 0, entry.dstAccess, transfer.family, transfer.graphicsFamily));
+				acquireStages |= entry.dstStage;
+			}
+			for (const auto& entry : entries) {
+				const TextureInternal& textureInfo = entry.handle.Internals().texture;
+				if (entry.staged.levels.empty()) {
+					barriers.push_back(imageBarrier(textureInfo.textureImage, 0, textureInfo.mipLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT, transfer.family, transfer.graphicsFamily));
+					acquireStages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+				}
+				else {
+					barriers.push_back(imageBarrier(textureInfo.textureImage, 0, textureInfo.mipLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT, transfer.family, transfer.graphicsFamily));
+					acquireStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+				}
+			}
+			for (const auto& entry : regionEntries) {
+				if (entry.preserveContents) continue;
+				barriers.push_back(imageBarrier(entry.image, entry.baseLevel, entry.levelCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT, transfer.family, transfer.graphicsFamily));
+				acquireStages |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+			}
+			if (!bufferBarriers.empty() || !barriers.empty()) {
+				vkCmdPipelineBarrier(commandBuffer,
+					VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, acquireStages, 0,
+					0, nullptr,
+					static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+					static_cast<uint32_t>(barriers.size()), barriers.data());
+			}
+
+			// Images updated in place are copied into here, the graphics queue owns them and may still sample them
+			barriers.clear();
+			for (const auto& entry : regionEntries) {
+				if (entry.preserveContents) barriers.push_back(imageBarrier(entry.image, entry.baseLevel, entry.levelCount, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT));
+			}
+			pipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, barriers);
+			for (const auto& entry : regionEntries) {
+				if (entry.preserveContents) copyRegions(commandBuffer, entry.staged.staging, entry.image, entry.regions);
+			}
+		}
+		if (entries.empty() && regionEntries.empty()) return;
+
+		// Mip chains are generated one level at a time for all images together. Level i-1 becomes the blit source of level i
+		uint32_t deepestChain = 1;
+		for (const auto& entry : entries) {
+			if (entry.staged.levels.empty()) deepestChain = std::max(deepestChain, entry.handle.Internals().texture.mipLevels);
+		}
+		for (uint32_t level = 1; level < deepestChain; level++) {
+			barriers.clear();
+			for (const auto& entry : entries) {
+				const TextureInternal& textureInfo = entry.handle.Internals().texture;
+				if (!entry.staged.levels.empty() || level >= textureInfo.mipLevels) continue;
+				barriers.push_back(imageBarrier(textureInfo.textureImage, level - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT));
+			}
+			pipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, barriers);
+
+			for (const auto& entry : entries) {
+				const TextureInternal& textureInfo = entry.handle.Internals().texture;
+				if (!entry.staged.levels.empty() || level >= textureInfo.mipLevels) continue;
+
+				const int32_t srcWidth = std::max(1, entry.staged.pictureWidth >> (level - 1));
+				const int32_t srcHeight = std::max(1, entry.staged.pictureHeight >> (level - 1));
+				VkImageBlit blit{};
+				blit.srcOffsets[0] = { 0, 0, 0 };
+				blit.srcOffsets[1] = { srcWidth, srcHeight, 1 };
+				blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				blit.srcSubresource.mipLevel = level - 1;
+				blit.srcSubresource.baseArrayLayer = 0;
+				blit.srcSubresource.layerCount = 1;
+				blit.dstOffsets[0] = { 0, 0, 0 };
+				blit.dstOffsets[1] = { srcWidth > 1 ? srcWidth / 2 : 1, srcHeight > 1 ? srcHeight / 2 : 1, 1 };
+				blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				blit.dstSubresource.mipLevel = level;
+				blit.dstSubresource.baseArrayLayer = 0;
+				blit.dstSubresource.layerCount = 1;
+
+				vkCmdBlitImage(commandBuffer,
+					textureInfo.textureImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+					textureInfo.textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					1, &blit,
+					VK_FILTER_LINEAR);
+			}
+		}
+
+		// Everything is handed to the fragment shader at once. Blit sources sit in TRANSFER_SRC, the rest in TRANSFER_DST.
+		// What the acquire already moved to SHADER_READ_ONLY is left alone
+		barriers.clear();
+		for (const auto& entry : entries) {
+			const TextureInternal& textureInfo = entry.handle.Internals().texture;
+			if (acquire && !entry.staged.levels.empty()) continue;
+			const uint32_t blitSources = entry.staged.levels.empty() ? textureInfo.mipLevels - 1 : 0;
+			if (blitSources > 0) {
+				barriers.push_back(imageBarrier(textureInfo.textureImage, 0, blitSources, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT));
+			}
+			barriers.push_back(imageBarrier(textureInfo.textureImage, blitSources, textureInfo.mipLevels - blitSources, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT));
+		}
+		for (const auto& entry : regionEntries) {
+			if (acquire && !entry.preserveContents) continue;
+			barriers.push_back(imageBarrier(entry.image, entry.baseLevel, entry.levelCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT));
+		}
+		pipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, barriers);
+	}
+
+	bool GraphicsUploadBatch::flush()
+	{
+		if (pending.empty()) return true;
+
+		// With a transfer queue the copies go there now, the graphics part is recorded along but only submitted from poll()
+		// once they finished. Frames queued in between never wait for the copies
+		Submission submission;
+		const bool onTransferQueue = transfer.queue != nullptr;
+		if (onTransferQueue) {
+			submission.copyCommandBuffer = Util::beginSingleTimeCommands(device, transferPool);
+			recordCopies(submission.copyCommandBuffer, pending, true);
+			vkEndCommandBuffer(submission.copyCommandBuffer);
+		}
+		submission.commandBuffer = Util::beginSingleTimeCommands(device, commandPool);
+		if (!onTransferQueue) recordCopies(submission.commandBuffer, pending, false);
+		recordFinish(submission.commandBuffer, pending, onTransferQueue);
+		vkEndCommandBuffer(submission.commandBuffer);
+
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		bool submitted = true;
+		if (onTransferQueue) {
+			VkSemaphoreCreateInfo semaphoreInfo{};
+			semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			submitted = vkCreateFence(device, &fenceInfo, nullptr, &submission.copyFence) == VK_SUCCESS;
+			submitted = submitted && vkCreateSemaphore(device, &semaphoreInfo, nullptr, &submission.copied) == VK_SUCCESS;
+
+			VkSubmitInfo submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &submission.copyCommandBuffer;
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores = &submission.copied;
+			submitted = submitted && vkQueueSubmit(transfer.queue, 1, &submitInfo, submission.copyFence) == VK_SUCCESS;
+		}
+		else {
+			// Only this submission is tracked, frames already queued keep running
+			submitted = submitFinish(submission);
+		}
+		if (!submitted) {
+			destroy(submission);
+			currentError = "failed to submit the upload batch";
+			release(pending, false);
+			return false;
+		}
+
+		submission.work = std::move(pending);
+		submissions.push_back(std::move(submission));
+		pending = Work();
+		return true;
+	}
+
+	bool GraphicsUploadBatch::submitFinish(Submission& submission)
+	{
+		VkFenceCreateInfo fenceInfo{};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		VkFence fence = nullptr;
+		if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) return false;
+
+		// The copies are done by now, so the wait on their semaphore costs nothing
+		const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		if (submission.copied != nullptr) {
+			submitInfo.waitSemaphoreCount = 1;
+			submitInfo.pWaitSemaphores = &submission.copied;
+			submitInfo.pWaitDstStageMask = &waitStage;
+		}
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &submission.commandBuffer;
+		if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, fence) != VK_SUCCESS) {
+			vkDestroyFence(device, fence, nullptr);
+			return false;
+		}
+		submission.fence = fence;
+		return true;
+	}
+
+	bool GraphicsUploadBatch::poll() { return complete(false); }
+	bool GraphicsUploadBatch::wait() { return complete(true); }
+	bool GraphicsUploadBatch::submit() { return flush() && wait(); }
+
+	bool GraphicsUploadBatch::complete(bool block)
+	{
+		bool succeeded = true;
+		while (!submissions.empty()) {
+			Submission& submission = submissions.front();
+			bool failed = false;
+			if (submission.fence == nullptr) {
+				// Copies on the transfer queue. Once they are done the graphics queue takes the uploads over
+				const VkResult copyStatus = block ? vkWaitForFences(device, 1, &submission.copyFence, VK_TRUE, UINT64_MAX) : vkGetFenceStatus(device, submission.copyFence);
+				if (copyStatus == VK_NOT_READY) break; // later submissions finish after this one
+				failed = copyStatus != VK_SUCCESS || !submitFinish(submission);
+			}
+			if (!failed) {
+				const VkResult status = block ? vkWaitForFences(device, 1, &submission.fence, VK_TRUE, UINT64_MAX) : vkGetFenceStatus(device, submission.fence);
+				if (status == VK_NOT_READY) break;
+				failed = status != VK_SUCCESS;
+			}
+
+			// Take the submission out first, a completion is allowed to add to the next batch
+			Work finished = std::move(submission.work);
+			destroy(submission);
+			submissions.erase(submissions.begin());
+
+			if (failed) {
+				currentError = "failed to wait for the upload batch";
+				release(finished, false);
+				succeeded = false;
+				continue;
+			}
+			for (auto& entry : finished.entries) {
+				entry.staged.Free(device);
+				entry.handle.finishUpload(physicalDevice, entry.descriptorSetLayout);
+				if (entry.onReady) entry.onReady(entry.handle);
+			}
+			for (auto& entry : finished.regionEntries) {
+				if (entry.onReady) entry.onReady();
+			}
+			for (auto& entry : finished.bufferEntries) {
+				if (entry.onReady) entry.onReady();
+			}
+			release(finished, true);
+		}
+		return succeeded;
+	}
+
+	void useUploadBatch(GraphicsUploadBatch* batch) { sharedBatch.store(batch); }
+	GraphicsUploadBatch* sharedUploadBatch() { return sharedBatch.load(); }
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "GraphicEngine/ConstDefines.hpp"
+#include "GraphicEngine/GraphicsVertex.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace GE
+{
+	/// @brief Collects texture and buffer uploads and sends all of them to the GPU in one submission.
+	/// Every added texture gets its image right away, the layout transitions, buffer copies and mip blits of the whole
+	/// batch are recorded into one command buffer with the barriers of all images grouped together, and the batch is
+	/// tracked by a single fence instead of idling the queue for every copy.
+	/// flush() submits without waiting, poll() or wait() run the completions of submissions that finished and hand their
+	/// staging memory back to the staging ring.
+	/// With a transfer queue the copies run there and the graphics queue takes the images and buffers over once they are
+	/// done, so frames keep rendering while large uploads are copied
+	class GraphicsUploadBatch
+	{
+	public:
+		/// @brief Queue of a transfer only family and the families ownership moves between
+		struct TransferQueue
+		{
+			VkQueue queue;
+			uint32_t family;
+			uint32_t graphicsFamily;
+		};
+
+		/// @brief Runs after the submission finished. The handle is a copy owned by nobody yet, whoever keeps it has to
+		/// Free it eventually. When the upload failed isReady() is false and getError() tells why
+		using Completion = std::function<void(GraphicsTextureHandle&)>;
+		/// @brief Runs after streamed levels or image regions reached the GPU. Not called when the submission failed
+		using LevelCompletion = std::function<void()>;
+
+		GraphicsUploadBatch();
+		~GraphicsUploadBatch();
+		GraphicsUploadBatch(const GraphicsUploadBatch&) = delete;
+		GraphicsUploadBatch& operator=(const GraphicsUploadBatch&) = delete;
+
+		/// @brief Without a transfer queue everything runs on graphicsQueue. The staging memory has to be readable from both
+		/// families when there is one, see StagingRing::init
+		bool init(VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, const TransferQueue& transfer = {});
+		/// @brief Waits for submissions still in flight, then drops them and whatever was added but never submitted.
+		/// No completions run
+		void Free();
+		std::string_view getError() const;
+
+		/// @brief Creates the image for staged and queues its upload. Takes over the staging buffer, success or not.
+		/// onReady is not called when this returns false
+		bool addTexture(StagedTexture& staged, VkDescriptorSetLayout descriptorSetLayout, Completion onReady);
+
+		/// @brief Queues the upload of more mip levels into the image of an already uploaded texture. Takes over the staging
+		/// buffer, success or not. Only levels finer than the resident ones, the texture's view leaves them out until
+		/// setResidentLevel is called. The texture has to stay alive until onReady ran
+		bool addLevels(StagedTexture& staged, const GraphicsTextureHandle& texture, LevelCompletion onReady);
+
+		/// @brief Queues copies from the staging buffer of staged into parts of an existing image, touching the levels
+		/// [baseLevel, baseLevel + levelCount). With preserveContents what the copies leave out keeps its texels and the copies
+		/// wait for draws still sampling the image, otherwise those levels start out undefined and no descriptor may reach
+		/// them until onReady ran, they are written on the transfer queue without being taken over from the graphics family.
+		/// Takes over the staging buffer, success or not. The image has to stay alive until onReady ran
+		bool addRegions(VkImage image, uint32_t baseLevel, uint32_t levelCount, bool preserveContents, StagedTexture& staged, std::vector<VkBufferImageCopy> regions, LevelCompletion onReady);
+
+		/// @brief Queues a copy of size bytes from a staging allocation into destination, which the commands at dstStage then
+		/// read through dstAccess. Takes over the allocation, success or not. destination has to stay alive until onReady ran
+		bool addBuffer(Util::StagingAllocation& staging, VkBuffer destination, VkDeviceSize size, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess, LevelCompletion onReady = {});
+
+		/// @brief Textures, streamed levels, region updates and buffer copies waiting for flush
+		size_t size() const;
+		/// @brief Submissions the GPU has not been seen to finish yet
+		size_t inFlight() const;
+		bool usesTransferQueue() const;
+
+		/// @brief Records and submits everything added so far without waiting for it. Work submitted later on the graphics
+		/// queue sees the uploads once their completions ran, which happens from poll() or wait(). Does nothing for an empty
+		/// batch. When the submission fails what was added is dropped without completions
+		bool flush();
+		/// @brief Hands finished copies over to the graphics queue and runs the completions of every submission that finished,
+		/// in submission order. Never blocks
+		bool poll();
+		/// @brief Blocks until every submission finished and runs their completions
+		bool wait();
+		/// @brief flush() and wait()
+		bool submit();
+
+	private:
+		struct Entry
+		{
+			GraphicsTextureHandle handle;
+			StagedTexture staged;
+			VkDescriptorSetLayout descriptorSetLayout;
+			Completion onReady;
+		};
+
+		struct RegionEntry
+		{
+			VkImage image;
+			uint32_t baseLevel;
+			uint32_t levelCount;
+			bool preserveContents;
+			StagedTexture staged;
+			std::vector<VkBufferImageCopy> regions;
+			LevelCompletion onReady;
+		};
+
+		struct BufferEntry
+		{
+			Util::StagingAllocation staging;
+			VkBuffer destination;
+			VkDeviceSize size;
+			VkPipelineStageFlags dstStage;
+			VkAccessFlags dstAccess;
+			LevelCompletion onReady;
+		};
+
+		/// @brief Everything that goes into one command buffer
+		struct Work
+		{
+			std::vector<Entry> entries;
+			std::vector<RegionEntry> regionEntries;
+			std::vector<BufferEntry> bufferEntries;
+
+			bool empty() const;
+		};
+
+		struct Submission
+		{
+			/// @brief Only with a transfer queue, copyFence signals once the copies are done
+			VkFence copyFence{ nullptr };
+			VkCommandBuffer copyCommandBuffer{ nullptr };
+			VkSemaphore copied{ nullptr };
+			/// @brief Graphics queue part. fence stays null until commandBuffer was submitted
+			VkFence fence{ nullptr };
+			VkCommandBuffer commandBuffer{ nullptr };
+			Work work;
+		};
+
+		/// @brief The copies of work. With release they are recorded for the transfer queue and end in barriers that hand
+		/// what they wrote to the graphics family
+		void recordCopies(VkCommandBuffer commandBuffer, const Work& work, bool release) const;
+		/// @brief Graphics queue part after recordCopies. With acquire it takes over what the transfer queue released and
+		/// does the copies into images that are sampled already. Then mips are generated and everything goes to the shaders
+		void recordFinish(VkCommandBuffer commandBuffer, const Work& work, bool acquire) const;
+		/// @brief Submits the graphics part of a submission whose copies finished
+		bool submitFinish(Submission& submission);
+		void destroy(Submission& submission);
+		/// @brief Hands the staging memory of work back, and frees the images of textures that never completed
+		void release(Work& work, bool keepTextures);
+		/// @brief Finishes the submissions that are done, or all of them when block is set
+		bool complete(bool block);
+
+		VkDevice device{ nullptr };
+		VkPhysicalDevice physicalDevice{ nullptr };
+		VkQueue graphicsQueue{ nullptr };
+		VkCommandPool commandPool{ nullptr };
+		TransferQueue transfer{};
+		VkCommandPool transferPool{ nullptr };
+		std::string currentError;
+
+		Work pending;
+		std::vector<Submission> submissions;
+	};
+
+	/// @brief The renderer's batch, flushed once per frame. Meshes queue their buffer copies into it instead of submitting
+	/// and waiting for a batch of their own. nullptr makes them do that again
+	void useUploadBatch(GraphicsUploadBatch* batch);
+	GraphicsUploadBatch* sharedUploadBatch();
+}
@@ -1,249 +1,279 @@
 #include "GraphicEngine/GraphicsVertex.hpp"
+#include "GraphicEngine/GraphicsUploadBatch.hpp"
+#include "GraphicEngine/Utility/AssetPack.hpp"
 #include "GraphicEngine/Utility/DeviceSupport.hpp"
+#include "GraphicEngine/Utility/FileMapping.hpp"
+#include "GraphicEngine/Utility/GlbReader.hpp"
+#include "GraphicEngine/Utility/Hashing.hpp"
 #include "GraphicEngine/Utility/MemorySupport.hpp"
+#include "GraphicEngine/Utility/MeshCache.hpp"
+#include "GraphicEngine/Utility/MeshImport.hpp"
+#include "GraphicEngine/Utility/VertexQuantization.hpp"
+#include "GraphicEngine/Utility/BlockCompression.hpp"
+#include "GraphicEngine/Utility/TextureContainer.hpp"
 
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
 
 // Only 1 file should define the implemenation
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 
 namespace {
 
-	std::string createBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
-	{
-		VkBufferCreateInfo bufferInfo{};
-		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		bufferInfo.size = size;
-		bufferInfo.usage = usage;
-		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-		if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) { return "failed to create buffer!"; }
-
-		VkMemoryRequirements memRequirements;
-		vkGetBufferMemoryRequirements(device, buffer, &memRequirements);
-
-		VkMemoryAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocInfo.allocationSize = memRequirements.size;
-		allocInfo.memoryTypeIndex = GE::Util::findMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties);
+	std::atomic<size_t> hostMeshBytesTotal{ 0 };
 
-		if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) { return "failed to allocate buffer memory!"; }
-
-		vkBindBufferMemory(device, buffer, bufferMemory, 0);
-
-		return "";
+	bool formatCanBeSampled(VkPhysicalDevice physicalDevice, VkFormat format)
+	{
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
+		return (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0;
 	}
 
-
-	std::string transitionImageLayout(VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels)
+	/// @brief Mip chains of formats that can not be filtered or blitted can not be generated on the GPU
+	bool formatCanBeMipmapped(VkPhysicalDevice physicalDevice, VkFormat format)
 	{
-		// Could copy image data into bkCmdCopyBufferToImage. but we need to have image in the right layout
-		VkCommandBuffer commandBuffer = GE::Util::beginSingleTimeCommands(device, commandPool);
-
-		// Barries are used to synchronize access to resouces, like images. 
-		VkImageMemoryBarrier barrier{};
-		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		barrier.oldLayout = oldLayout; // Can use VK_IMAGE_LAYOUT_UNDEFINED if we don't care about existing contents of image
-		barrier.newLayout = newLayout;
-
-		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED; //used if we are transforing ownership of queues
-		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-
-		barrier.image = image;
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		barrier.subresourceRange.baseMipLevel = 0;
-		barrier.subresourceRange.levelCount = mipLevels;
-		barrier.subresourceRange.baseArrayLayer = 0;
-		barrier.subresourceRange.layerCount = 1;
+		constexpr VkFormatFeatureFlags needed = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT | VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
+		return (formatProperties.optimalTilingFeatures & needed) == needed;
+	}
 
-		VkPipelineStageFlags sourceStage;
-		VkPipelineStageFlags destinationStage;
+	/// @brief Smallest 8 bit format that holds channels. Rgb goes to rgba since hardly any device samples 24 bit formats,
+	/// and so does anything the device can not mipmap (the sRGB R8 and RG8 formats are optional)
+	VkFormat textureFormatFor(VkPhysicalDevice physicalDevice, int channels, GE::TextureUsage usage)
+	{
+		const bool srgb = usage == GE::TextureUsage::Color;
+		const VkFormat rgba = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+		VkFormat format = rgba;
+		if (channels == 1) format = srgb ? VK_FORMAT_R8_SRGB : VK_FORMAT_R8_UNORM;
+		else if (channels == 2) format = srgb ? VK_FORMAT_R8G8_SRGB : VK_FORMAT_R8G8_UNORM;
+		if (format != rgba && !formatCanBeMipmapped(physicalDevice, format)) return rgba;
+		return format;
+	}
 
-		// More information on the aforementioned table
-		// https://registry.khronos.org/vulkan/specs/1.3-extensions/html/chap7.html#VkPipelineStageFlagBits
-		// First stage within the transition
-		if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-			barrier.srcAccessMask = 0; // Don't need to wait on anything
-			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT; // Going to copy image data over to shader
+	uint16_t formatChannels(VkFormat format)
+	{
+		switch (format) {
+		case VK_FORMAT_R8_SRGB: case VK_FORMAT_R8_UNORM: return 1;
+		case VK_FORMAT_R8G8_SRGB: case VK_FORMAT_R8G8_UNORM: return 2;
+		default: return 4;
+		}
+	}
 
-			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-			destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;//Not real graphic pipeline stage. Its a pseudo stage where the transfer is happings.
+	/// @brief Shaders read gray textures the way stb_image used to expand them, gray in rgb and alpha in a
+	VkComponentMapping textureSwizzle(VkFormat format)
+	{
+		switch (formatChannels(format)) {
+		case 1: return { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_ONE };
+		case 2: return { VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_G };
+		default: return {};
 		}
-		// Second stage of transision
-		else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	}
 
-			sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-			destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	const char* formatName(VkFormat format)
+	{
+		switch (format) {
+		case VK_FORMAT_R8_SRGB: return "R8_SRGB";
+		case VK_FORMAT_R8_UNORM: return "R8_UNORM";
+		case VK_FORMAT_R8G8_SRGB: return "RG8_SRGB";
+		case VK_FORMAT_R8G8_UNORM: return "RG8_UNORM";
+		case VK_FORMAT_R8G8B8A8_SRGB: return "RGBA8_SRGB";
+		case VK_FORMAT_R8G8B8A8_UNORM: return "RGBA8_UNORM";
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK: return "BC1_SRGB";
+		case VK_FORMAT_BC3_SRGB_BLOCK: return "BC3_SRGB";
+		default: return "other";
 		}
-		else { return "unsupported layout transition!"; }
+	}
 
-		// 2nd param - defines pipeline stage the operation occurs before the barrier
-		// 3rd param - pipeline stage in which to wait for barrier
-		// 4th - 0 or VK_DEPENDENCY_BY_REGION_BIT. Allow to read part that were written.
-		// 5th - reference to memory barriers
-		// 6th - buffer memory barriers
-		// 7th - image memory barriers
-		vkCmdPipelineBarrier(
-			commandBuffer,
-			sourceStage, destinationStage,
-			0,
-			0, nullptr,
-			0, nullptr,
-			1, &barrier
-		);
+	/// @brief Same expansion stb_image does when asked for rgba
+	std::vector<unsigned char> expandToRgba(const unsigned char* pixels, size_t pixelCount, uint16_t channels)
+	{
+		std::vector<unsigned char> rgba(pixelCount * 4);
+		for (size_t i = 0; i < pixelCount; i++) {
+			const unsigned char* source = pixels + i * channels;
+			unsigned char* target = rgba.data() + i * 4;
+			target[0] = source[0];
+			target[1] = channels >= 3 ? source[1] : source[0];
+			target[2] = channels >= 3 ? source[2] : source[0];
+			target[3] = channels == 2 ? source[1] : channels == 4 ? source[3] : 255;
+		}
+		return rgba;
+	}
 
-		GE::Util::endSingleTimeCommands(commandBuffer, device, commandPool, graphicsQueue);
+	VkFormat toVkFormat(GE::Util::TextureFormat format)
+	{
+		switch (format) {
+		case GE::Util::TextureFormat::BC1_SRGB: return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+		case GE::Util::TextureFormat::BC3_SRGB: return VK_FORMAT_BC3_SRGB_BLOCK;
+		default: return VK_FORMAT_R8G8B8A8_SRGB;
+		}
+	}
 
+	std::string fillStagingBuffer(VkDevice device, VkPhysicalDevice physicalDevice, const void* bytes, VkDeviceSize size, GE::StagedTexture& staged)
+	{
+		if (auto errorMessage = GE::Util::allocateStaging(device, physicalDevice, size, staged.staging); !errorMessage.empty()) {
+			staged.Free(device);
+			return "staging buffer: " + errorMessage;
+		}
+		std::memcpy(staged.staging.mapped, bytes, static_cast<size_t>(size));
 		return "";
 	}
 
-
-
-	std::string copyBufferToImage(VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
+	/// @brief Stages levels [firstLevel, lastLevel) of an open container
+	std::string stageContainerLevels(const GE::Util::TextureContainer& container, const std::string& filePath, uint32_t firstLevel, uint32_t lastLevel, VkDevice device, VkPhysicalDevice physicalDevice, GE::StagedTexture& staged)
 	{
-		VkCommandBuffer commandBuffer = GE::Util::beginSingleTimeCommands(device, commandPool);
-
-		VkBufferImageCopy region{};
-		region.bufferOffset = 0;
-		region.bufferRowLength = 0;
-		region.bufferImageHeight = 0;
-
-		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		region.imageSubresource.mipLevel = 0;
-		region.imageSubresource.baseArrayLayer = 0;
-		region.imageSubresource.layerCount = 1;
+		staged.pictureWidth = static_cast<int>(container.width());
+		staged.pictureHeight = static_cast<int>(container.height());
+		staged.pixelSize = 4;
+		staged.mipLevel = container.levelCount();
+		staged.format = toVkFormat(container.format());
+		staged.firstLevel = firstLevel;
+		staged.levels.clear();
+
+		if (!GE::Util::isBlockCompressed(container.format()) || formatCanBeSampled(physicalDevice, staged.format)) {
+			// The level data is already in upload order, the mapped levels go straight into the staging buffer
+			const uint64_t begin = container.level(firstLevel).offset;
+			const auto& last = container.level(lastLevel - 1);
+			for (uint32_t i = firstLevel; i < lastLevel; i++) {
+				const auto& level = container.level(i);
+				staged.levels.push_back({ level.offset - begin, level.width, level.height });
+			}
+			return fillStagingBuffer(device, physicalDevice, container.payload() + (begin - container.payloadOffset()), last.offset + last.size - begin, staged);
+		}
 
-		region.imageOffset = { 0, 0, 0 };
-		region.imageExtent = {
-			width,
-			height,
-			1
-		};
+		// Device can not sample BC formats. Still better than stb since the mips are baked, but the VRAM win is lost.
+		// Streamed levels come after the coarsest one was staged, so this warns once per texture
+		if (lastLevel == container.levelCount()) std::cout << "WARNING " << filePath << " is block compressed but the device can not sample it, decompressing" << std::endl;
+		std::vector<uint8_t> pixels;
+		for (uint32_t i = firstLevel; i < lastLevel; i++) {
+			const auto& level = container.level(i);
+			const auto* blocks = reinterpret_cast<const uint8_t*>(container.payload() + (level.offset - container.payloadOffset()));
+			GE::Util::ImageLevel decoded = container.format() == GE::Util::TextureFormat::BC1_SRGB ? GE::Util::decodeBC1(blocks, level.width, level.height) : GE::Util::decodeBC3(blocks, level.width, level.height);
+			staged.levels.push_back({ pixels.size(), level.width, level.height });
+			pixels.insert(pixels.end(), decoded.pixels.begin(), decoded.pixels.end());
+		}
+		staged.format = VK_FORMAT_R8G8B8A8_SRGB;
+		return fillStagingBuffer(device, physicalDevice, pixels.data(), pixels.size(), staged);
+	}
 
-		vkCmdCopyBufferToImage(
-			commandBuffer,
-			buffer,
-			image,
-			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,// Need to match up with the operation that was defined when allocating the image
-			1,
-			&region
-		);
+	/// @brief Stages the mip chain of a container, leaving out the levels larger than maxLevelSize unless it is 0
+	std::string stageContainer(const std::string& filePath, uint32_t maxLevelSize, VkDevice device, VkPhysicalDevice physicalDevice, GE::StagedTexture& staged)
+	{
+		GE::Util::TextureContainer container;
+		if (!container.open(filePath)) { return std::string(container.getError()); }
 
-		GE::Util::endSingleTimeCommands(commandBuffer, device, commandPool, graphicsQueue);
-		return "";
+		uint32_t firstLevel = 0;
+		if (maxLevelSize > 0) {
+			while (firstLevel + 1 < container.levelCount() && std::max(container.level(firstLevel).width, container.level(firstLevel).height) > maxLevelSize) firstLevel++;
+		}
+		return stageContainerLevels(container, filePath, firstLevel, container.levelCount(), device, physicalDevice, staged);
 	}
 
-
-	std::string generateMipmaps(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, VkQueue graphicsQueue, VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
+	std::string stageImage(const std::string& filePath, GE::TextureUsage usage, VkDevice device, VkPhysicalDevice physicalDevice, GE::StagedTexture& staged)
 	{
-		// Check if image format supports linear blitting
-		VkFormatProperties formatProperties;
-		vkGetPhysicalDeviceFormatProperties(physicalDevice, imageFormat, &formatProperties);
-
-		// 2 other options.
-		// 1) Create a feature that allows for mipmapping on certain images
-		// 2) Precompile images which will be used in replace with the blitting
-		if (!(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) { return "texture image format does not support linear blitting!"; }
-
-		VkCommandBuffer commandBuffer = GE::Util::beginSingleTimeCommands(device, commandPool);
-
-		VkImageMemoryBarrier barrier{};
-		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		barrier.image = image;
-		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		barrier.subresourceRange.baseArrayLayer = 0;
-		barrier.subresourceRange.layerCount = 1;
-		barrier.subresourceRange.levelCount = 1;
-
-		int32_t mipWidth = texWidth;
-		int32_t mipHeight = texHeight;
-
-		for (uint32_t i = 1; i < mipLevels; i++) {
-			barrier.subresourceRange.baseMipLevel = i - 1;
-			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-			vkCmdPipelineBarrier(commandBuffer,
-				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
-				0, nullptr,
-				0, nullptr,
-				1, &barrier);
-
-			VkImageBlit blit{};
-			blit.srcOffsets[0] = { 0, 0, 0 };
-			blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
-			blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			blit.srcSubresource.mipLevel = i - 1;
-			blit.srcSubresource.baseArrayLayer = 0;
-			blit.srcSubresource.layerCount = 1;
-			blit.dstOffsets[0] = { 0, 0, 0 };
-			blit.dstOffsets[1] = { mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1 };
-			blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			blit.dstSubresource.mipLevel = i;
-			blit.dstSubresource.baseArrayLayer = 0;
-			blit.dstSubresource.layerCount = 1;
-
-			vkCmdBlitImage(commandBuffer,
-				image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-				image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-				1, &blit,
-				VK_FILTER_LINEAR);
-
-			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-			vkCmdPipelineBarrier(commandBuffer,
-				VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-				0, nullptr,
-				0, nullptr,
-				1, &barrier);
-
-			if (mipWidth > 1) mipWidth /= 2;
-			if (mipHeight > 1) mipHeight /= 2;
-		}
-
-
-		barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-		vkCmdPipelineBarrier(commandBuffer,
-			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-			0, nullptr,
-			0, nullptr,
-			1, &barrier);
-
-		GE::Util::endSingleTimeCommands(commandBuffer, device, commandPool, graphicsQueue);
-
-		return "";
+		staged.levels.clear();
+		staged.firstLevel = 0;
+
+		// The encoded file is decoded straight out of the mapping. stb_image still decodes into memory it allocates itself,
+		// so the pixels take one copy into the staging buffer. Images embedded in a .glb are decoded out of its mapping
+		GE::Util::MappedFile file;
+		GE::Util::GlbFile glb;
+		std::span<const char> bytes;
+		std::string glbPath;
+		uint32_t image = 0;
+		if (GE::Util::GlbFile::splitImagePath(filePath, glbPath, image)) {
+			if (!glb.open(glbPath)) { return std::string(glb.getError()); }
+			if (auto errorMessage = glb.imageBytes(image, bytes); !errorMessage.empty()) { return errorMessage; }
+		}
+		else {
+			if (!file.open(filePath)) { return std::string(file.getError()); }
+			bytes = file.span();
+		}
+		const auto* encoded = reinterpret_cast<const stbi_uc*>(bytes.data());
+		int texChannels = 0;
+		if (!stbi_info_from_memory(encoded, static_cast<int>(bytes.size()), &staged.pictureWidth, &staged.pictureHeight, &texChannels)) { return "failed to load texture image " + filePath; }
+		// Decoded with only the channels the file has, a gray mask takes a quarter of what rgba would
+		staged.format = textureFormatFor(physicalDevice, texChannels, usage);
+		staged.pixelSize = formatChannels(staged.format);
+		stbi_uc* pixels = stbi_load_from_memory(encoded, static_cast<int>(bytes.size()), &staged.pictureWidth, &staged.pictureHeight, &texChannels, staged.pixelSize);
+		file.close();
+		if (pixels == nullptr) { return "failed to load texture image " + filePath; }
+
+		const VkDeviceSize imageSize = static_cast<VkDeviceSize>(staged.pictureWidth) * staged.pictureHeight * staged.pixelSize;
+		auto errorMessage = fillStagingBuffer(device, physicalDevice, pixels, imageSize, staged);
+		stbi_image_free(pixels);
+		return errorMessage;
 	}
 
+	/// @brief Hash of an image's bytes. Remembered with the file's time and size, levels streamed one at a time would
+	/// otherwise hash the same image again for every level
+	uint64_t sourceImageHash(const std::string& filePath, uint64_t size, std::filesystem::file_time_type writeTime, bool& found)
+	{
+		struct KnownHash { std::filesystem::file_time_type writeTime; uint64_t size; uint64_t hash; };
+		static std::mutex mutex;
+		static std::unordered_map<std::string, KnownHash> known;
+		{
+			std::lock_guard lock(mutex);
+			auto entry = known.find(filePath);
+			if (entry != known.end() && entry->second.writeTime == writeTime && entry->second.size == size) { found = true; return entry->second.hash; }
+		}
 
+		GE::Util::MappedFile file;
+		found = file.open(filePath);
+		if (!found) return 0;
+		const uint64_t hash = GE::Util::hashBytes(file.data(), file.size());
+		std::lock_guard lock(mutex);
+		known[filePath] = KnownHash{ writeTime, size, hash };
+		return hash;
+	}
 
+	/// @brief The .gtex baked next to an image, if it was baked from the image as it is now
+	std::string findBakedContainer(const std::string& filePath)
+	{
+		namespace fs = std::filesystem;
+		std::string glbPath;
+		uint32_t image = 0;
+		if (GE::Util::GlbFile::splitImagePath(filePath, glbPath, image)) return ""; // nothing gets baked for embedded images
+		std::error_code errorCode;
+		const fs::path baked = fs::path(filePath).replace_extension(GE::Util::TextureContainer::Extension);
+		// The pack is built from baked output, what it holds is current by definition
+		if (GE::Util::assetInPack(baked.string())) return baked.string();
+		if (!fs::exists(baked, errorCode)) return "";
+		// Only the container was shipped, it is all we have
+		if (!fs::exists(filePath, errorCode)) return baked.string();
+
+		// A container is used only while the image still matches the size and content hash it was baked from. The write
+		// time just keys the remembered hash, so streaming the levels hashes the image once
+		GE::Util::TextureContainer container;
+		if (!container.open(baked.string())) return "";
+		const uint64_t size = fs::file_size(filePath, errorCode);
+		if (errorCode || container.sourceSize() != size) return "";
+		const auto writeTime = fs::last_write_time(filePath, errorCode);
+		if (errorCode) return "";
+		bool found = false;
+		const uint64_t hash = sourceImageHash(filePath, size, writeTime, found);
+		if (!found || hash != container.contentHash()) return "";
+		return baked.string();
+	}
 }
 
 namespace GE
 {
-	VkVertexInputBindingDescription Vertex::getBindingDescription()
+	size_t vertexStride(VertexLayout layout) { return layout == VertexLayout::Float ? sizeof(Vertex) : sizeof(CompactVertex); }
+
+	VkVertexInputBindingDescription Vertex::getBindingDescription(VertexLayout layout)
 	{
 		VkVertexInputBindingDescription bindingDescription{};
 		bindingDescription.binding = 0;
-		bindingDescription.stride = sizeof(Vertex);
+		bindingDescription.stride = static_cast<uint32_t>(vertexStride(layout));
 		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 		return bindingDescription;
 	}
@@ -252,9 +282,17 @@ namespace GE
 		return pos == other.pos && color == other.color && texCoord == other.texCoord;
 	}
 
-	std::array<VkVertexInputAttributeDescription, 3> Vertex::getAttributeDescriptions()
+	std::array<VkVertexInputAttributeDescription, 3> Vertex::getAttributeDescriptions(VertexLayout layout)
 	{
 		std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
+		if (layout != VertexLayout::Float) {
+			// Same locations, the fetch unpacks into the vec3/vec2 inputs the shaders declare. The pos w and color alpha are dropped
+			attributeDescriptions[0] = { 0, 0, VK_FORMAT_R16G16B16A16_UNORM, static_cast<uint32_t>(offsetof(CompactVertex, pos)) };
+			attributeDescriptions[1] = { 1, 0, VK_FORMAT_R8G8B8A8_UNORM, static_cast<uint32_t>(offsetof(CompactVertex, color)) };
+			attributeDescriptions[2] = { 2, 0, layout == VertexLayout::CompactUnormUV ? VK_FORMAT_R16G16_UNORM : VK_FORMAT_R16G16_SFLOAT, static_cast<uint32_t>(offsetof(CompactVertex, texCoord)) };
+			return attributeDescriptions;
+		}
+
 		attributeDescriptions[0].binding = 0;
 		attributeDescriptions[0].location = 0; // Look into our sharder.vert file. 
 		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
@@ -274,19 +312,48 @@ namespace GE
 	}
 
 
+	HostMeshBytes::HostMeshBytes(const HostMeshBytes& other) { set(other.bytes); }
+	HostMeshBytes& HostMeshBytes::operator=(const HostMeshBytes& other)
+	{
+		set(other.bytes);
+		return *this;
+	}
+	HostMeshBytes::~HostMeshBytes() { set(0); }
+	void HostMeshBytes::set(size_t bytes)
+	{
+		hostMeshBytesTotal += bytes;
+		hostMeshBytesTotal -= this->bytes;
+		this->bytes = bytes;
+	}
+	size_t HostMeshBytes::get() const { return bytes; }
+	size_t HostMeshBytes::total() { return hostMeshBytesTotal; }
+
+
+
 	VerticesHandle::VerticesHandle() = default;
 	VerticesHandle::~VerticesHandle() = default;
 	void VerticesHandle::Free() {
 		if (device == nullptr)return;
 
+		// Dropped before the frame that uploads it, the copies into the buffers have to be done before they go
+		if (pendingCopies && *pendingCopies > 0) {
+			if (GraphicsUploadBatch* batch = sharedUploadBatch(); batch != nullptr && !batch->submit()) std::cout << "ERROR " << batch->getError() << std::endl;
+		}
+		pendingCopies.reset();
+
 		if (internals.indexBuffer != nullptr)vkDestroyBuffer(device, internals.indexBuffer, nullptr);
 		if (internals.indexBufferMemory != nullptr)vkFreeMemory(device, internals.indexBufferMemory, nullptr);
 		if (internals.vertexBuffer != nullptr)vkDestroyBuffer(device, internals.vertexBuffer, nullptr);
 		if (internals.vertexBufferMemory != nullptr)vkFreeMemory(device, internals.vertexBufferMemory, nullptr);
+
+		internals.vertices = {};
+		internals.indices = {};
+		internals.clusters = {};
+		hostMeshBytes.set(0);
 	}
 	std::string_view VerticesHandle::getError() const { return currentError; }
 	const VerticesInternal& VerticesHandle::Internals()const { return internals; }
-	bool VerticesHandle::init(std::string_view filePath, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout)
+	bool VerticesHandle::init(std::string_view filePath, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout, VertexLayout vertexLayout, MeshResidency residency)
 	{
 		if (device == nullptr) {
 			currentError = "Must insert a valid device";
@@ -308,47 +375,82 @@ namespace GE
 		}
 		this->device = device;
 
-		tinyobj::attrib_t attrib;
-		std::vector<tinyobj::shape_t> shapes;
-		std::vector<tinyobj::material_t> materials;
-		std::string warn, err;
+		// glTF binaries interleaved like Vertex with 32 bit indices are read out of the mapping, anything else is converted
+		// first. Only pipelines with the float layout take the bytes as they are, the others still pack them
+		if (Util::GlbFile::isGlb(filePath)) {
+			Util::GlbFile glb;
+			Util::GlbMesh mesh;
+			if (!glb.open(std::string(filePath))) {
+				currentError = glb.getError();
+				return false;
+			}
+			if (auto errorMessage = glb.readMesh(mesh); !errorMessage.empty()) {
+				currentError = errorMessage;
+				return false;
+			}
+			const bool straight = mesh.inFile() && vertexLayout == VertexLayout::Float;
+			if (straight && PRINT_ENGINE_STATS) std::cout << "Uploading " << filePath << " straight from the file" << std::endl;
+			const bool uploaded = uploadMesh(mesh.vertices.data(), mesh.vertices.size(), mesh.indices.data(), mesh.indices.size(), vertexLayout, physicalDevice, graphicsQueue, commandPool,
+				mesh.bounds ? &*mesh.bounds : nullptr, !straight);
+			if (uploaded && residency == MeshResidency::Keep) {
+				internals.vertices.assign(mesh.vertices.begin(), mesh.vertices.end());
+				internals.indices.assign(mesh.indices.begin(), mesh.indices.end());
+			}
+			applyResidency(residency);
+			return uploaded;
+		}
 
-		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filePath.data())) { currentError = (warn + err); return false; }
+		// A fresh binary cache lets us skip the text parsing and the vertex dedupe entirely.
+		// The upload reads straight out of the mapped file, the geometry is only copied out when it has to stay on the host
+		Util::MeshCache meshCache;
+		if (meshCache.open(filePath)) {
+			internals.lods.assign(meshCache.lods(), meshCache.lods() + meshCache.lodCount());
+			internals.clusters.assign(meshCache.clusters(), meshCache.clusters() + meshCache.clusterCount());
+			cacheHit = true;
+			const bool uploaded = uploadMesh(meshCache.vertices(), meshCache.vertexCount(), meshCache.indices(), meshCache.indexCount(), vertexLayout, physicalDevice, graphicsQueue, commandPool);
+			if (uploaded && residency == MeshResidency::Keep) {
+				internals.vertices.assign(meshCache.vertices(), meshCache.vertices() + meshCache.vertexCount());
+				internals.indices.assign(meshCache.indices(), meshCache.indices() + meshCache.indexCount());
+			}
+			applyResidency(residency);
+			return uploaded;
+		}
 
-		std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-		std::vector<uint32_t> indices;
 		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+		std::vector<MeshLod> lods;
+		std::vector<MeshCluster> clusters;
+		if (auto errorMessage = Util::importObjMesh(std::string(filePath), vertices, indices, lods, clusters); !errorMessage.empty()) {
+			currentError = errorMessage;
+			return false;
+		}
 
-		for (const auto& shape : shapes) {
-			for (const auto& index : shape.mesh.indices) {
-				Vertex vertex{};
-
-				vertex.pos = {
-					attrib.vertices[3 * index.vertex_index + 0],
-					attrib.vertices[3 * index.vertex_index + 1],
-					attrib.vertices[3 * index.vertex_index + 2]
-				};
-
-				vertex.texCoord = {
-					attrib.texcoords[2 * index.texcoord_index + 0],
-					1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-				};
-
-				vertex.color = { 1.0f, 1.0f, 1.0f };
-
-				if (uniqueVertices.count(vertex) == 0) {
-					uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-					vertices.push_back(vertex);
-				}
-
-				indices.push_back(uniqueVertices[vertex]);
+		// Not being able to write the cache only costs us speed on the next load. Packed sources have no directory to write it to
+		if (!Util::assetInPack(filePath)) {
+			if (auto errorMessage = Util::MeshCache::write(filePath, vertices, indices, lods, clusters); !errorMessage.empty()) {
+				std::cout << "WARNING mesh cache for " << filePath << " not written: " << errorMessage << std::endl;
 			}
 		}
 
-		return init(vertices,indices,device,physicalDevice,graphicsQueue,commandPool,descriptorSetLayout);
+		internals.lods = std::move(lods);
+		internals.clusters = std::move(clusters);
+		return init(std::move(vertices), std::move(indices), device, physicalDevice, graphicsQueue, commandPool, descriptorSetLayout, vertexLayout, residency);
 	}
 
-	bool VerticesHandle::init(std::vector<Vertex> vertices, std::vector<uint32_t> indices, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout)
+	bool VerticesHandle::init(std::vector<Vertex> vertices, std::vector<uint32_t> indices, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout, VertexLayout vertexLayout, MeshResidency residency)
+	{
+		// Upload from the vectors without keeping a copy, then move them in if they are to stay
+		const MeshResidency uploadResidency = residency == MeshResidency::Keep ? MeshResidency::BoundsOnly : residency;
+		if (!init(std::span<const Vertex>(vertices), std::span<const uint32_t>(indices), device, physicalDevice, graphicsQueue, commandPool, descriptorSetLayout, vertexLayout, uploadResidency)) return false;
+		if (residency == MeshResidency::Keep) {
+			internals.vertices = std::move(vertices);
+			internals.indices = std::move(indices);
+			applyResidency(residency);
+		}
+		return true;
+	}
+
+	bool VerticesHandle::init(std::span<const Vertex> vertices, std::span<const uint32_t> indices, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout, VertexLayout vertexLayout, MeshResidency residency)
 	{
 		if (device == nullptr) {
 			currentError = "Must insert a valid device";
@@ -371,76 +473,212 @@ namespace GE
 		this->device = device;
 
 
-		internals.vertices = vertices;
-		internals.indices = indices;
+		const bool uploaded = uploadMesh(vertices.data(), vertices.size(), indices.data(), indices.size(), vertexLayout, physicalDevice, graphicsQueue, commandPool);
+		if (uploaded && residency == MeshResidency::Keep) {
+			internals.vertices.assign(vertices.begin(), vertices.end());
+			internals.indices.assign(indices.begin(), indices.end());
+		}
+		applyResidency(residency);
+		return uploaded;
+	}
+
+	bool VerticesHandle::isReady() const { return internals.vertexBuffer != nullptr && (!pendingCopies || *pendingCopies == 0); }
+	bool VerticesHandle::loadedFromCache() const { return cacheHit; }
+	size_t VerticesHandle::hostBytes() const { return hostMeshBytes.get(); }
+	size_t VerticesHandle::totalHostBytes() { return HostMeshBytes::total(); }
 
-		{
-			VkDeviceSize bufferSize = sizeof(internals.vertices[0]) * internals.vertices.size();
-
-			VkBuffer stagingBuffer;
-			VkDeviceMemory stagingBufferMemory;
-			if (auto errorMessage = createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-				!errorMessage.empty()
-				) {
-				currentError = "vertices buffer 1: " + errorMessage;
-				return false;
+	void VerticesHandle::applyResidency(MeshResidency residency)
+	{
+		internals.residency = residency;
+		if (residency != MeshResidency::Keep) {
+			internals.vertices = {};
+			internals.indices = {};
+		}
+		if (residency == MeshResidency::Discard) internals.clusters = {};
+		internals.lods.shrink_to_fit();
+		internals.clusters.shrink_to_fit();
+
+		hostMeshBytes.set(internals.vertices.capacity() * sizeof(Vertex) + internals.indices.capacity() * sizeof(uint32_t)
+			+ internals.lods.capacity() * sizeof(MeshLod) + internals.clusters.capacity() * sizeof(MeshCluster));
+	}
+
+	bool VerticesHandle::uploadMesh(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, VertexLayout vertexLayout, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool,
+		const MeshBounds* bounds, bool narrowIndices)
+	{
+		internals.vertexLayout = vertexLayout;
+		internals.indexCount = static_cast<uint32_t>(indexCount);
+		internals.dequantize = glm::mat4(1.0f);
+
+		if (bounds != nullptr) {
+			// The sphere around the box, a little looser than the one fitted to the vertices
+			internals.boundsCenter = (bounds->minimum + bounds->maximum) * 0.5f;
+			internals.boundsRadius = glm::length(bounds->maximum - bounds->minimum) * 0.5f;
+		}
+		else if (vertexCount > 0) {
+			glm::vec3 minimum = vertices[0].pos;
+			glm::vec3 maximum = vertices[0].pos;
+			for (size_t i = 1; i < vertexCount; i++) {
+				minimum = glm::min(minimum, vertices[i].pos);
+				maximum = glm::max(maximum, vertices[i].pos);
 			}
+			internals.boundsCenter = (minimum + maximum) * 0.5f;
+			internals.boundsRadius = 0.0f;
+			for (size_t i = 0; i < vertexCount; i++) internals.boundsRadius = std::max(internals.boundsRadius, glm::length(vertices[i].pos - internals.boundsCenter));
+		}
 
-			void* data;
-			vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-			memcpy(data, internals.vertices.data(), (size_t)bufferSize);
-			vkUnmapMemory(device, stagingBufferMemory);
+		// Packed and narrowed on the way into the staging memory, no intermediate copies
+		VkDeviceSize vertexBytes = sizeof(Vertex) * vertexCount;
+		StagingWriter writeVertices = [&](void* mapped) { std::memcpy(mapped, vertices, sizeof(Vertex) * vertexCount); };
+		if (vertexLayout != VertexLayout::Float) {
+			vertexBytes = sizeof(CompactVertex) * vertexCount;
+			writeVertices = [&](void* mapped) {
+				const Util::QuantizedVertices quantized = Util::quantizeVertices(vertices, vertexCount, vertexLayout, static_cast<CompactVertex*>(mapped));
+				if (quantized.clampedTexCoords > 0) { std::cout << "WARNING " << quantized.clampedTexCoords << " uvs outside [0,1] were clamped, use VertexLayout::Compact for tiling uvs" << std::endl; }
+				internals.dequantize = quantized.dequantizeMatrix();
+			};
+		}
 
-			// Reason for having this extra buffer, is so that we can load our vertex in more performant memory
-			if (auto errorMessage = createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, internals.vertexBuffer, internals.vertexBufferMemory);
-				!errorMessage.empty()) {
-				currentError = "Vertices buffer 2: " + errorMessage;
+		VkDeviceSize indexBytes = sizeof(uint32_t) * indexCount;
+		StagingWriter writeIndices = [&](void* mapped) { std::memcpy(mapped, indices, sizeof(uint32_t) * indexCount); };
+		internals.indexType = VK_INDEX_TYPE_UINT32;
+		if (narrowIndices && vertexCount <= UINT16_MAX + 1) {
+			indexBytes = sizeof(uint16_t) * indexCount;
+			writeIndices = [&](void* mapped) { Util::narrowIndices(indices, indexCount, static_cast<uint16_t*>(mapped)); };
+			internals.indexType = VK_INDEX_TYPE_UINT16;
+		}
+
+		if (vertexLayout != VertexLayout::Float && PRINT_ENGINE_STATS) {
+			std::cout << "Packed " << vertexCount << " vertices and " << indexCount << " indices into " << (vertexBytes + indexBytes) / 1024 << " KB ("
+				<< (sizeof(Vertex) * vertexCount + sizeof(uint32_t) * indexCount) / 1024 << " KB unpacked)" << std::endl;
+		}
+
+		return uploadBuffers(vertexBytes, writeVertices, indexBytes, writeIndices, physicalDevice, graphicsQueue, commandPool);
+	}
+
+	bool VerticesHandle::uploadBuffers(VkDeviceSize vertexBytes, const StagingWriter& writeVertices, VkDeviceSize indexBytes, const StagingWriter& writeIndices, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool)
+	{
+		// The copies join the renderer's batch, which goes out with the next frame together with every other mesh and texture
+		// queued until then. The mesh is drawn once they completed. Without a renderer both go into one submission of their own
+		GraphicsUploadBatch* batch = sharedUploadBatch();
+		GraphicsUploadBatch ownBatch;
+		if (batch == nullptr) {
+			if (!ownBatch.init(device, physicalDevice, graphicsQueue, commandPool)) {
+				currentError = std::string(ownBatch.getError());
 				return false;
 			}
-			Util::copyBuffer(stagingBuffer, internals.vertexBuffer, bufferSize, device, commandPool, graphicsQueue);
-			vkDestroyBuffer(device, stagingBuffer, nullptr);
-			vkFreeMemory(device, stagingBufferMemory, nullptr);
+			batch = &ownBatch;
+		}
+		else {
+			pendingCopies = std::make_shared<uint32_t>(0);
 		}
 
+		struct BufferUpload
 		{
-			VkDeviceSize bufferSize = sizeof(internals.indices[0]) * internals.indices.size();
-
-			VkBuffer stagingBuffer;
-			VkDeviceMemory stagingBufferMemory;
-			if (auto errorMessage = createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-				!errorMessage.empty()
-				) {
-				currentError = "indices buffer 1: " + errorMessage;
+			const char* name;
+			VkDeviceSize size;
+			const StagingWriter& write;
+			VkBufferUsageFlags usage;
+			VkAccessFlags readAccess;
+			VkBuffer& buffer;
+			VkDeviceMemory& memory;
+		};
+		const BufferUpload uploads[] = {
+			{ "vertices", vertexBytes, writeVertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, internals.vertexBuffer, internals.vertexBufferMemory },
+			{ "indices", indexBytes, writeIndices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_ACCESS_INDEX_READ_BIT, internals.indexBuffer, internals.indexBufferMemory },
+		};
+		for (const auto& upload : uploads) {
+			// Written straight into the staging ring, which is mapped for good
+			Util::StagingAllocation staging;
+			if (auto errorMessage = Util::allocateStaging(device, physicalDevice, upload.size, staging); !errorMessage.empty()) {
+				currentError = std::string(upload.name) + " staging buffer: " + errorMessage;
 				return false;
 			}
-
-			void* data;
-			vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-			memcpy(data, internals.indices.data(), (size_t)bufferSize);
-			vkUnmapMemory(device, stagingBufferMemory);
+			upload.write(staging.mapped);
 
 			// Reason for having this extra buffer, is so that we can load our vertex in more performant memory
-			if (auto errorMessage = createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, internals.indexBuffer, internals.indexBufferMemory);
+			if (auto errorMessage = Util::createBuffer(device, physicalDevice, upload.size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | upload.usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, upload.buffer, upload.memory);
 				!errorMessage.empty()) {
-				currentError = "vertices buffer 2: " + errorMessage;
+				currentError = std::string(upload.name) + " buffer: " + errorMessage;
+				Util::freeStaging(device, staging);
 				return false;
 			}
-			Util::copyBuffer(stagingBuffer, internals.indexBuffer, bufferSize, device, commandPool, graphicsQueue);
-			vkDestroyBuffer(device, stagingBuffer, nullptr);
-			vkFreeMemory(device, stagingBufferMemory, nullptr);
+			GraphicsUploadBatch::LevelCompletion onCopied;
+			if (pendingCopies) {
+				(*pendingCopies)++;
+				onCopied = [pending = pendingCopies]() { (*pending)--; };
+			}
+			if (!batch->addBuffer(staging, upload.buffer, upload.size, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, upload.readAccess, std::move(onCopied))) {
+				currentError = std::string(batch->getError());
+				if (pendingCopies) (*pendingCopies)--;
+				return false;
+			}
+		}
+
+		if (batch == &ownBatch && !ownBatch.submit()) {
+			currentError = std::string(ownBatch.getError());
+			return false;
 		}
 		return true;
 	}
 
 
 
+	void StagedTexture::Free(VkDevice device) { Util::freeStaging(device, staging); }
+
+	ErrorMessage stageTextureFile(const std::string& filePath, VkDevice device, VkPhysicalDevice physicalDevice, StagedTexture& staged, uint32_t maxLevelSize, TextureUsage usage)
+	{
+		staged.textureFile = filePath;
+
+		std::string containerPath = std::filesystem::path(filePath).extension() == Util::TextureContainer::Extension ? filePath : findBakedContainer(filePath);
+		// Containers are baked as sRGB color, data sampled through them would come out gamma shifted
+		if (usage == TextureUsage::Data && containerPath != filePath) containerPath.clear();
+		if (!containerPath.empty()) {
+			auto errorMessage = stageContainer(containerPath, maxLevelSize, device, physicalDevice, staged);
+			if (errorMessage.empty()) return "";
+			if (containerPath == filePath) { staged.error = filePath + ": " + errorMessage; return staged.error; }
+			std::cout << "WARNING ignoring " << containerPath << ": " << errorMessage << std::endl;
+		}
+
+		if (auto errorMessage = stageImage(filePath, usage, device, physicalDevice, staged); !errorMessage.empty()) {
+			staged.error = errorMessage;
+			return staged.error;
+		}
+		return "";
+	}
+
+	ErrorMessage stageTextureLevel(const std::string& filePath, uint32_t level, VkDevice device, VkPhysicalDevice physicalDevice, StagedTexture& staged)
+	{
+		staged.textureFile = filePath;
+
+		const std::string containerPath = std::filesystem::path(filePath).extension() == Util::TextureContainer::Extension ? filePath : findBakedContainer(filePath);
+		Util::TextureContainer container;
+		if (containerPath.empty()) staged.error = filePath + ": no baked container to stream levels from";
+		else if (!container.open(containerPath)) staged.error = containerPath + ": " + std::string(container.getError());
+		else if (level >= container.levelCount()) staged.error = containerPath + ": has no mip level " + std::to_string(level);
+		else if (auto errorMessage = stageContainerLevels(container, containerPath, level, level + 1, device, physicalDevice, staged); !errorMessage.empty()) staged.error = containerPath + ": " + errorMessage;
+		return staged.error;
+	}
+
 	GraphicsTextureHandle::GraphicsTextureHandle() :internals(), currentError(), device(nullptr){}
 	GraphicsTextureHandle::~GraphicsTextureHandle() {}
 	void GraphicsTextureHandle::Free() {
 		if (device == nullptr)return;
 
 		TextureInternal& textureInfo = internals.texture;
+		if (!textureInfo.ownsImage) {
+			// Atlas pages are freed by their atlas
+			textureInfo.textureSampler = nullptr;
+			textureInfo.textureImageView = nullptr;
+			textureInfo.textureImage = nullptr;
+			textureInfo.textureImageMemory = nullptr;
+			textureInfo.frameViews.clear();
+		}
 		if (textureInfo.textureSampler != nullptr)vkDestroySampler(device, textureInfo.textureSampler, nullptr);
+		// Views of older resident ranges some frame still had bound
+		std::sort(textureInfo.frameViews.begin(), textureInfo.frameViews.end());
+		textureInfo.frameViews.erase(std::unique(textureInfo.frameViews.begin(), textureInfo.frameViews.end()), textureInfo.frameViews.end());
+		for (auto view : textureInfo.frameViews) if (view != nullptr && view != textureInfo.textureImageView) vkDestroyImageView(device, view, nullptr);
+		textureInfo.frameViews.clear();
 		if (textureInfo.textureImageView != nullptr)vkDestroyImageView(device, textureInfo.textureImageView, nullptr);
 		if (textureInfo.textureImage != nullptr)vkDestroyImage(device, textureInfo.textureImage, nullptr);
 		if (textureInfo.textureImageMemory != nullptr)vkFreeMemory(device, textureInfo.textureImageMemory, nullptr);
@@ -454,22 +692,18 @@ namespace GE
 	}
 	std::string_view GraphicsTextureHandle::getError() const { return currentError; }
 	const UniformTextureInternals& GraphicsTextureHandle::Internals()const { return internals; }
-	bool GraphicsTextureHandle::init(std::string_view filePath, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout)
+	bool GraphicsTextureHandle::init(std::string_view filePath, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout, TextureUsage usage)
 	{
-		TextureInternal& textureInfo = internals.texture;
+		internals.texture.textureFile = std::string(filePath);
+		if (device == nullptr) {
+			currentError = "Must insert a valid device";
+			return false;
+		}
 
-		
-		TextureMetaData fileData;
-		fileData.pixelSize = STBI_rgb_alpha;
-		// Will be using command buffer to store our image object. The images can be found in shader/texures
-		int texChannels;
-		// Force the load to create alpha, so it consistant with all other texures
-		fileData.imageData = stbi_load(filePath.data(), &fileData.pictureWidth, &fileData.pictureHeight, &texChannels, fileData.pixelSize);
-		textureInfo.textureFile = std::string(filePath);
-		if (!fileData.imageData) { currentError = "failed to load texture image!"; return false; }
-		bool state = init(fileData,device,physicalDevice,graphicsQueue,commandPool,descriptorSetLayout);
-		stbi_image_free(fileData.imageData);
-		return state;
+		// Prefers a baked .gtex container (compressed, mips included) and falls back to decoding the image
+		StagedTexture staged;
+		stageTextureFile(std::string(filePath), device, physicalDevice, staged, 0, usage);
+		return init(staged, device, physicalDevice, graphicsQueue, commandPool, descriptorSetLayout);
 	}
 
 
@@ -494,45 +728,133 @@ namespace GE
 			return false;
 		}
 		this->device = device;
-		TextureInternal& textureInfo = internals.texture;
-		// Copying image data to our vk buffer
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
 
-		textureInfo.mipLevels = textureData.mipLevel;
-		if (textureInfo.mipLevels == 0) { textureInfo.mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max<int>(textureData.pictureWidth, textureData.pictureHeight)))) + 1; }
-		
-		VkDeviceSize imageSize = textureData.pictureWidth * textureData.pictureHeight * textureData.pixelSize;
+		// Copying image data to our vk buffer
+		StagedTexture staged;
+		staged.pictureWidth = textureData.pictureWidth;
+		staged.pictureHeight = textureData.pictureHeight;
+		staged.mipLevel = textureData.mipLevel;
+		staged.format = textureFormatFor(physicalDevice, textureData.pixelSize, textureData.usage);
+		staged.pixelSize = formatChannels(staged.format);
+		// Rgb, or channels the device has no small format for, are widened to rgba first
+		const size_t pixelCount = static_cast<size_t>(textureData.pictureWidth) * textureData.pictureHeight;
+		std::vector<unsigned char> expanded;
+		const unsigned char* pixels = textureData.imageData;
+		if (staged.pixelSize != textureData.pixelSize) {
+			expanded = expandToRgba(textureData.imageData, pixelCount, textureData.pixelSize);
+			pixels = expanded.data();
+		}
+		VkDeviceSize imageSize = pixelCount * staged.pixelSize;
 
-		createBuffer(device, physicalDevice, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
-		void* data;
-		vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data); // Going to allocate memory to persistant memory
-		memcpy(data, textureData.imageData, static_cast<size_t>(imageSize));
-		vkUnmapMemory(device, stagingBufferMemory);
+		if (auto errorMessage = Util::allocateStaging(device, physicalDevice, imageSize, staged.staging); !errorMessage.empty()) {
+			currentError = "staging buffer: " + errorMessage;
+			return false;
+		}
+		memcpy(staged.staging.mapped, pixels, static_cast<size_t>(imageSize));
 
+		return initFromStaging(staged, physicalDevice, graphicsQueue, commandPool, descriptorSetLayout);
+	}
 
-		std::string errorMessage;
-		errorMessage = Util::createImage(device, physicalDevice, textureData.pictureWidth, textureData.pictureHeight, textureInfo.mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
-			VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureInfo.textureImage, textureInfo.textureImageMemory);
-		if (!errorMessage.empty()) { currentError = "createImage:" + errorMessage; return false; }
+	bool GraphicsTextureHandle::init(StagedTexture& staged, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout)
+	{
+		if (device == nullptr) {
+			currentError = "Must insert a valid device";
+			return false;
+		}
+		if (!staged.error.empty()) {
+			currentError = staged.error;
+			staged.Free(device);
+			return false;
+		}
+		if (commandPool == nullptr) {
+			currentError = "Must insert a valid command pool";
+			staged.Free(device);
+			return false;
+		}
+		if (physicalDevice == nullptr)
+		{
+			currentError = "Must insert a valid physical device";
+			staged.Free(device);
+			return false;
+		}
+		if (descriptorSetLayout == nullptr)
+		{
+			currentError = "Must insert a valid descriptorSetLayout";
+			staged.Free(device);
+			return false;
+		}
+		this->device = device;
+		return initFromStaging(staged, physicalDevice, graphicsQueue, commandPool, descriptorSetLayout);
+	}
 
-		// VK_IMAGE_LAYOUT_UNDEFINED used before that how we initilized the image. Don't care about contents tell we perform copy operation
-		errorMessage = transitionImageLayout(device, commandPool, graphicsQueue, textureInfo.textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, textureInfo.mipLevels);
-		if (!errorMessage.empty()) { currentError = "transitionImageLayout:" + errorMessage; return false; }
+	bool GraphicsTextureHandle::isReady() const { return !internals.descriptorSets.empty(); }
 
-		errorMessage = copyBufferToImage(device, commandPool, graphicsQueue, stagingBuffer, textureInfo.textureImage, static_cast<uint32_t>(textureData.pictureWidth), static_cast<uint32_t>(textureData.pictureHeight));// Moving the data down the pipeline
-		if (!errorMessage.empty()) { currentError = "copyBufferToImage:" + errorMessage; return false; }
+	bool GraphicsTextureHandle::initFromStaging(StagedTexture& staged, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout)
+	{
+		// A batch of one that is waited for. Nothing in the renderer comes through here anymore, its textures join the
+		// shared batch through addTexture and never block the frame
+		GraphicsUploadBatch batch;
+		if (!batch.init(device, physicalDevice, graphicsQueue, commandPool)) { currentError = std::string(batch.getError()); staged.Free(device); return false; }
+		if (!batch.addTexture(staged, descriptorSetLayout, [this](GraphicsTextureHandle& uploaded) { *this = uploaded; })) { currentError = std::string(batch.getError()); return false; }
+		if (!batch.submit()) { currentError = std::string(batch.getError()); return false; }
+		return isReady();
+	}
 
-		errorMessage = generateMipmaps(device, physicalDevice, commandPool, graphicsQueue, textureInfo.textureImage, VK_FORMAT_R8G8B8A8_SRGB, textureData.pictureWidth, textureData.pictureHeight, textureInfo.mipLevels);
-		if (!errorMessage.empty()) { currentError = "generateMipmaps:" + errorMessage; return false; }
+	bool GraphicsTextureHandle::beginUpload(StagedTexture& staged, VkDevice device, VkPhysicalDevice physicalDevice)
+	{
+		this->device = device;
+		TextureInternal& textureInfo = internals.texture;
+		if (!staged.textureFile.empty()) textureInfo.textureFile = staged.textureFile;
+		textureInfo.textureFormat = staged.format;
+
+		VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		textureInfo.residentLevel = 0;
+		if (!staged.levels.empty()) {
+			// Mip chain was baked offline, nothing to blit. The image is made for the whole chain even when only its tail
+			// is staged, the finer levels are streamed in later
+			textureInfo.mipLevels = staged.firstLevel + static_cast<uint32_t>(staged.levels.size());
+			textureInfo.residentLevel = staged.firstLevel;
+		}
+		else {
+			textureInfo.mipLevels = staged.mipLevel;
+			if (textureInfo.mipLevels == 0) { textureInfo.mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max<int>(staged.pictureWidth, staged.pictureHeight)))) + 1; }
 
-		vkDestroyBuffer(device, stagingBuffer, nullptr);
-		vkFreeMemory(device, stagingBufferMemory, nullptr);
+			if (textureInfo.mipLevels > 1 && !formatCanBeMipmapped(physicalDevice, staged.format)) {
+				std::cout << "WARNING " << textureInfo.textureFile << ": no linear blit support, bake a .gtex to get mipmaps" << std::endl;
+				textureInfo.mipLevels = 1;
+			}
+			if (textureInfo.mipLevels > 1) usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT; // the levels are blitted from each other
+		}
 
+		auto errorMessage = Util::createImage(device, physicalDevice, staged.pictureWidth, staged.pictureHeight, textureInfo.mipLevels, VK_SAMPLE_COUNT_1_BIT, staged.format, VK_IMAGE_TILING_OPTIMAL,
+			usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureInfo.textureImage, textureInfo.textureImageMemory);
+		if (!errorMessage.empty()) { currentError = "createImage:" + errorMessage; staged.Free(device); return false; }
+
+		// What the image takes next to what it took before the format followed the channels, everything went to rgba8
+		VkMemoryRequirements memoryRequirements;
+		vkGetImageMemoryRequirements(device, textureInfo.textureImage, &memoryRequirements);
+		textureInfo.memorySize = memoryRequirements.size;
+		VkDeviceSize rgbaSize = 0;
+		for (uint32_t level = 0; level < textureInfo.mipLevels; level++) {
+			rgbaSize += static_cast<VkDeviceSize>(std::max(1, staged.pictureWidth >> level)) * std::max(1, staged.pictureHeight >> level) * 4;
+		}
+		if constexpr (PRINT_ENGINE_STATS) std::cout << "Texture " << textureInfo.textureFile << ": " << staged.pictureWidth << "x" << staged.pictureHeight << " " << formatName(staged.format) << ", "
+			<< textureInfo.mipLevels << " levels, " << textureInfo.memorySize / 1024 << " KB on the GPU (" << rgbaSize / 1024 << " KB as RGBA8)" << std::endl;
+		return true;
+	}
 
-		textureInfo.textureImageView = Util::CreateImageView(device, textureInfo.textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, textureInfo.mipLevels);
+	bool GraphicsTextureHandle::finishUpload(VkPhysicalDevice physicalDevice, VkDescriptorSetLayout descriptorSetLayout)
+	{
+		TextureInternal& textureInfo = internals.texture;
+		textureInfo.textureImageView = createResidentView();
+		if (!createSampler(physicalDevice, textureInfo.textureSampler)) return false;
 
+		return initUniforms(physicalDevice, descriptorSetLayout, true);
+	}
 
+	bool GraphicsTextureHandle::createSampler(VkPhysicalDevice physicalDevice, VkSampler& sampler)
+	{
+		const TextureInternal& textureInfo = internals.texture;
 		VkSamplerCreateInfo samplerInfo{};
 		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
 		// specify how to interpolate texels that are magnified or minified
@@ -568,15 +890,112 @@ namespace GE
 		// Another filter that can be applied. 
 		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 		samplerInfo.mipLodBias = 0.0f;
+		// Levels finer than the resident one are left out of the view, its first level is lod 0
 		samplerInfo.minLod = 0.0f;
 		samplerInfo.maxLod = static_cast<float>(textureInfo.mipLevels);
 
-		if (vkCreateSampler(device, &samplerInfo, nullptr, &textureInfo.textureSampler) != VK_SUCCESS) { currentError = "failed to create texture sampler!"; return false; }
+		if (vkCreateSampler(device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS) { currentError = "failed to create texture sampler!"; return false; }
+		return true;
+	}
+
+	VkImageView GraphicsTextureHandle::createResidentView() const
+	{
+		const TextureInternal& textureInfo = internals.texture;
+		return Util::CreateImageView(device, textureInfo.textureImage, textureInfo.textureFormat, VK_IMAGE_ASPECT_COLOR_BIT, textureInfo.mipLevels - textureInfo.residentLevel,
+			textureSwizzle(textureInfo.textureFormat), textureInfo.residentLevel);
+	}
+
+	bool GraphicsTextureHandle::setResidentLevel(uint32_t level, VkPhysicalDevice physicalDevice)
+	{
+		TextureInternal& textureInfo = internals.texture;
+		if (device == nullptr || textureInfo.textureImageView == nullptr) { currentError = "texture is not uploaded"; return false; }
+		if (level >= textureInfo.residentLevel) return true;
 
+		textureInfo.residentLevel = level;
+		VkImageView view = createResidentView();
 
+		// A view no frame got to bind yet can go right away
+		if (std::find(textureInfo.frameViews.begin(), textureInfo.frameViews.end(), textureInfo.textureImageView) == textureInfo.frameViews.end()) {
+			vkDestroyImageView(device, textureInfo.textureImageView, nullptr);
+		}
+		textureInfo.textureImageView = view;
+		return true;
+	}
 
+	void GraphicsTextureHandle::bindResidentLevels(size_t frame)
+	{
+		TextureInternal& textureInfo = internals.texture;
+		if (frame >= textureInfo.frameViews.size() || frame >= internals.descriptorSets.size()) return;
+		const VkImageView previous = textureInfo.frameViews[frame];
+		if (previous == textureInfo.textureImageView) return;
+
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = textureInfo.textureImageView;
+		imageInfo.sampler = textureInfo.textureSampler;
+		VkWriteDescriptorSet descriptorWrite{};
+		descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrite.dstSet = internals.descriptorSets[frame];
+		descriptorWrite.dstBinding = 1;
+		descriptorWrite.dstArrayElement = 0;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.pImageInfo = &imageInfo;
+		vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+		textureInfo.frameViews[frame] = textureInfo.textureImageView;
+
+		// The fence of this frame signalled, so once no other frame holds the old view nothing in flight uses it
+		if (std::find(textureInfo.frameViews.begin(), textureInfo.frameViews.end(), previous) == textureInfo.frameViews.end()) {
+			vkDestroyImageView(device, previous, nullptr);
+		}
+	}
+
+	bool GraphicsTextureHandle::initUntextured(VkDevice device, VkPhysicalDevice physicalDevice, VkDescriptorSetLayout descriptorSetLayout)
+	{
+		if (device == nullptr) {
+			currentError = "Must insert a valid device";
+			return false;
+		}
+		if (physicalDevice == nullptr)
+		{
+			currentError = "Must insert a valid physical device";
+			return false;
+		}
+		if (descriptorSetLayout == nullptr)
+		{
+			currentError = "Must insert a valid descriptorSetLayout";
+			return false;
+		}
+		this->device = device;
+		return initUniforms(physicalDevice, descriptorSetLayout, false);
+	}
+
+	bool GraphicsTextureHandle::initAtlased(const TextureInternal& page, const glm::vec4& uvScaleOffset, const std::string& textureFile, VkDevice device, VkPhysicalDevice physicalDevice, VkDescriptorSetLayout descriptorSetLayout)
+	{
+		if (device == nullptr) {
+			currentError = "Must insert a valid device";
+			return false;
+		}
+		if (descriptorSetLayout == nullptr)
+		{
+			currentError = "Must insert a valid descriptorSetLayout";
+			return false;
+		}
+		this->device = device;
+		TextureInternal& textureInfo = internals.texture;
+		textureInfo = page;
+		textureInfo.ownsImage = false;
+		textureInfo.memorySize = 0;
+		textureInfo.uvScaleOffset = uvScaleOffset;
+		textureInfo.textureFile = textureFile;
+		return initUniforms(physicalDevice, descriptorSetLayout, true);
+	}
+
+	bool GraphicsTextureHandle::initUniforms(VkPhysicalDevice physicalDevice, VkDescriptorSetLayout descriptorSetLayout, bool withSampler)
+	{
+		TextureInternal& textureInfo = internals.texture;
 		UBOInternal& uniformBuffer = internals.ubo;
-		VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+		VkDeviceSize bufferSize = sizeof(MaterialUniforms);
 
 		uniformBuffer.uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
 		uniformBuffer.uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
@@ -584,7 +1003,7 @@ namespace GE
 
 		// Technique "Persistent Mapping" which maps the buffer to specific pointer during the application lifetime
 		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			auto errorMessage = createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuffer.uniformBuffers[i], uniformBuffer.uniformBuffersMemory[i]);
+			auto errorMessage = Util::createBuffer(device, physicalDevice, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuffer.uniformBuffers[i], uniformBuffer.uniformBuffersMemory[i]);
 			if (!errorMessage.empty())
 			{
 				currentError = "UniformBuffer: " + errorMessage;
@@ -603,7 +1022,7 @@ namespace GE
 
 		VkDescriptorPoolCreateInfo poolInfo{};
 		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.poolSizeCount = withSampler ? static_cast<uint32_t>(poolSizes.size()) : 1;
 		poolInfo.pPoolSizes = poolSizes.data();
 		poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);// No reason to allow create more than whats needed
 		//VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT is an option to create the descriptors every frame
@@ -620,12 +1039,13 @@ namespace GE
 		allocInfo.pSetLayouts = layouts.data();
 		internals.descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
 		if (vkAllocateDescriptorSets(device, &allocInfo, internals.descriptorSets.data()) != VK_SUCCESS) { currentError = "failed to allocate descriptor sets!"; return false; }
+		if (withSampler) textureInfo.frameViews.assign(MAX_FRAMES_IN_FLIGHT, textureInfo.textureImageView);
 		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
 			// Defining out uniform buffer object with the descriptor
 			VkDescriptorBufferInfo bufferInfo{};
 			bufferInfo.buffer = uniformBuffer.uniformBuffers[i];
 			bufferInfo.offset = 0;
-			bufferInfo.range = sizeof(UniformBufferObject);
+			bufferInfo.range = sizeof(MaterialUniforms);
 			VkDescriptorImageInfo imageInfo{};
 			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 			imageInfo.imageView = textureInfo.textureImageView;
@@ -645,7 +1065,8 @@ namespace GE
 			descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
 			descriptorWrites[1].descriptorCount = 1;
 			descriptorWrites[1].pImageInfo = &imageInfo;// Optional Image data
-			vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+			const uint32_t writeCount = withSampler ? static_cast<uint32_t>(descriptorWrites.size()) : 1;
+			vkUpdateDescriptorSets(device, writeCount, descriptorWrites.data(), 0, nullptr);
 		}
 
 		return true;
@@ -713,7 +1134,7 @@ namespace GE
 	void GraphicsVerticesStorage::createVertice(const Id& id, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
 	{
 		VerticesHandle handle;
-		bool state = handle.init(vertices, indices, device, physicalDevice, graphicsQueue, commandPool, descriptorSetLayout);
+		bool state = handle.init(std::span<const Vertex>(vertices), std::span<const uint32_t>(indices), device, physicalDevice, graphicsQueue, commandPool, descriptorSetLayout);
 		if (!state) {
 			std::cout << "ERROR with creating texture: " << handle.getError() << std::endl;
 			return;
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "GraphicEngine/ConstDefines.hpp"
+#include "GraphicEngine/Utility/Hashing.hpp"
+#include "GraphicEngine/Utility/StagingRing.hpp"
 
 #include <map>
 #include <memory>
 #include <array>
+#include <functional>
+#include <span>
 #include <vector>
 #include <type_traits>
 
@@ -16,23 +20,44 @@
 
 namespace GE
 {
+	/// @brief How a mesh sits in its vertex buffer. Chosen per pipeline, meshes are packed to match when they are uploaded
+	enum class VertexLayout : uint32_t
+	{
+		Float = 0, // Vertex as is, 32 bytes
+		Compact = 1, // CompactVertex with half float uvs, 16 bytes. Works for uvs outside [0,1] (tiling)
+		CompactUnormUV = 2, // CompactVertex with unorm16 uvs. More precise, but uvs are clamped to [0,1]
+	};
+
 	struct Vertex {
 		glm::vec3 pos;
 		glm::vec3 color;
 		glm::vec2 texCoord;
 
-		static VkVertexInputBindingDescription getBindingDescription();
+		static VkVertexInputBindingDescription getBindingDescription(VertexLayout layout = VertexLayout::Float);
 
-		static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions();
+		static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions(VertexLayout layout = VertexLayout::Float);
 
 
 		bool operator==(const Vertex& other) const;
 	};
 
+	/// @brief Quantized vertex. Positions are unorm16 inside the bounds of their mesh, the per mesh scale and offset is
+	/// folded into the model matrix. The shaders read the same inputs as for Vertex, the vertex fetch does the unpacking
+	struct CompactVertex
+	{
+		uint16_t pos[4]; // w is padding so the uv stays 4 byte aligned
+		uint16_t texCoord[2]; // half float or unorm16, see VertexLayout
+		uint8_t color[4]; // rgba8 unorm, alpha unused
+	};
+	static_assert(sizeof(CompactVertex) == 16);
+
+	size_t vertexStride(VertexLayout layout);
+
 
 	// Alignment is important. Things need to be multiple of 16
 	// Can for alignments with #define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES 
 	// Avoid GLM_FORCE_DEFAULT_ALIGNED_GENTYPES and be explicit with the alignas
+	/// @brief Transform of one object as the app sets it. The draw loop folds it into ObjectPushConstants
 	struct UniformBufferObject
 	{
 		alignas(16) glm::mat4 model;
@@ -40,15 +65,110 @@ namespace GE
 		alignas(16) glm::mat4 proj;
 	};
 
+	/// @brief Per object data, pushed with every draw instead of living in a descriptor set.
+	/// Has to stay within the 128 bytes every device offers
+	struct ObjectPushConstants
+	{
+		alignas(16) glm::mat4 modelViewProj;
+	};
+	static_assert(sizeof(ObjectPushConstants) <= 128);
+
+	/// @brief Uniform buffer of a material, binding 0 of its descriptor sets
+	struct MaterialUniforms
+	{
+		alignas(16) glm::vec4 uvScaleOffset{ 1.0f, 1.0f, 0.0f, 0.0f }; // xy scale, zw offset. Where an atlased texture sits in its page
+		alignas(16) glm::vec4 tint{ 1.0f }; // multiplies the sampled or vertex color
+	};
+
+
+
+	/// @brief Axis aligned box around the positions of a mesh, in model space
+	struct MeshBounds
+	{
+		glm::vec3 minimum;
+		glm::vec3 maximum;
+	};
+
+	/// @brief One level of detail, a range of the index buffer drawn against the same vertices
+	struct MeshLod
+	{
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		float error; // how far the level strays from the full mesh, in model units
+	};
+
+	/// @brief A few dozen neighboring triangles of one level, a range of the index buffer that is culled as a whole
+	struct MeshCluster
+	{
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		// Bounding sphere in model space
+		glm::vec3 center;
+		float radius;
+		// Every triangle normal lies within the cone around coneAxis. The cluster faces away from any camera that sees
+		// the sphere at an angle to the axis whose cosine is at least coneCutoff. 1 when the normals spread too far
+		glm::vec3 coneAxis;
+		float coneCutoff;
+	};
+
+	/// @brief Part of the index buffer
+	struct IndexRange
+	{
+		uint32_t firstIndex;
+		uint32_t indexCount;
+	};
+
+	/// @brief What of a mesh stays in host memory once its buffers are on the GPU
+	enum class MeshResidency : uint32_t
+	{
+		Keep = 0, // vertices and indices as well, for reading the geometry back on the CPU
+		BoundsOnly = 1, // bounds, levels and clusters. All the draw loop reads
+		Discard = 2, // bounds and levels only, every level is drawn whole without culling its clusters
+	};
 
+	/// @brief Adds its bytes to the process wide count of host memory held by meshes for as long as it lives.
+	/// A copy counts again, just like the vectors it sits next to
+	class HostMeshBytes
+	{
+	public:
+		HostMeshBytes() = default;
+		HostMeshBytes(const HostMeshBytes& other);
+		HostMeshBytes& operator=(const HostMeshBytes& other);
+		~HostMeshBytes();
+
+		void set(size_t bytes);
+		size_t get() const;
+		/// @brief Summed over every mesh alive
+		static size_t total();
+
+	private:
+		size_t bytes{ 0 };
+	};
 
 	struct VerticesInternal {
+		// Only filled for MeshResidency::Keep, the buffers below are what gets drawn
 		std::vector<Vertex> vertices;
 		std::vector<uint32_t> indices;
+		MeshResidency residency{ MeshResidency::Keep };
 		VkBuffer vertexBuffer;
 		VkDeviceMemory vertexBufferMemory; // allocated memory for gpu
 		VkBuffer indexBuffer;
 		VkDeviceMemory indexBufferMemory;
+
+		VertexLayout vertexLayout{ VertexLayout::Float };
+		VkIndexType indexType{ VK_INDEX_TYPE_UINT32 }; // 16 bit whenever the mesh has less than 65536 vertices
+		uint32_t indexCount{ 0 };
+		/// @brief Turns quantized positions back into model space. Multiply the model matrix with it, identity for VertexLayout::Float
+		glm::mat4 dequantize{ 1.0f };
+
+		/// @brief Finest level first. Empty means the whole index buffer is the only level
+		std::vector<MeshLod> lods;
+		/// @brief Clusters of every level sorted by firstIndex, so those of a level are found by its range. Empty for
+		/// meshes that were not imported from a file, those are drawn whole
+		std::vector<MeshCluster> clusters;
+		// Bounding sphere in model space, for picking a level by size on screen
+		glm::vec3 boundsCenter{ 0.0f };
+		float boundsRadius{ 0.0f };
 	};
 
 	class VerticesHandle {
@@ -59,14 +179,43 @@ namespace GE
 		std::string_view getError() const;
 		const VerticesInternal& Internals()const;
 
-		bool init(std::string_view filePath, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout);
-		bool init(std::vector<Vertex>, std::vector<uint32_t>, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout);
-
+		/// @brief vertexLayout has to match the pipeline the mesh is drawn with. residency picks what stays on the host after the upload
+		bool init(std::string_view filePath, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout, VertexLayout vertexLayout = VertexLayout::Float, MeshResidency residency = MeshResidency::BoundsOnly);
+		/// @brief Takes the vectors over when residency keeps the geometry, no copy either way
+		bool init(std::vector<Vertex>, std::vector<uint32_t>, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout, VertexLayout vertexLayout = VertexLayout::Float, MeshResidency residency = MeshResidency::BoundsOnly);
+		/// @brief Packs the geometry straight from the spans into mapped staging memory, nothing is copied on the host unless residency keeps it.
+		/// For procedural geometry that lives on the stack or in a reused buffer
+		bool init(std::span<const Vertex> vertices, std::span<const uint32_t> indices, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout, VertexLayout vertexLayout = VertexLayout::Float, MeshResidency residency = MeshResidency::BoundsOnly);
+
+		/// @brief False while the buffer copies queued into the shared upload batch have not finished, the mesh is not drawn until then
+		bool isReady() const;
+		/// @brief True when the last file init was served by the binary mesh cache instead of parsing the file
+		bool loadedFromCache() const;
+		/// @brief Bytes of host memory this mesh still holds
+		size_t hostBytes() const;
+		/// @brief Bytes of host memory held by every mesh alive
+		static size_t totalHostBytes();
 
 	private:
+		/// @brief Drops what residency does not keep and counts what is left
+		void applyResidency(MeshResidency residency);
+		/// @brief Fills bytes of mapped staging memory
+		using StagingWriter = std::function<void(void* mapped)>;
+
+		/// @brief Packs the vertices and indices the way vertexLayout and the vertex count ask for, straight into the staging buffers, then uploads them.
+		/// Known bounds save the pass over the positions. Without narrowIndices the indices are copied as they are
+		bool uploadMesh(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, VertexLayout vertexLayout, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool,
+			const MeshBounds* bounds = nullptr, bool narrowIndices = true);
+		/// @brief Queues both copies into the shared upload batch when the renderer set one, else submits them and waits
+		bool uploadBuffers(VkDeviceSize vertexBytes, const StagingWriter& writeVertices, VkDeviceSize indexBytes, const StagingWriter& writeIndices, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool);
+
 		VerticesInternal internals;
+		/// @brief Copies still queued in the shared upload batch. Shared with their completions, which can outlive the handle
+		std::shared_ptr<uint32_t> pendingCopies;
+		HostMeshBytes hostMeshBytes;
 		std::string currentError;
 		VkDevice device{nullptr};
+		bool cacheHit{ false };
 	};
 
 
@@ -98,14 +247,31 @@ namespace GE
 	};
 
 
+	/// @brief What the values of a texture mean. Picks between sRGB and linear formats
+	enum class TextureUsage : uint32_t
+	{
+		Color = 0, // authored in sRGB, linearized when sampled
+		Data = 1, // masks, heightmaps, roughness. Sampled as stored
+	};
+
 	struct TextureInternal {
 		uint32_t mipLevels;
+		VkFormat textureFormat{ VK_FORMAT_R8G8B8A8_SRGB };
 		VkImage textureImage;
 		VkDeviceMemory textureImageMemory;
 		VkImageView textureImageView;
 		VkSampler textureSampler; // Distinct from the image. Can be used to extra pixels from any image
 		VkDescriptorImageInfo descriptor;
+		/// @brief Finest mip level holding data, the first level of textureImageView. Above 0 while the finer levels are still
+		/// streaming in, those stay out of every view so the upload can write them while frames sample the rest
+		uint32_t residentLevel{ 0 };
+		/// @brief The view each frame's descriptor set was last written with. Views of older resident ranges live until no frame uses them
+		std::vector<VkImageView> frameViews;
 		std::string textureFile;
+		VkDeviceSize memorySize{ 0 }; // what the image takes on the GPU
+		/// @brief False for textures packed into an atlas page. The image, view and sampler belong to the atlas then
+		bool ownsImage{ true };
+		glm::vec4 uvScaleOffset{ 1.0f, 1.0f, 0.0f, 0.0f }; // see MaterialUniforms
 	};
 	struct UBOInternal {
 		// We might have multiple frames in flight at a single time, hence we must use dynamic memory
@@ -125,12 +291,53 @@ namespace GE
 	struct TextureMetaData
 	{
 		unsigned char *imageData{nullptr};
-		uint16_t pixelSize{ 4 };
+		uint16_t pixelSize{ 4 }; // channels, 1 gray, 2 gray and alpha, 3 rgb, 4 rgba
 		int pictureWidth{ 0 };
 		int pictureHeight{ 0 };
 		uint32_t mipLevel{ 0 };
+		TextureUsage usage{ TextureUsage::Color };
+	};
+
+	struct StagedLevel
+	{
+		VkDeviceSize offset; // inside the staging allocation
+		uint32_t width;
+		uint32_t height;
 	};
 
+	/// @brief Pixels that already sit in a host visible staging buffer, e.g. decoded by the GraphicsTextureLoader workers.
+	/// Whoever consumes it owns the staging buffer and has to Free it
+	struct StagedTexture
+	{
+		std::string textureFile;
+		/// @brief Usually a piece of the staging ring, copies read it at staging.offset
+		Util::StagingAllocation staging;
+		VkFormat format{ VK_FORMAT_R8G8B8A8_SRGB };
+		int pictureWidth{ 0 };
+		int pictureHeight{ 0 };
+		uint16_t pixelSize{ 4 };
+		uint32_t mipLevel{ 0 };
+		/// @brief Baked mip chain from a texture container, one entry per level starting at firstLevel.
+		/// Empty means the buffer holds level 0 only and the other levels are generated on the GPU
+		std::vector<StagedLevel> levels;
+		/// @brief Mip level of levels.front(). Levels above 0 leave the finer ones for streaming
+		uint32_t firstLevel{ 0 };
+		/// @brief Set when decoding failed. No staging buffer exists then
+		std::string error;
+
+		void Free(VkDevice device);
+	};
+
+	/// @brief Reads filePath into a new staging buffer. A .gtex container is used as is, and so is a baked container sitting
+	/// next to an image (same name, .gtex extension) that is not older than the image. Anything else is decoded with stb_image.
+	/// Safe to call from worker threads. Returns an empty string on success, otherwise staged.error is set as well.
+	/// A maxLevelSize above 0 leaves out the baked levels wider or taller than it, staged.firstLevel tells where the staged
+	/// chain starts. Decoded images are always staged whole, in the smallest format that holds their channels.
+	/// Baked containers hold sRGB color, so data textures are always decoded
+	ErrorMessage stageTextureFile(const std::string& filePath, VkDevice device, VkPhysicalDevice physicalDevice, StagedTexture& staged, uint32_t maxLevelSize = 0, TextureUsage usage = TextureUsage::Color);
+	/// @brief Reads a single level of the baked container behind filePath, one that stageTextureFile left out
+	ErrorMessage stageTextureLevel(const std::string& filePath, uint32_t level, VkDevice device, VkPhysicalDevice physicalDevice, StagedTexture& staged);
+
 	class GraphicsTextureHandle
 	{
 	public:
@@ -140,10 +347,37 @@ namespace GE
 		std::string_view getError() const;
 		const UniformTextureInternals& Internals()const;
 
-		bool init(std::string_view filePath, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout);
+		/// @brief The init overloads submit a batch of their own and wait for it, for tools and one-off uploads. The renderer
+		/// stages through GraphicsTextureLoader and queues into its shared GraphicsUploadBatch instead
+		bool init(std::string_view filePath, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout, TextureUsage usage = TextureUsage::Color);
 		bool init(const TextureMetaData&, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout);
+		/// @brief Uploads an already staged texture. The staging buffer is destroyed afterwards, success or not
+		bool init(StagedTexture&, VkDevice device, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout);
+		/// @brief Only the per frame uniform buffers and descriptor sets. For pipelines without a sampler binding
+		bool initUntextured(VkDevice device, VkPhysicalDevice physicalDevice, VkDescriptorSetLayout descriptorSetLayout);
+		/// @brief Samples a region of an atlas page. Gets uniform buffers and descriptor sets of its own, the page stays the atlas'
+		bool initAtlased(const TextureInternal& page, const glm::vec4& uvScaleOffset, const std::string& textureFile, VkDevice device, VkPhysicalDevice physicalDevice, VkDescriptorSetLayout descriptorSetLayout);
+
+		/// @brief False until one of the init calls went through. Objects are not drawn before that
+		bool isReady() const;
+
+		/// @brief Upload in two halves for GraphicsUploadBatch. beginUpload creates the image, the batch records the copies,
+		/// finishUpload creates the view, sampler and descriptor sets once the GPU is done
+		bool beginUpload(StagedTexture& staged, VkDevice device, VkPhysicalDevice physicalDevice);
+		bool finishUpload(VkPhysicalDevice physicalDevice, VkDescriptorSetLayout descriptorSetLayout);
+
+		/// @brief level and everything coarser hold data now. Creates a view starting at level, the descriptor sets
+		/// switch over in bindResidentLevels
+		bool setResidentLevel(uint32_t level, VkPhysicalDevice physicalDevice);
+		/// @brief Writes the newest view into the descriptor set of frame. Only call once the frame's fence signalled
+		void bindResidentLevels(size_t frame);
 
 	private:
+		bool initFromStaging(StagedTexture& staged, VkPhysicalDevice physicalDevice, VkQueue graphicsQueue, VkCommandPool commandPool, VkDescriptorSetLayout descriptorSetLayout);
+		bool initUniforms(VkPhysicalDevice physicalDevice, VkDescriptorSetLayout descriptorSetLayout, bool withSampler);
+		bool createSampler(VkPhysicalDevice physicalDevice, VkSampler& sampler);
+		/// @brief View of the levels [residentLevel, mipLevels), the only ones the shaders may read
+		VkImageView createResidentView() const;
 
 		UniformTextureInternals internals;
 		std::string currentError;
@@ -195,7 +429,8 @@ namespace GE
 namespace std {
 	template<> struct hash<GE::Vertex> {
 		size_t operator()(GE::Vertex const& vertex) const {
-			return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
+			static_assert(sizeof(GE::Vertex) == 32, "Vertex is hashed as a raw 32 byte block");
+			return static_cast<size_t>(GE::Util::hashBlock32(&vertex));
 		}
 	};
 }
\ No newline at end of file
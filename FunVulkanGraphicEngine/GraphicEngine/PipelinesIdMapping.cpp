@@ -12,6 +12,17 @@ namespace GE
 		metaData.shaders.push_back(i1);
 		metaData.shaders.push_back(i2);
 		appendNewPipelineData(metaData);
+
+		// Vertex colored geometry. No image or sampler needed, used for solid color tiles
+		MetaData solidData;
+		solidData.pipelineName = "solid";
+		solidData.textured = false;
+		// Tile colors live in the vertices and would band as 8 bit linear values. Tiles are 4 vertices anyway
+		solidData.vertexLayout = VertexLayout::Float;
+		ShaderLoadInfo i3; i3.fileName = "shaders/fragSolid.spv"; i3.name = "main"; i3.type = ShaderType::Fragment;
+		solidData.shaders.push_back(i1);
+		solidData.shaders.push_back(i3);
+		appendNewPipelineData(solidData);
 	}
 	PipelinesIdMapping::~PipelinesIdMapping() {}
 
@@ -26,6 +26,10 @@ namespace GE{
 			std::string pipelineName;
 			std::vector<ShaderLoadInfo> shaders;
 			std::optional<VkViewport> customSize;
+			/// @brief When false the pipeline has no sampler binding and colors come from the vertices
+			bool textured{ true };
+			/// @brief Compact halves the vertex memory and bandwidth of every mesh drawn with the pipeline
+			VertexLayout vertexLayout{ VertexLayout::Compact };
 		};
 
 
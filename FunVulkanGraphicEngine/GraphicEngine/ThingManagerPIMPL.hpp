@@ -1,12 +1,18 @@
 #pragma once
 
 #include "GraphicEngine/GraphicsObjectController.hpp"
+#include "GraphicEngine/GraphicsTextureAtlas.hpp"
+#include "GraphicEngine/GraphicsTextureLoader.hpp"
+#include "GraphicEngine/GraphicsUploadBatch.hpp"
 #include "GraphicEngine/ConstDefines.hpp"
 
 namespace GE
 {
 	struct ThingManagerPIMPL{
 		GraphicsObjectController * controller;
+		GraphicsTextureLoader * textureLoader;
+		GraphicsUploadBatch * uploadBatch;
+		GraphicsTextureAtlas * textureAtlas;
 		VkDevice device;
 		VkPhysicalDevice physicalDevice;
 		VkQueue queue;
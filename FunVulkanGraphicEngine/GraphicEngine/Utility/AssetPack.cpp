@@ -0,0 +1,195 @@
+#include "GraphicEngine/Utility/AssetPack.hpp"
+#include "GraphicEngine/Utility/Lz4.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+namespace
+{
+	uint64_t alignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+	// Set once by mountAssetPack, only read afterwards
+	std::unique_ptr<GE::Util::AssetPack> mountedPack;
+}
+
+namespace GE::Util
+{
+	AssetPack::AssetPack() = default;
+	AssetPack::~AssetPack() = default;
+
+	bool AssetPack::open(const std::string& packPath)
+	{
+		close();
+		if (!file.open(packPath)) { currentError = std::string(file.getError()); return false; }
+
+		if (file.size() < sizeof(AssetPackHeader)) { currentError = "pack header is truncated"; close(); return false; }
+		const auto* candidate = reinterpret_cast<const AssetPackHeader*>(file.data());
+		if (candidate->magic != Magic || candidate->version != Version) { currentError = packPath + " is not an asset pack of this version"; close(); return false; }
+
+		const uint64_t tocEnd = candidate->tocOffset + static_cast<uint64_t>(candidate->entryCount) * sizeof(AssetPackEntry);
+		if (tocEnd > file.size() || candidate->stringsOffset + candidate->stringsSize > file.size()) { currentError = "pack table of contents is truncated"; close(); return false; }
+		const auto* table = reinterpret_cast<const AssetPackEntry*>(file.data() + candidate->tocOffset);
+		const char* names = file.data() + candidate->stringsOffset;
+
+		for (uint32_t i = 0; i < candidate->entryCount; i++) {
+			const auto& item = table[i];
+			if (static_cast<uint64_t>(item.pathOffset) + item.pathLength > candidate->stringsSize) { currentError = "pack entry " + std::to_string(i) + " has a bad path"; close(); return false; }
+			if (item.dataOffset + item.storedSize > file.size()) { currentError = "pack entry " + std::to_string(i) + " is out of bounds"; close(); return false; }
+			if (item.compression > static_cast<uint32_t>(AssetCompression::LZ4) || (item.compression == static_cast<uint32_t>(AssetCompression::None) && item.storedSize != item.size)) {
+				currentError = "pack entry " + std::to_string(i) + " has a bad compression"; close(); return false;
+			}
+			// find() relies on the order
+			if (i > 0) {
+				const std::string_view previous(names + table[i - 1].pathOffset, table[i - 1].pathLength);
+				if (!(previous < std::string_view(names + item.pathOffset, item.pathLength))) { currentError = "pack table of contents is not sorted"; close(); return false; }
+			}
+		}
+
+		header = candidate;
+		entries = table;
+		strings = names;
+		return true;
+	}
+
+	void AssetPack::close()
+	{
+		header = nullptr;
+		entries = nullptr;
+		strings = nullptr;
+		file.close();
+	}
+
+	const AssetPackEntry* AssetPack::find(std::string_view path) const
+	{
+		if (header == nullptr) return nullptr;
+		const std::string normalized = normalizePath(path);
+		const AssetPackEntry* end = entries + header->entryCount;
+		const AssetPackEntry* found = std::lower_bound(entries, end, std::string_view(normalized), [this](const AssetPackEntry& item, std::string_view key) { return entryPath(item) < key; });
+		return (found != end && entryPath(*found) == normalized) ? found : nullptr;
+	}
+
+	size_t AssetPack::entryCount() const { return header == nullptr ? 0 : header->entryCount; }
+	const AssetPackEntry& AssetPack::entry(size_t index) const { return entries[index]; }
+	std::string_view AssetPack::entryPath(const AssetPackEntry& item) const { return std::string_view(strings + item.pathOffset, item.pathLength); }
+	std::span<const char> AssetPack::storedBytes(const AssetPackEntry& item) const { return std::span<const char>(file.data() + item.dataOffset, static_cast<size_t>(item.storedSize)); }
+	std::string_view AssetPack::getError() const { return currentError; }
+
+	std::string AssetPack::extract(const AssetPackEntry& item, char* destination) const
+	{
+		const auto stored = storedBytes(item);
+		if (item.compression == static_cast<uint32_t>(AssetCompression::None)) {
+			std::copy(stored.begin(), stored.end(), destination);
+			return "";
+		}
+		if (!lz4Decompress(stored.data(), stored.size(), destination, static_cast<size_t>(item.size))) { return "pack entry " + std::string(entryPath(item)) + " is corrupt"; }
+		return "";
+	}
+
+	std::string AssetPack::normalizePath(std::string_view path)
+	{
+		std::string normalized(path);
+		std::replace(normalized.begin(), normalized.end(), '\\', '/');
+		while (normalized.rfind("./", 0) == 0) normalized.erase(0, 2);
+		return normalized;
+	}
+
+	std::string AssetPack::write(const std::string& packPath, std::vector<AssetPackInput> inputs, AssetPackReport* report)
+	{
+		for (auto& input : inputs) input.path = normalizePath(input.path);
+		std::sort(inputs.begin(), inputs.end(), [](const AssetPackInput& a, const AssetPackInput& b) { return a.path < b.path; });
+		for (size_t i = 1; i < inputs.size(); i++) {
+			if (inputs[i].path == inputs[i - 1].path) { return "duplicate pack path " + inputs[i].path; }
+		}
+
+		AssetPackHeader header{};
+		header.magic = Magic;
+		header.version = Version;
+		header.entryCount = static_cast<uint32_t>(inputs.size());
+		header.tocOffset = sizeof(AssetPackHeader);
+		header.stringsOffset = header.tocOffset + inputs.size() * sizeof(AssetPackEntry);
+
+		std::vector<AssetPackEntry> table(inputs.size());
+		std::string names;
+		for (size_t i = 0; i < inputs.size(); i++) {
+			table[i].pathOffset = static_cast<uint32_t>(names.size());
+			table[i].pathLength = static_cast<uint32_t>(inputs[i].path.size());
+			names += inputs[i].path;
+		}
+		header.stringsSize = names.size();
+
+		AssetPackReport totals;
+		// Same swap as the other caches, a failed build never replaces a working pack
+		const std::string temporaryPath = packPath + ".tmp";
+		{
+			std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+			if (!output.is_open()) { return "failed to create " + temporaryPath; }
+
+			// The table of contents is only known once every entry is written, it goes in at the end
+			uint64_t position = header.stringsOffset + header.stringsSize;
+			const std::vector<char> placeholder(static_cast<size_t>(position), 0);
+			output.write(placeholder.data(), static_cast<std::streamsize>(placeholder.size()));
+			const std::vector<char> padding(DataAlignment, 0);
+
+			for (size_t i = 0; i < inputs.size(); i++) {
+				MappedFile source;
+				if (!source.open(inputs[i].sourceFile)) { output.close(); std::filesystem::remove(temporaryPath); return std::string(source.getError()); }
+
+				std::vector<char> compressed = lz4Compress(source.data(), source.size());
+				const bool keepCompressed = compressed.size() * 10 <= source.size() * 9;
+				const char* data = keepCompressed ? compressed.data() : source.data();
+
+				const uint64_t dataOffset = alignUp(position, DataAlignment);
+				output.write(padding.data(), static_cast<std::streamsize>(dataOffset - position));
+				table[i].dataOffset = dataOffset;
+				table[i].size = source.size();
+				table[i].storedSize = keepCompressed ? compressed.size() : source.size();
+				table[i].compression = static_cast<uint32_t>(keepCompressed ? AssetCompression::LZ4 : AssetCompression::None);
+				output.write(data, static_cast<std::streamsize>(table[i].storedSize));
+				position = dataOffset + table[i].storedSize;
+
+				totals.entries++;
+				totals.compressedEntries += keepCompressed;
+				totals.inputBytes += table[i].size;
+				totals.storedBytes += table[i].storedSize;
+			}
+
+			output.seekp(0);
+			output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			output.write(reinterpret_cast<const char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(AssetPackEntry)));
+			output.write(names.data(), static_cast<std::streamsize>(names.size()));
+			if (!output.good()) { output.close(); std::filesystem::remove(temporaryPath); return "failed to write " + temporaryPath; }
+		}
+
+		std::error_code errorCode;
+		std::filesystem::rename(temporaryPath, packPath, errorCode);
+		if (errorCode) {
+			std::filesystem::remove(temporaryPath, errorCode);
+			return "failed to replace " + packPath;
+		}
+		if (report != nullptr) *report = totals;
+		return "";
+	}
+
+	std::string mountAssetPack(const std::string& packPath)
+	{
+		// Open files may point into the mounted pack, so it is never swapped out
+		if (mountedPack != nullptr) { return "an asset pack is already mounted"; }
+		auto pack = std::make_unique<AssetPack>();
+		if (!pack->open(packPath)) { return std::string(pack->getError()); }
+		mountedPack = std::move(pack);
+		return "";
+	}
+
+	const AssetPack* mountedAssetPack() { return mountedPack.get(); }
+
+	bool assetInPack(std::string_view path) { return mountedPack != nullptr && mountedPack->find(path) != nullptr; }
+
+	bool assetExists(std::string_view path)
+	{
+		if (assetInPack(path)) return true;
+		std::error_code errorCode;
+		return std::filesystem::exists(path, errorCode);
+	}
+}
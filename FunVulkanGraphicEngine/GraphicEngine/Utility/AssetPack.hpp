@@ -0,0 +1,106 @@
+#pragma once
+
+#include "GraphicEngine/Utility/FileMapping.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace GE::Util
+{
+	enum class AssetCompression : uint32_t
+	{
+		None = 0,
+		LZ4 = 1,
+	};
+
+	// Layout of an asset pack (.gepk)
+	// [AssetPackHeader][AssetPackEntry x entryCount, sorted by path][path strings][entry data, each aligned to 4 KB]
+	// Stored entries are views into the mapped pack, compressed ones are inflated on open
+	struct AssetPackHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t reserved;
+		uint64_t tocOffset;
+		uint64_t stringsOffset;
+		uint64_t stringsSize;
+	};
+
+	struct AssetPackEntry
+	{
+		uint32_t pathOffset; // into the path strings
+		uint32_t pathLength;
+		uint64_t dataOffset; // from the start of the pack
+		uint64_t storedSize;
+		uint64_t size; // after decompression
+		uint32_t compression; // AssetCompression
+		uint32_t reserved;
+	};
+
+	struct AssetPackInput
+	{
+		std::string path; // how loaders will ask for it, for example "shaders/vert.spv"
+		std::string sourceFile;
+	};
+
+	struct AssetPackReport
+	{
+		size_t entries{ 0 };
+		size_t compressedEntries{ 0 };
+		uint64_t inputBytes{ 0 };
+		uint64_t storedBytes{ 0 };
+	};
+
+	/// @brief Read only view of a .gepk file, mapped once
+	class AssetPack
+	{
+	public:
+		static constexpr uint32_t Magic = 0x4b504547; // "GEPK" in little endian
+		static constexpr uint32_t Version = 1;
+		static constexpr const char* Extension = ".gepk";
+		static constexpr uint64_t DataAlignment = 4096;
+
+		AssetPack();
+		~AssetPack();
+
+		bool open(const std::string& packPath);
+		void close();
+
+		/// @brief Binary search of the table of contents, nullptr when the pack does not hold path
+		const AssetPackEntry* find(std::string_view path) const;
+		size_t entryCount() const;
+		const AssetPackEntry& entry(size_t index) const;
+		std::string_view entryPath(const AssetPackEntry& entry) const;
+		/// @brief The bytes as they sit in the pack, still compressed unless the entry is AssetCompression::None
+		std::span<const char> storedBytes(const AssetPackEntry& entry) const;
+		/// @brief Inflates the entry into destination, which has to hold entry.size bytes. Returns an empty string on success
+		std::string extract(const AssetPackEntry& entry, char* destination) const;
+
+		std::string_view getError() const;
+
+		/// @brief Forward slashes and no leading "./", the form paths are stored and looked up in
+		static std::string normalizePath(std::string_view path);
+
+		/// @brief Packs the inputs, compressing every entry that LZ4 shrinks by at least a tenth. Returns an empty string on success
+		static std::string write(const std::string& packPath, std::vector<AssetPackInput> inputs, AssetPackReport* report = nullptr);
+
+	private:
+		MappedFile file;
+		const AssetPackHeader* header{ nullptr };
+		const AssetPackEntry* entries{ nullptr };
+		const char* strings{ nullptr };
+		std::string currentError;
+	};
+
+	/// @brief Makes every MappedFile look into the pack first, falling back to the disk for paths it does not hold.
+	/// Mount before anything gets loaded, the pack stays mapped until the process ends
+	std::string mountAssetPack(const std::string& packPath);
+	const AssetPack* mountedAssetPack();
+	/// @brief In the mounted pack or on disk
+	bool assetExists(std::string_view path);
+	bool assetInPack(std::string_view path);
+}
@@ -0,0 +1,306 @@
+#include "GraphicEngine/Utility/BlockCompression.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	using Color = std::array<float, 3>;
+
+	float srgbToLinear(float value) { return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f); }
+	float linearToSrgb(float value) { return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f; }
+
+	const std::array<float, 256>& srgbTable()
+	{
+		static const std::array<float, 256> table = [] {
+			std::array<float, 256> values{};
+			for (int i = 0; i < 256; i++) values[i] = srgbToLinear(i / 255.0f);
+			return values;
+		}();
+		return table;
+	}
+
+	uint8_t toByte(float value) { return static_cast<uint8_t>(std::clamp(value * 255.0f + 0.5f, 0.0f, 255.0f)); }
+
+	uint16_t packColor565(const Color& color)
+	{
+		const auto quantize = [](float value, int maximum) { return static_cast<uint16_t>(std::clamp(static_cast<int>(value * maximum / 255.0f + 0.5f), 0, maximum)); };
+		return static_cast<uint16_t>((quantize(color[0], 31) << 11) | (quantize(color[1], 63) << 5) | quantize(color[2], 31));
+	}
+
+	Color unpackColor565(uint16_t packed)
+	{
+		const int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+		return { static_cast<float>((r << 3) | (r >> 2)), static_cast<float>((g << 2) | (g >> 4)), static_cast<float>((b << 3) | (b >> 2)) };
+	}
+
+	// BC1 switches to 3 colors plus transparent black when color0 <= color1. The color block of BC3 always has 4 colors
+	std::array<Color, 4> colorPalette(uint16_t color0, uint16_t color1, bool allowThreeColors)
+	{
+		const Color c0 = unpackColor565(color0), c1 = unpackColor565(color1);
+		std::array<Color, 4> palette{ c0, c1, {}, {} };
+		if (allowThreeColors && color0 <= color1) {
+			for (int channel = 0; channel < 3; channel++) palette[2][channel] = std::floor((c0[channel] + c1[channel]) / 2.0f);
+			return palette;
+		}
+		for (int channel = 0; channel < 3; channel++) {
+			palette[2][channel] = std::floor((2 * c0[channel] + c1[channel]) / 3.0f);
+			palette[3][channel] = std::floor((c0[channel] + 2 * c1[channel]) / 3.0f);
+		}
+		return palette;
+	}
+
+	std::array<uint8_t, 8> alphaPalette(uint8_t alpha0, uint8_t alpha1)
+	{
+		std::array<uint8_t, 8> palette{ alpha0, alpha1 };
+		if (alpha0 > alpha1) {
+			for (int i = 1; i < 7; i++) palette[i + 1] = static_cast<uint8_t>(((7 - i) * alpha0 + i * alpha1) / 7);
+		}
+		else {
+			for (int i = 1; i < 5; i++) palette[i + 1] = static_cast<uint8_t>(((5 - i) * alpha0 + i * alpha1) / 5);
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+		return palette;
+	}
+
+	/// Copies the 4x4 block at (blockX, blockY). Blocks hanging over the edge repeat the last row/column
+	std::array<uint8_t, 64> fetchBlock(const GE::Util::ImageLevel& level, uint32_t blockX, uint32_t blockY)
+	{
+		std::array<uint8_t, 64> block{};
+		for (uint32_t y = 0; y < 4; y++) {
+			const uint32_t sourceY = std::min(blockY * 4 + y, level.height - 1);
+			for (uint32_t x = 0; x < 4; x++) {
+				const uint32_t sourceX = std::min(blockX * 4 + x, level.width - 1);
+				std::memcpy(&block[(y * 4 + x) * 4], &level.pixels[(static_cast<size_t>(sourceY) * level.width + sourceX) * 4], 4);
+			}
+		}
+		return block;
+	}
+
+	// Endpoints along the principal axis of the block colors, slightly inset so the palette covers the common colors better
+	void encodeColorBlock(const std::array<uint8_t, 64>& block, uint8_t* output)
+	{
+		Color mean{};
+		for (int i = 0; i < 16; i++) for (int channel = 0; channel < 3; channel++) mean[channel] += block[i * 4 + channel] / 16.0f;
+
+		float covariance[6]{};
+		for (int i = 0; i < 16; i++) {
+			const float r = block[i * 4 + 0] - mean[0], g = block[i * 4 + 1] - mean[1], b = block[i * 4 + 2] - mean[2];
+			covariance[0] += r * r; covariance[1] += r * g; covariance[2] += r * b;
+			covariance[3] += g * g; covariance[4] += g * b; covariance[5] += b * b;
+		}
+		Color axis{ 1.0f, 1.0f, 1.0f };
+		for (int iteration = 0; iteration < 8; iteration++) {
+			const Color next{
+				covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2],
+				covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2],
+				covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2] };
+			const float length = std::max({ std::fabs(next[0]), std::fabs(next[1]), std::fabs(next[2]) });
+			if (length < 1e-6f) break;
+			axis = { next[0] / length, next[1] / length, next[2] / length };
+		}
+
+		float minimum = 1e30f, maximum = -1e30f;
+		for (int i = 0; i < 16; i++) {
+			const float projection = (block[i * 4 + 0] - mean[0]) * axis[0] + (block[i * 4 + 1] - mean[1]) * axis[1] + (block[i * 4 + 2] - mean[2]) * axis[2];
+			minimum = std::min(minimum, projection);
+			maximum = std::max(maximum, projection);
+		}
+		const float inset = (maximum - minimum) / 16.0f;
+		minimum += inset;
+		maximum -= inset;
+		Color high{}, low{};
+		for (int channel = 0; channel < 3; channel++) {
+			high[channel] = std::clamp(mean[channel] + axis[channel] * maximum, 0.0f, 255.0f);
+			low[channel] = std::clamp(mean[channel] + axis[channel] * minimum, 0.0f, 255.0f);
+		}
+
+		uint16_t color0 = packColor565(high), color1 = packColor565(low);
+		if (color0 < color1) std::swap(color0, color1); // color0 > color1 selects the 4 color mode
+		uint32_t indices = 0;
+		if (color0 != color1) {
+			const auto palette = colorPalette(color0, color1, false);
+			for (int i = 0; i < 16; i++) {
+				uint32_t best = 0;
+				float bestDistance = 1e30f;
+				for (uint32_t entry = 0; entry < 4; entry++) {
+					float distance = 0;
+					for (int channel = 0; channel < 3; channel++) {
+						const float delta = block[i * 4 + channel] - palette[entry][channel];
+						distance += delta * delta;
+					}
+					if (distance < bestDistance) { bestDistance = distance; best = entry; }
+				}
+				indices |= best << (2 * i);
+			}
+		}
+
+		std::memcpy(output + 0, &color0, 2);
+		std::memcpy(output + 2, &color1, 2);
+		std::memcpy(output + 4, &indices, 4);
+	}
+
+	void encodeAlphaBlock(const std::array<uint8_t, 64>& block, uint8_t* output)
+	{
+		uint8_t minimum = 255, maximum = 0;
+		for (int i = 0; i < 16; i++) {
+			minimum = std::min(minimum, block[i * 4 + 3]);
+			maximum = std::max(maximum, block[i * 4 + 3]);
+		}
+
+		uint64_t indices = 0;
+		if (minimum != maximum) {
+			const auto palette = alphaPalette(maximum, minimum);
+			for (int i = 0; i < 16; i++) {
+				uint64_t best = 0;
+				int bestDistance = 256;
+				for (uint64_t entry = 0; entry < 8; entry++) {
+					const int distance = std::abs(static_cast<int>(block[i * 4 + 3]) - palette[entry]);
+					if (distance < bestDistance) { bestDistance = distance; best = entry; }
+				}
+				indices |= best << (3 * i);
+			}
+		}
+
+		output[0] = maximum;
+		output[1] = minimum;
+		for (int byte = 0; byte < 6; byte++) output[2 + byte] = static_cast<uint8_t>(indices >> (8 * byte));
+	}
+
+	void decodeColorBlock(const uint8_t* input, uint8_t* rgba, size_t rowPitch, bool allowThreeColors)
+	{
+		uint16_t color0, color1;
+		uint32_t indices;
+		std::memcpy(&color0, input + 0, 2);
+		std::memcpy(&color1, input + 2, 2);
+		std::memcpy(&indices, input + 4, 4);
+		const auto palette = colorPalette(color0, color1, allowThreeColors);
+		const bool hasTransparent = allowThreeColors && color0 <= color1;
+		for (int i = 0; i < 16; i++) {
+			uint8_t* pixel = rgba + (i / 4) * rowPitch + (i % 4) * 4;
+			const uint32_t index = (indices >> (2 * i)) & 3;
+			const auto& color = palette[index];
+			pixel[0] = static_cast<uint8_t>(color[0]);
+			pixel[1] = static_cast<uint8_t>(color[1]);
+			pixel[2] = static_cast<uint8_t>(color[2]);
+			pixel[3] = hasTransparent && index == 3 ? 0 : 255;
+		}
+	}
+
+	void decodeAlphaBlock(const uint8_t* input, uint8_t* rgba, size_t rowPitch)
+	{
+		const auto palette = alphaPalette(input[0], input[1]);
+		uint64_t indices = 0;
+		for (int byte = 0; byte < 6; byte++) indices |= static_cast<uint64_t>(input[2 + byte]) << (8 * byte);
+		for (int i = 0; i < 16; i++) rgba[(i / 4) * rowPitch + (i % 4) * 4 + 3] = palette[(indices >> (3 * i)) & 7];
+	}
+
+	template<typename EncodeBlock>
+	std::vector<uint8_t> encodeBlocks(const GE::Util::ImageLevel& level, uint32_t blockBytes, EncodeBlock&& encodeBlock)
+	{
+		const uint32_t blocksWide = (level.width + 3) / 4, blocksHigh = (level.height + 3) / 4;
+		std::vector<uint8_t> blocks(static_cast<size_t>(blocksWide) * blocksHigh * blockBytes);
+		for (uint32_t blockY = 0; blockY < blocksHigh; blockY++) {
+			for (uint32_t blockX = 0; blockX < blocksWide; blockX++) {
+				encodeBlock(fetchBlock(level, blockX, blockY), &blocks[(static_cast<size_t>(blockY) * blocksWide + blockX) * blockBytes]);
+			}
+		}
+		return blocks;
+	}
+
+	template<typename DecodeBlock>
+	GE::Util::ImageLevel decodeBlocks(const uint8_t* blocks, uint32_t width, uint32_t height, uint32_t blockBytes, DecodeBlock&& decodeBlock)
+	{
+		// Decode into a buffer padded to whole blocks, then crop
+		const uint32_t blocksWide = (width + 3) / 4, blocksHigh = (height + 3) / 4;
+		const size_t paddedPitch = static_cast<size_t>(blocksWide) * 16;
+		std::vector<uint8_t> padded(paddedPitch * blocksHigh * 4);
+		for (uint32_t blockY = 0; blockY < blocksHigh; blockY++) {
+			for (uint32_t blockX = 0; blockX < blocksWide; blockX++) {
+				decodeBlock(blocks + (static_cast<size_t>(blockY) * blocksWide + blockX) * blockBytes, &padded[blockY * 4 * paddedPitch + blockX * 16], paddedPitch);
+			}
+		}
+
+		GE::Util::ImageLevel level;
+		level.width = width;
+		level.height = height;
+		level.pixels.resize(static_cast<size_t>(width) * height * 4);
+		for (uint32_t y = 0; y < height; y++) std::memcpy(&level.pixels[static_cast<size_t>(y) * width * 4], &padded[y * paddedPitch], static_cast<size_t>(width) * 4);
+		return level;
+	}
+}
+
+namespace GE::Util
+{
+	std::vector<ImageLevel> buildMipChain(const uint8_t* rgba, uint32_t width, uint32_t height)
+	{
+		const auto& toLinear = srgbTable();
+		std::vector<ImageLevel> levels(1);
+		levels[0].width = width;
+		levels[0].height = height;
+		levels[0].pixels.assign(rgba, rgba + static_cast<size_t>(width) * height * 4);
+
+		while (levels.back().width > 1 || levels.back().height > 1) {
+			const ImageLevel& source = levels.back();
+			ImageLevel next;
+			next.width = std::max(1u, source.width / 2);
+			next.height = std::max(1u, source.height / 2);
+			next.pixels.resize(static_cast<size_t>(next.width) * next.height * 4);
+
+			for (uint32_t y = 0; y < next.height; y++) {
+				for (uint32_t x = 0; x < next.width; x++) {
+					// 2x2 box filter. Odd sizes reuse the last row or column
+					const uint32_t x0 = std::min(x * 2, source.width - 1), x1 = std::min(x * 2 + 1, source.width - 1);
+					const uint32_t y0 = std::min(y * 2, source.height - 1), y1 = std::min(y * 2 + 1, source.height - 1);
+					const uint8_t* samples[4] = {
+						&source.pixels[(static_cast<size_t>(y0) * source.width + x0) * 4], &source.pixels[(static_cast<size_t>(y0) * source.width + x1) * 4],
+						&source.pixels[(static_cast<size_t>(y1) * source.width + x0) * 4], &source.pixels[(static_cast<size_t>(y1) * source.width + x1) * 4] };
+
+					uint8_t* target = &next.pixels[(static_cast<size_t>(y) * next.width + x) * 4];
+					for (int channel = 0; channel < 3; channel++) {
+						float sum = 0;
+						for (auto* sample : samples) sum += toLinear[sample[channel]];
+						target[channel] = toByte(linearToSrgb(sum / 4.0f));
+					}
+					target[3] = static_cast<uint8_t>((samples[0][3] + samples[1][3] + samples[2][3] + samples[3][3] + 2) / 4);
+				}
+			}
+			levels.push_back(std::move(next));
+		}
+		return levels;
+	}
+
+	size_t compressedSize(uint32_t width, uint32_t height, uint32_t blockBytes)
+	{
+		return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+	}
+
+	std::vector<uint8_t> encodeBC1(const ImageLevel& level)
+	{
+		return encodeBlocks(level, 8, [](const std::array<uint8_t, 64>& block, uint8_t* output) { encodeColorBlock(block, output); });
+	}
+
+	std::vector<uint8_t> encodeBC3(const ImageLevel& level)
+	{
+		return encodeBlocks(level, 16, [](const std::array<uint8_t, 64>& block, uint8_t* output) {
+			encodeAlphaBlock(block, output);
+			encodeColorBlock(block, output + 8);
+		});
+	}
+
+	ImageLevel decodeBC1(const uint8_t* blocks, uint32_t width, uint32_t height)
+	{
+		return decodeBlocks(blocks, width, height, 8, [](const uint8_t* input, uint8_t* rgba, size_t rowPitch) { decodeColorBlock(input, rgba, rowPitch, true); });
+	}
+
+	ImageLevel decodeBC3(const uint8_t* blocks, uint32_t width, uint32_t height)
+	{
+		return decodeBlocks(blocks, width, height, 16, [](const uint8_t* input, uint8_t* rgba, size_t rowPitch) {
+			decodeColorBlock(input + 8, rgba, rowPitch, false);
+			decodeAlphaBlock(input, rgba, rowPitch);
+		});
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace GE::Util
+{
+	/// @brief One mip level of RGBA8 pixels
+	struct ImageLevel
+	{
+		uint32_t width{ 0 };
+		uint32_t height{ 0 };
+		std::vector<uint8_t> pixels;
+	};
+
+	/// @brief Full mip chain down to 1x1. Level 0 is a copy of rgba. Colors are averaged in linear space
+	/// since the pixels are sRGB encoded, alpha is averaged as is
+	std::vector<ImageLevel> buildMipChain(const uint8_t* rgba, uint32_t width, uint32_t height);
+
+	/// @brief Bytes of one level once compressed. BC1 stores a 4x4 block in 8 bytes, BC3 in 16
+	size_t compressedSize(uint32_t width, uint32_t height, uint32_t blockBytes);
+
+	/// @brief BC1 (DXT1) in the opaque 4 color mode. Alpha is dropped
+	std::vector<uint8_t> encodeBC1(const ImageLevel& level);
+	/// @brief BC3 (DXT5). BC1 color block plus an interpolated 8 step alpha block
+	std::vector<uint8_t> encodeBC3(const ImageLevel& level);
+
+	/// @brief Back to RGBA8, for devices that can not sample block compressed formats
+	ImageLevel decodeBC1(const uint8_t* blocks, uint32_t width, uint32_t height);
+	ImageLevel decodeBC3(const uint8_t* blocks, uint32_t width, uint32_t height);
+}
@@ -1,9 +1,9 @@
 #include "GraphicEngine/Utility/DeviceSupport.hpp"
 #include "GraphicEngine/GraphicsQueue.hpp"
+#include "GraphicEngine/Utility/FileMapping.hpp"
 
 #include <exception>
 #include <set>
-#include <fstream>
 
 namespace GE::Util
  {
@@ -88,18 +88,15 @@ bool checkDeviceExtensionSupport(VkPhysicalDevice device) {
 
 std::vector<char> readFile(const std::string& filename)
 {
-    std::ifstream file(filename, std::ios::ate | std::ios::binary);
-
-    if (!file.is_open()) {
+    MappedFile file;
+    if (!file.open(filename)) {
         std::cout << "Fail to open " << filename << std::endl;
         throw std::runtime_error("failed to open file!");
     }
 
-    size_t fileSize = (size_t)file.tellg(); // since we are at end file, the position is the size
-    std::vector<char> buffer(fileSize);
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-    file.close();
+    // Callers that can work on the mapped bytes directly should hold a MappedFile instead of paying for this copy
+    std::vector<char> buffer(file.data(), file.data() + file.size());
+    recordFileCopy(buffer.size());
     return buffer;
 }
 
@@ -28,6 +28,7 @@ namespace GE::Util
 	std::vector<const char*> getRequiredExtensions();
 
 
+	/// @brief Copy of the whole file. Throws when it can not be opened
 	std::vector<char> readFile(const std::string& filename);
 
 
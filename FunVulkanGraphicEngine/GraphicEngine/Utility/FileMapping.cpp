@@ -0,0 +1,186 @@
+#include "GraphicEngine/Utility/FileMapping.hpp"
+#include "GraphicEngine/Utility/AssetPack.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	std::atomic<size_t> filesMapped{ 0 };
+	std::atomic<size_t> bytesMapped{ 0 };
+	std::atomic<size_t> filesRead{ 0 };
+	std::atomic<size_t> filesInflated{ 0 };
+	std::atomic<size_t> bytesCopied{ 0 };
+	std::atomic<size_t> bufferAllocations{ 0 };
+}
+
+namespace GE::Util
+{
+	FileReadStats fileReadStats()
+	{
+		FileReadStats stats;
+		stats.filesMapped = filesMapped.load();
+		stats.bytesMapped = bytesMapped.load();
+		stats.filesRead = filesRead.load();
+		stats.filesInflated = filesInflated.load();
+		stats.bytesCopied = bytesCopied.load();
+		stats.bufferAllocations = bufferAllocations.load();
+		return stats;
+	}
+
+	void recordFileCopy(size_t bytes)
+	{
+		bytesCopied += bytes;
+		bufferAllocations++;
+	}
+
+	MappedFile::MappedFile() = default;
+	MappedFile::~MappedFile() { close(); }
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this == &other) return *this;
+		close();
+		mappedData = std::exchange(other.mappedData, nullptr);
+		mappedSize = std::exchange(other.mappedSize, 0);
+		opened = std::exchange(other.opened, false);
+		mapped = std::exchange(other.mapped, false);
+		packed = std::exchange(other.packed, false);
+		readBuffer = std::move(other.readBuffer); // moving keeps the data pointer valid
+		currentError = std::move(other.currentError);
+#ifdef _WIN32
+		fileHandle = std::exchange(other.fileHandle, nullptr);
+		mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#else
+		fileDescriptor = std::exchange(other.fileDescriptor, -1);
+#endif
+		return *this;
+	}
+
+	bool MappedFile::open(const std::string& filePath)
+	{
+		close();
+		if (const AssetPack* pack = mountedAssetPack()) {
+			if (const AssetPackEntry* entry = pack->find(filePath)) return openPacked(*pack, *entry);
+		}
+#ifdef _WIN32
+		HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) { currentError = "failed to open " + filePath; return false; }
+		fileHandle = file;
+
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(file, &fileSize)) { currentError = "failed to query size of " + filePath; close(); return false; }
+		mappedSize = static_cast<size_t>(fileSize.QuadPart);
+
+		// Windows refuses to map an empty file. An empty view is still a valid result
+		if (mappedSize != 0) {
+			mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mappingHandle == nullptr) return readWhole(filePath);
+			mappedData = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+			if (mappedData == nullptr) return readWhole(filePath);
+		}
+#else
+		fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+		if (fileDescriptor < 0) { currentError = "failed to open " + filePath; return false; }
+
+		struct stat fileStat {};
+		if (fstat(fileDescriptor, &fileStat) != 0) { currentError = "failed to query size of " + filePath; close(); return false; }
+		mappedSize = static_cast<size_t>(fileStat.st_size);
+
+		if (mappedSize != 0) {
+			void* address = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+			if (address == MAP_FAILED) return readWhole(filePath);
+			mappedData = static_cast<const char*>(address);
+		}
+#endif
+		opened = true;
+		mapped = true;
+		filesMapped++;
+		bytesMapped += mappedSize;
+		return true;
+	}
+
+	bool MappedFile::openPacked(const AssetPack& pack, const AssetPackEntry& entry)
+	{
+		if (entry.compression == static_cast<uint32_t>(AssetCompression::None)) {
+			const auto stored = pack.storedBytes(entry);
+			mappedData = stored.data();
+			mappedSize = stored.size();
+			opened = true;
+			packed = true;
+			filesMapped++;
+			bytesMapped += mappedSize;
+			return true;
+		}
+
+		readBuffer.resize(static_cast<size_t>(entry.size));
+		if (auto errorMessage = pack.extract(entry, readBuffer.data()); !errorMessage.empty()) { currentError = errorMessage; close(); return false; }
+		mappedData = readBuffer.data();
+		mappedSize = readBuffer.size();
+		opened = true;
+		filesInflated++;
+		recordFileCopy(mappedSize);
+		return true;
+	}
+
+	bool MappedFile::readWhole(const std::string& filePath)
+	{
+		close();
+		std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+		if (!file.is_open()) { currentError = "failed to open " + filePath; return false; }
+
+		readBuffer.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(readBuffer.data(), static_cast<std::streamsize>(readBuffer.size()));
+		if (!file) { currentError = "failed to read " + filePath; close(); return false; }
+
+		mappedData = readBuffer.data();
+		mappedSize = readBuffer.size();
+		opened = true;
+		filesRead++;
+		recordFileCopy(mappedSize);
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+#ifdef _WIN32
+		if (mapped && mappedData != nullptr) UnmapViewOfFile(mappedData);
+		if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+		if (fileHandle != nullptr) CloseHandle(fileHandle);
+		mappingHandle = nullptr;
+		fileHandle = nullptr;
+#else
+		if (mapped && mappedData != nullptr) munmap(const_cast<char*>(mappedData), mappedSize);
+		if (fileDescriptor >= 0) ::close(fileDescriptor);
+		fileDescriptor = -1;
+#endif
+		mappedData = nullptr;
+		mappedSize = 0;
+		opened = false;
+		mapped = false;
+		packed = false;
+		readBuffer = std::vector<char>();
+	}
+
+	bool MappedFile::isOpen() const { return opened; }
+	const char* MappedFile::data() const { return mappedData; }
+	size_t MappedFile::size() const { return mappedSize; }
+	std::string_view MappedFile::view() const { return std::string_view(mappedData, mappedSize); }
+	std::span<const char> MappedFile::span() const { return std::span<const char>(mappedData, mappedSize); }
+	bool MappedFile::isMapped() const { return mapped || packed; }
+	std::string_view MappedFile::getError() const { return currentError; }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace GE::Util
+{
+	class AssetPack;
+	struct AssetPackEntry;
+
+	/// @brief How file bytes reached memory since startup, summed over the whole process
+	struct FileReadStats
+	{
+		size_t filesMapped{ 0 };
+		size_t bytesMapped{ 0 };
+		size_t filesRead{ 0 }; // opened through the read fallback
+		size_t filesInflated{ 0 }; // compressed asset pack entries
+		size_t bytesCopied{ 0 }; // read into heap buffers, by the fallback or by a caller that needed its own copy
+		size_t bufferAllocations{ 0 };
+	};
+
+	FileReadStats fileReadStats();
+	/// @brief For code that copies file bytes into a buffer of its own, so the copy shows up in the stats
+	void recordFileCopy(size_t bytes);
+
+	/// @brief Read only view of a whole file mapped into our address space.
+	/// The operating system pages the bytes in on demand, so nothing gets copied into the heap.
+	/// When the file can not be mapped it is read into a buffer instead, the view looks the same either way.
+	/// Paths held by the mounted asset pack are served from the pack
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+		MappedFile(MappedFile&&) noexcept;
+		MappedFile& operator=(MappedFile&&) noexcept;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool open(const std::string& filePath);
+		void close();
+
+		bool isOpen() const;
+		const char* data() const;
+		size_t size() const;
+		std::string_view view() const;
+		std::span<const char> span() const;
+		/// @brief False when the bytes sit in a buffer, from the read fallback or an inflated pack entry
+		bool isMapped() const;
+		std::string_view getError() const;
+
+	private:
+		bool readWhole(const std::string& filePath);
+		bool openPacked(const AssetPack& pack, const AssetPackEntry& entry);
+
+		const char* mappedData{ nullptr };
+		size_t mappedSize{ 0 };
+		bool opened{ false };
+		bool mapped{ false };
+		bool packed{ false }; // a view into the mounted pack, which is never unmapped
+		std::vector<char> readBuffer;
+		std::string currentError;
+#ifdef _WIN32
+		void* fileHandle{ nullptr };
+		void* mappingHandle{ nullptr };
+#else
+		int fileDescriptor{ -1 };
+#endif
+	};
+}
@@ -0,0 +1,300 @@
+#include "GraphicEngine/Utility/GlbReader.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+
+namespace
+{
+	constexpr uint32_t GlbMagic = 0x46546c67; // "glTF"
+	constexpr uint32_t JsonChunk = 0x4e4f534a; // "JSON"
+	constexpr uint32_t BinaryChunk = 0x004e4942; // "BIN\0"
+	constexpr std::string_view ImageSeparator = "#image";
+
+	constexpr uint32_t TriangleMode = 4;
+
+	enum ComponentType : uint32_t
+	{
+		Byte = 5120,
+		UnsignedByte = 5121,
+		Short = 5122,
+		UnsignedShort = 5123,
+		UnsignedInt = 5125,
+		Float = 5126,
+	};
+
+	size_t componentSize(uint32_t componentType)
+	{
+		switch (componentType) {
+		case Byte: case UnsignedByte: return 1;
+		case Short: case UnsignedShort: return 2;
+		case UnsignedInt: case Float: return 4;
+		default: return 0;
+		}
+	}
+
+	uint32_t componentCount(const std::string& type)
+	{
+		if (type == "SCALAR") return 1;
+		if (type == "VEC2") return 2;
+		if (type == "VEC3") return 3;
+		if (type == "VEC4") return 4;
+		return 0;
+	}
+
+	uint32_t readUint32(const char* data)
+	{
+		uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	/// @brief Component as a float, normalized integers map to [0,1] or [-1,1] like the spec says
+	float readComponent(const char* data, uint32_t componentType, bool normalized)
+	{
+		switch (componentType) {
+		case Float: { float value; std::memcpy(&value, data, sizeof(value)); return value; }
+		case UnsignedByte: { uint8_t value; std::memcpy(&value, data, sizeof(value)); return normalized ? value / 255.0f : value; }
+		case UnsignedShort: { uint16_t value; std::memcpy(&value, data, sizeof(value)); return normalized ? value / 65535.0f : value; }
+		case Byte: { int8_t value; std::memcpy(&value, data, sizeof(value)); return normalized ? std::max(value / 127.0f, -1.0f) : value; }
+		case Short: { int16_t value; std::memcpy(&value, data, sizeof(value)); return normalized ? std::max(value / 32767.0f, -1.0f) : value; }
+		case UnsignedInt: return static_cast<float>(readUint32(data));
+		default: return 0.0f;
+		}
+	}
+
+	uint32_t readIndex(const char* data, uint32_t componentType)
+	{
+		switch (componentType) {
+		case UnsignedByte: return static_cast<uint8_t>(*data);
+		case UnsignedShort: { uint16_t value; std::memcpy(&value, data, sizeof(value)); return value; }
+		default: return readUint32(data);
+		}
+	}
+}
+
+namespace GE::Util
+{
+	bool GlbFile::isGlb(std::string_view filePath) { return std::filesystem::path(filePath).extension() == Extension; }
+
+	std::string GlbFile::imagePath(std::string_view glbPath, uint32_t image) { return std::string(glbPath) + std::string(ImageSeparator) + std::to_string(image); }
+
+	bool GlbFile::splitImagePath(std::string_view path, std::string& glbPath, uint32_t& image)
+	{
+		const size_t separator = path.rfind(ImageSeparator);
+		if (separator == std::string_view::npos || !isGlb(path.substr(0, separator))) return false;
+		const std::string_view number = path.substr(separator + ImageSeparator.size());
+		const auto [end, error] = std::from_chars(number.data(), number.data() + number.size(), image);
+		if (error != std::errc() || end != number.data() + number.size()) return false;
+		glbPath = std::string(path.substr(0, separator));
+		return true;
+	}
+
+	bool GlbFile::open(const std::string& filePath)
+	{
+		this->filePath = filePath;
+		binaryChunk = {};
+		document = JsonValue();
+		if (!file.open(filePath)) {
+			currentError = std::string(file.getError());
+			return false;
+		}
+
+		// [12 byte header][JSON chunk][optional BIN chunk], every chunk starts with its length and type
+		const char* data = file.data();
+		const size_t size = file.size();
+		if (size < 20 || readUint32(data) != GlbMagic) { currentError = filePath + ": not a glTF binary"; return false; }
+		if (readUint32(data + 4) != 2) { currentError = filePath + ": only glTF 2.0 is supported"; return false; }
+		const size_t length = std::min<size_t>(readUint32(data + 8), size);
+
+		const size_t jsonLength = readUint32(data + 12);
+		if (readUint32(data + 16) != JsonChunk || 20 + jsonLength > length) { currentError = filePath + ": first chunk is not JSON"; return false; }
+		if (auto errorMessage = parseJson(std::string_view(data + 20, jsonLength), document); !errorMessage.empty()) {
+			currentError = filePath + ": " + errorMessage;
+			return false;
+		}
+		if (!document["asset"]["version"].string().starts_with("2")) { currentError = filePath + ": only glTF 2.0 is supported"; return false; }
+
+		const size_t binaryStart = 20 + jsonLength;
+		if (binaryStart + 8 <= length && readUint32(data + binaryStart + 4) == BinaryChunk) {
+			const size_t binaryLength = readUint32(data + binaryStart);
+			if (binaryStart + 8 + binaryLength > length) { currentError = filePath + ": binary chunk is cut off"; return false; }
+			binaryChunk = std::span<const char>(data + binaryStart + 8, binaryLength);
+		}
+		currentError.clear();
+		return true;
+	}
+
+	std::string_view GlbFile::getError() const { return currentError; }
+
+	ErrorMessage GlbFile::bufferViewBytes(int64_t bufferView, std::span<const char>& bytes) const
+	{
+		const JsonValue& view = document["bufferViews"][static_cast<size_t>(bufferView)];
+		if (bufferView < 0 || !view.isObject()) return filePath + ": missing buffer view " + std::to_string(bufferView);
+		// Buffer 0 without an uri is the binary chunk, external buffers would have to be read from disk
+		const int64_t buffer = view["buffer"].integer();
+		if (buffer != 0 || document["buffers"][size_t{ 0 }].contains("uri")) return filePath + ": buffer view " + std::to_string(bufferView) + " is not in the binary chunk";
+
+		const int64_t offset = view["byteOffset"].integer(0);
+		const int64_t length = view["byteLength"].integer();
+		if (offset < 0 || length < 0 || static_cast<uint64_t>(offset) + static_cast<uint64_t>(length) > binaryChunk.size()) return filePath + ": buffer view " + std::to_string(bufferView) + " is out of range";
+		bytes = binaryChunk.subspan(static_cast<size_t>(offset), static_cast<size_t>(length));
+		return "";
+	}
+
+	ErrorMessage GlbFile::accessorView(int64_t accessor, AccessorView& view) const
+	{
+		const JsonValue& description = document["accessors"][static_cast<size_t>(accessor)];
+		const std::string name = filePath + ": accessor " + std::to_string(accessor);
+		if (accessor < 0 || !description.isObject()) return name + " is missing";
+		if (description.contains("sparse")) return name + " is sparse, which is not supported";
+
+		view.componentType = static_cast<uint32_t>(description["componentType"].integer(0));
+		view.components = componentCount(description["type"].string());
+		view.normalized = description["normalized"].boolean();
+		const size_t elementSize = componentSize(view.componentType) * view.components;
+		if (elementSize == 0) return name + " has an unsupported type";
+
+		const int64_t count = description["count"].integer();
+		view.bufferView = description["bufferView"].integer();
+		std::span<const char> bytes;
+		if (auto errorMessage = bufferViewBytes(view.bufferView, bytes); !errorMessage.empty()) return errorMessage;
+		const int64_t offset = description["byteOffset"].integer(0);
+		const int64_t stride = document["bufferViews"][static_cast<size_t>(view.bufferView)]["byteStride"].integer(0);
+		if (count < 0 || offset < 0 || stride < 0) return name + " has a negative count, offset or stride";
+
+		if (stride > 0 && static_cast<uint64_t>(stride) < elementSize) return name + " has a stride smaller than its elements";
+
+		view.count = static_cast<size_t>(count);
+		view.stride = stride > 0 ? static_cast<size_t>(stride) : elementSize;
+		// Checked by division, count and stride come straight from the file and their product can wrap
+		if (static_cast<uint64_t>(offset) > bytes.size()) return name + " reads past its buffer view";
+		const uint64_t limit = bytes.size() - static_cast<uint64_t>(offset);
+		if (view.count > 0 && (elementSize > limit || view.count - 1 > (limit - elementSize) / view.stride)) return name + " reads past its buffer view";
+		view.data = bytes.data() + offset;
+		return "";
+	}
+
+	ErrorMessage GlbFile::readMesh(GlbMesh& mesh) const
+	{
+		mesh = GlbMesh();
+		const JsonValue& primitives = document["meshes"][size_t{ 0 }]["primitives"];
+		if (primitives.size() == 0) return filePath + ": has no mesh";
+
+		for (size_t p = 0; p < primitives.size(); p++) {
+			const JsonValue& primitive = primitives[p];
+			if (primitive["mode"].integer(TriangleMode) != TriangleMode) return filePath + ": primitive " + std::to_string(p) + " is not a triangle list";
+
+			const JsonValue& attributes = primitive["attributes"];
+			AccessorView position, color, texCoord;
+			if (auto errorMessage = accessorView(attributes["POSITION"].integer(), position); !errorMessage.empty()) return errorMessage;
+			if (position.componentType != Float || position.components != 3) return filePath + ": positions have to be float vec3";
+			// glTF requires min and max on positions, exporters that skip them cost a pass over the vertices at upload
+			const JsonValue& positionAccessor = document["accessors"][static_cast<size_t>(attributes["POSITION"].integer())];
+			const JsonValue& low = positionAccessor["min"];
+			const JsonValue& high = positionAccessor["max"];
+			if (low.size() == 3 && high.size() == 3 && (p == 0 || mesh.bounds)) {
+				const MeshBounds primitiveBounds{ glm::vec3(low[0].number(), low[1].number(), low[2].number()), glm::vec3(high[0].number(), high[1].number(), high[2].number()) };
+				if (!mesh.bounds) mesh.bounds = primitiveBounds;
+				mesh.bounds->minimum = glm::min(mesh.bounds->minimum, primitiveBounds.minimum);
+				mesh.bounds->maximum = glm::max(mesh.bounds->maximum, primitiveBounds.maximum);
+			}
+			else mesh.bounds.reset();
+			if (attributes.contains("COLOR_0")) {
+				if (auto errorMessage = accessorView(attributes["COLOR_0"].integer(), color); !errorMessage.empty()) return errorMessage;
+				if (color.count != position.count || color.components < 3) return filePath + ": colors do not match the positions";
+			}
+			if (attributes.contains("TEXCOORD_0")) {
+				if (auto errorMessage = accessorView(attributes["TEXCOORD_0"].integer(), texCoord); !errorMessage.empty()) return errorMessage;
+				if (texCoord.count != position.count || texCoord.components != 2) return filePath + ": uvs do not match the positions";
+			}
+
+			const size_t firstVertex = mesh.convertedVertices.size();
+			const size_t vertexCount = position.count;
+			// A single primitive interleaved exactly like Vertex is uploaded straight out of the mapping
+			const bool matchesVertex = primitives.size() == 1
+				&& color.data != nullptr && texCoord.data != nullptr
+				&& color.bufferView == position.bufferView && texCoord.bufferView == position.bufferView
+				&& position.stride == sizeof(Vertex) && color.componentType == Float && color.components == 3 && texCoord.componentType == Float
+				&& color.data - position.data == static_cast<ptrdiff_t>(offsetof(Vertex, color) - offsetof(Vertex, pos))
+				&& texCoord.data - position.data == static_cast<ptrdiff_t>(offsetof(Vertex, texCoord) - offsetof(Vertex, pos))
+				&& reinterpret_cast<uintptr_t>(position.data - offsetof(Vertex, pos)) % alignof(Vertex) == 0;
+			if (matchesVertex) {
+				mesh.vertices = std::span<const Vertex>(reinterpret_cast<const Vertex*>(position.data - offsetof(Vertex, pos)), vertexCount);
+			}
+			else {
+				mesh.convertedVertices.resize(firstVertex + vertexCount);
+				for (size_t i = 0; i < vertexCount; i++) {
+					Vertex& vertex = mesh.convertedVertices[firstVertex + i];
+					const char* element = position.data + i * position.stride;
+					vertex.pos = { readComponent(element, Float, false), readComponent(element + 4, Float, false), readComponent(element + 8, Float, false) };
+					vertex.color = { 1.0f, 1.0f, 1.0f };
+					if (color.data != nullptr) {
+						const char* source = color.data + i * color.stride;
+						const size_t size = componentSize(color.componentType);
+						// Integer colors are always normalized
+						const bool normalized = color.componentType != Float;
+						vertex.color = { readComponent(source, color.componentType, normalized), readComponent(source + size, color.componentType, normalized), readComponent(source + 2 * size, color.componentType, normalized) };
+					}
+					// glTF has the origin of the image at the top, like vulkan
+					vertex.texCoord = { 0.0f, 0.0f };
+					if (texCoord.data != nullptr) {
+						const char* source = texCoord.data + i * texCoord.stride;
+						vertex.texCoord = { readComponent(source, texCoord.componentType, texCoord.normalized), readComponent(source + componentSize(texCoord.componentType), texCoord.componentType, texCoord.normalized) };
+					}
+				}
+			}
+
+			// Without indices every three vertices make a triangle
+			if (!primitive.contains("indices")) {
+				for (size_t i = 0; i < vertexCount; i++) mesh.convertedIndices.push_back(static_cast<uint32_t>(firstVertex + i));
+				continue;
+			}
+			AccessorView indices;
+			if (auto errorMessage = accessorView(primitive["indices"].integer(), indices); !errorMessage.empty()) return errorMessage;
+			if (indices.components != 1 || (indices.componentType != UnsignedByte && indices.componentType != UnsignedShort && indices.componentType != UnsignedInt)) return filePath + ": indices have to be unsigned integers";
+
+			const bool matchesIndices = primitives.size() == 1 && indices.componentType == UnsignedInt && indices.stride == sizeof(uint32_t)
+				&& reinterpret_cast<uintptr_t>(indices.data) % alignof(uint32_t) == 0;
+			if (matchesIndices) {
+				mesh.indices = std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(indices.data), indices.count);
+			}
+			else {
+				mesh.convertedIndices.reserve(mesh.convertedIndices.size() + indices.count);
+				for (size_t i = 0; i < indices.count; i++) mesh.convertedIndices.push_back(static_cast<uint32_t>(firstVertex + readIndex(indices.data + i * indices.stride, indices.componentType)));
+			}
+		}
+
+		// Spans into the copies are only taken now, the vectors are done growing
+		if (mesh.vertices.empty()) mesh.vertices = mesh.convertedVertices;
+		if (mesh.indices.empty()) mesh.indices = mesh.convertedIndices;
+		if (mesh.indices.size() % 3 != 0) return filePath + ": index count is not a multiple of 3";
+		// Out of range indices would read past the vertex buffer on the GPU
+		for (uint32_t index : mesh.indices) {
+			if (index >= mesh.vertices.size()) return filePath + ": index " + std::to_string(index) + " is past the last vertex";
+		}
+		return "";
+	}
+
+	int32_t GlbFile::baseColorImage() const
+	{
+		const int64_t material = document["meshes"][size_t{ 0 }]["primitives"][size_t{ 0 }]["material"].integer();
+		if (material < 0) return -1;
+		const int64_t texture = document["materials"][static_cast<size_t>(material)]["pbrMetallicRoughness"]["baseColorTexture"]["index"].integer();
+		if (texture < 0) return -1;
+		const int64_t image = document["textures"][static_cast<size_t>(texture)]["source"].integer();
+		return image < 0 || image > INT32_MAX ? -1 : static_cast<int32_t>(image);
+	}
+
+	ErrorMessage GlbFile::imageBytes(uint32_t image, std::span<const char>& bytes) const
+	{
+		const JsonValue& description = document["images"][image];
+		if (!description.isObject()) return filePath + ": has no image " + std::to_string(image);
+		if (description.contains("uri")) return filePath + ": image " + std::to_string(image) + " is an external file, only embedded images are supported";
+		const std::string& mimeType = description["mimeType"].string();
+		if (mimeType != "image/png" && mimeType != "image/jpeg") return filePath + ": image " + std::to_string(image) + " is " + mimeType + ", only PNG and JPEG are supported";
+		return bufferViewBytes(description["bufferView"].integer(), bytes);
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "GraphicEngine/GraphicsVertex.hpp"
+#include "GraphicEngine/Utility/FileMapping.hpp"
+#include "GraphicEngine/Utility/Json.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace GE::Util
+{
+	/// @brief Geometry of a glTF mesh. The spans point into the mapped file when its layout already matches what
+	/// gets uploaded, otherwise into the converted copies next to them
+	struct GlbMesh
+	{
+		std::span<const Vertex> vertices;
+		std::span<const uint32_t> indices;
+		std::vector<Vertex> convertedVertices;
+		std::vector<uint32_t> convertedIndices;
+		/// @brief From the min and max of the position accessors, empty when a primitive leaves them out
+		std::optional<MeshBounds> bounds;
+
+		/// @brief True when both spans point into the mapped file
+		bool inFile() const { return convertedVertices.empty() && convertedIndices.empty(); }
+	};
+
+	/// @brief In-tree reader for glTF 2.0 binaries (.glb). The file stays mapped while this lives, meshes and
+	/// embedded images are read straight out of the mapping
+	class GlbFile
+	{
+	public:
+		static constexpr const char* Extension = ".glb";
+
+		static bool isGlb(std::string_view filePath);
+		/// @brief Texture path of an image embedded in glbPath, goes anywhere a texture file name does
+		static std::string imagePath(std::string_view glbPath, uint32_t image);
+		/// @brief False unless path came from imagePath
+		static bool splitImagePath(std::string_view path, std::string& glbPath, uint32_t& image);
+
+		/// @brief Maps the file and parses its JSON chunk
+		bool open(const std::string& filePath);
+		std::string_view getError() const;
+
+		/// @brief Triangles of every primitive of the first mesh. Interleaved float position, color and uv laid out like
+		/// Vertex and 32 bit indices are not touched, anything else is converted
+		ErrorMessage readMesh(GlbMesh& mesh) const;
+		/// @brief Image the first mesh's material takes its base color from, -1 when it has none
+		int32_t baseColorImage() const;
+		/// @brief Encoded PNG or JPEG bytes of an embedded image
+		ErrorMessage imageBytes(uint32_t image, std::span<const char>& bytes) const;
+
+	private:
+		/// @brief Where an accessor's elements sit in the binary chunk
+		struct AccessorView
+		{
+			const char* data{ nullptr };
+			size_t count{ 0 };
+			size_t stride{ 0 };
+			int64_t bufferView{ -1 };
+			uint32_t componentType{ 0 };
+			uint32_t components{ 0 };
+			bool normalized{ false };
+		};
+
+		ErrorMessage bufferViewBytes(int64_t bufferView, std::span<const char>& bytes) const;
+		ErrorMessage accessorView(int64_t accessor, AccessorView& view) const;
+
+		MappedFile file;
+		JsonValue document;
+		std::span<const char> binaryChunk;
+		std::string filePath;
+		std::string currentError;
+	};
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace GE::Util
+{
+	// Small non-cryptographic 64 bit hashing helpers.
+	// Kept inline since they sit in the middle of hot loading loops
+
+	inline uint64_t mixHash(uint64_t value)
+	{
+		// Finalizer from MurmurHash3, every input bit affects every output bit
+		value ^= value >> 33;
+		value *= 0xff51afd7ed558ccdULL;
+		value ^= value >> 33;
+		value *= 0xc4ceb9fe1a85ec53ULL;
+		value ^= value >> 33;
+		return value;
+	}
+
+	inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0)
+	{
+		constexpr uint64_t prime = 0x9e3779b97f4a7c15ULL;
+		const auto* bytes = static_cast<const unsigned char*>(data);
+		uint64_t hash = seed ^ (size * prime);
+
+		size_t offset = 0;
+		for (; offset + 8 <= size; offset += 8) {
+			uint64_t word;
+			std::memcpy(&word, bytes + offset, 8);
+			hash = (hash ^ mixHash(word)) * prime;
+		}
+		if (offset < size) {
+			uint64_t word = 0;
+			std::memcpy(&word, bytes + offset, size - offset);
+			hash = (hash ^ mixHash(word)) * prime;
+		}
+		return mixHash(hash);
+	}
+
+	inline uint64_t rotateLeft(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+	/// @brief Fixed size hash of exactly 32 bytes, the size of a Vertex. Cheaper than hashBytes for the welding loops
+	inline uint64_t hashBlock32(const void* data)
+	{
+		uint64_t words[4];
+		std::memcpy(words, data, sizeof(words));
+		const uint64_t a = (words[0] ^ 0x9e3779b97f4a7c15ULL) * 0xbf58476d1ce4e5b9ULL;
+		const uint64_t b = (words[1] ^ 0xc2b2ae3d27d4eb4fULL) * 0x94d049bb133111ebULL;
+		const uint64_t c = (words[2] ^ 0x165667b19e3779f9ULL) * 0xbf58476d1ce4e5b9ULL;
+		const uint64_t d = (words[3] ^ 0x27d4eb2f165667c5ULL) * 0x94d049bb133111ebULL;
+		return mixHash(a ^ rotateLeft(b, 21) ^ rotateLeft(c, 42) ^ rotateLeft(d, 63));
+	}
+}
@@ -0,0 +1,246 @@
+#include "GraphicEngine/Utility/Json.hpp"
+
+#include <charconv>
+#include <cmath>
+
+namespace
+{
+	// Deeper documents are broken or hostile, glTF nests a handful of levels
+	constexpr uint32_t MaxDepth = 64;
+
+	const GE::Util::JsonValue NullValue{};
+	const std::string EmptyString{};
+
+	void appendUtf8(std::string& out, uint32_t codePoint)
+	{
+		if (codePoint < 0x80) out += static_cast<char>(codePoint);
+		else if (codePoint < 0x800) {
+			out += static_cast<char>(0xc0 | (codePoint >> 6));
+			out += static_cast<char>(0x80 | (codePoint & 0x3f));
+		}
+		else if (codePoint < 0x10000) {
+			out += static_cast<char>(0xe0 | (codePoint >> 12));
+			out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+			out += static_cast<char>(0x80 | (codePoint & 0x3f));
+		}
+		else {
+			out += static_cast<char>(0xf0 | (codePoint >> 18));
+			out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+			out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+			out += static_cast<char>(0x80 | (codePoint & 0x3f));
+		}
+	}
+}
+
+namespace GE::Util
+{
+	JsonValue::Type JsonValue::type() const { return valueType; }
+	bool JsonValue::isNull() const { return valueType == Type::Null; }
+	bool JsonValue::isNumber() const { return valueType == Type::Number; }
+	bool JsonValue::isString() const { return valueType == Type::String; }
+	bool JsonValue::isArray() const { return valueType == Type::Array; }
+	bool JsonValue::isObject() const { return valueType == Type::Object; }
+
+	double JsonValue::number(double fallback) const { return valueType == Type::Number ? numberValue : fallback; }
+	int64_t JsonValue::integer(int64_t fallback) const
+	{
+		if (valueType != Type::Number || std::floor(numberValue) != numberValue || std::abs(numberValue) > 9007199254740992.0) return fallback;
+		return static_cast<int64_t>(numberValue);
+	}
+	bool JsonValue::boolean(bool fallback) const { return valueType == Type::Bool ? boolValue : fallback; }
+	const std::string& JsonValue::string() const { return valueType == Type::String ? stringValue : EmptyString; }
+
+	size_t JsonValue::size() const { return children.size(); }
+	const JsonValue& JsonValue::operator[](size_t index) const
+	{
+		if (valueType != Type::Array || index >= children.size()) return NullValue;
+		return children[index];
+	}
+	const JsonValue& JsonValue::operator[](std::string_view key) const
+	{
+		if (valueType != Type::Object) return NullValue;
+		for (size_t i = 0; i < keys.size(); i++) {
+			if (keys[i] == key) return children[i];
+		}
+		return NullValue;
+	}
+	bool JsonValue::contains(std::string_view key) const { return !(*this)[key].isNull(); }
+
+
+
+	/// @brief Recursive descent over the text, fills the tree as it goes
+	class JsonParser
+	{
+	public:
+		explicit JsonParser(std::string_view text) : current(text.data()), end(text.data() + text.size()), begin(text.data()) {}
+
+		ErrorMessage parseDocument(JsonValue& value)
+		{
+			if (auto errorMessage = parseValue(value, 0); !errorMessage.empty()) return errorMessage;
+			skipWhitespace();
+			if (current != end) return fail("trailing characters after the document");
+			return "";
+		}
+
+	private:
+		ErrorMessage fail(const std::string& what) const { return "json offset " + std::to_string(current - begin) + ": " + what; }
+
+		void skipWhitespace()
+		{
+			while (current < end && (*current == ' ' || *current == '\t' || *current == '\n' || *current == '\r')) ++current;
+		}
+
+		bool consume(std::string_view literal)
+		{
+			if (static_cast<size_t>(end - current) < literal.size() || std::string_view(current, literal.size()) != literal) return false;
+			current += literal.size();
+			return true;
+		}
+
+		ErrorMessage parseValue(JsonValue& value, uint32_t depth)
+		{
+			if (depth > MaxDepth) return fail("nested too deep");
+			skipWhitespace();
+			if (current == end) return fail("unexpected end");
+
+			switch (*current) {
+			case '{': return parseObject(value, depth);
+			case '[': return parseArray(value, depth);
+			case '"':
+				value.valueType = JsonValue::Type::String;
+				return parseString(value.stringValue);
+			case 't':
+			case 'f':
+				value.valueType = JsonValue::Type::Bool;
+				value.boolValue = *current == 't';
+				if (!consume(value.boolValue ? "true" : "false")) return fail("invalid literal");
+				return "";
+			case 'n':
+				value.valueType = JsonValue::Type::Null;
+				if (!consume("null")) return fail("invalid literal");
+				return "";
+			default:
+				return parseNumber(value);
+			}
+		}
+
+		ErrorMessage parseObject(JsonValue& value, uint32_t depth)
+		{
+			value.valueType = JsonValue::Type::Object;
+			++current; // {
+			skipWhitespace();
+			if (current < end && *current == '}') { ++current; return ""; }
+			while (true) {
+				skipWhitespace();
+				if (current == end || *current != '"') return fail("expected a member name");
+				std::string key;
+				if (auto errorMessage = parseString(key); !errorMessage.empty()) return errorMessage;
+				skipWhitespace();
+				if (current == end || *current != ':') return fail("expected ':'");
+				++current;
+
+				value.keys.push_back(std::move(key));
+				value.children.emplace_back();
+				if (auto errorMessage = parseValue(value.children.back(), depth + 1); !errorMessage.empty()) return errorMessage;
+
+				skipWhitespace();
+				if (current == end) return fail("unterminated object");
+				if (*current == ',') { ++current; continue; }
+				if (*current == '}') { ++current; return ""; }
+				return fail("expected ',' or '}'");
+			}
+		}
+
+		ErrorMessage parseArray(JsonValue& value, uint32_t depth)
+		{
+			value.valueType = JsonValue::Type::Array;
+			++current; // [
+			skipWhitespace();
+			if (current < end && *current == ']') { ++current; return ""; }
+			while (true) {
+				value.children.emplace_back();
+				if (auto errorMessage = parseValue(value.children.back(), depth + 1); !errorMessage.empty()) return errorMessage;
+
+				skipWhitespace();
+				if (current == end) return fail("unterminated array");
+				if (*current == ',') { ++current; continue; }
+				if (*current == ']') { ++current; return ""; }
+				return fail("expected ',' or ']'");
+			}
+		}
+
+		bool parseHex4(uint32_t& codeUnit)
+		{
+			if (end - current < 4) return false;
+			codeUnit = 0;
+			for (int i = 0; i < 4; i++, ++current) {
+				const char c = *current;
+				codeUnit <<= 4;
+				if (c >= '0' && c <= '9') codeUnit |= c - '0';
+				else if (c >= 'a' && c <= 'f') codeUnit |= c - 'a' + 10;
+				else if (c >= 'A' && c <= 'F') codeUnit |= c - 'A' + 10;
+				else return false;
+			}
+			return true;
+		}
+
+		ErrorMessage parseString(std::string& out)
+		{
+			++current; // "
+			while (current < end) {
+				const char c = *current++;
+				if (c == '"') return "";
+				if (static_cast<unsigned char>(c) < 0x20) return fail("control character in string");
+				if (c != '\\') { out += c; continue; }
+
+				if (current == end) break;
+				switch (*current++) {
+				case '"': out += '"'; break;
+				case '\\': out += '\\'; break;
+				case '/': out += '/'; break;
+				case 'b': out += '\b'; break;
+				case 'f': out += '\f'; break;
+				case 'n': out += '\n'; break;
+				case 'r': out += '\r'; break;
+				case 't': out += '\t'; break;
+				case 'u': {
+					uint32_t codePoint = 0;
+					if (!parseHex4(codePoint)) return fail("invalid \\u escape");
+					// Characters outside the basic plane come as a surrogate pair
+					if (codePoint >= 0xd800 && codePoint < 0xdc00) {
+						uint32_t low = 0;
+						if (!consume("\\u") || !parseHex4(low) || low < 0xdc00 || low >= 0xe000) return fail("unpaired surrogate");
+						codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+					}
+					else if (codePoint >= 0xdc00 && codePoint < 0xe000) return fail("unpaired surrogate");
+					appendUtf8(out, codePoint);
+					break;
+				}
+				default: return fail("invalid escape");
+				}
+			}
+			return fail("unterminated string");
+		}
+
+		ErrorMessage parseNumber(JsonValue& value)
+		{
+			// Leading zeros slip through, everything else from_chars rejects the same way json does
+			if (*current != '-' && (*current < '0' || *current > '9')) return fail("unexpected character");
+			value.valueType = JsonValue::Type::Number;
+			const auto [next, error] = std::from_chars(current, end, value.numberValue);
+			if (error != std::errc()) return fail("invalid number");
+			current = next;
+			return "";
+		}
+
+		const char* current;
+		const char* end;
+		const char* begin;
+	};
+
+	ErrorMessage parseJson(std::string_view text, JsonValue& value)
+	{
+		value = JsonValue();
+		return JsonParser(text).parseDocument(value);
+	}
+}
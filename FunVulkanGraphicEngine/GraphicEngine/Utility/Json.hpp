@@ -0,0 +1,53 @@
+#pragma once
+
+#include "GraphicEngine/ConstDefines.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace GE::Util
+{
+	/// @brief Read only tree of a parsed JSON document. Small on purpose, it only has to get through glTF headers.
+	/// Looking up what is not there gives a null value instead of failing, so lookups can be chained
+	class JsonValue
+	{
+	public:
+		enum class Type : uint8_t { Null, Bool, Number, String, Array, Object };
+
+		Type type() const;
+		bool isNull() const;
+		bool isNumber() const;
+		bool isString() const;
+		bool isArray() const;
+		bool isObject() const;
+
+		/// @brief fallback unless the value is a number
+		double number(double fallback = 0.0) const;
+		/// @brief fallback unless the value is a whole number
+		int64_t integer(int64_t fallback = -1) const;
+		bool boolean(bool fallback = false) const;
+		/// @brief Empty unless the value is a string
+		const std::string& string() const;
+
+		/// @brief Elements of an array, members of an object
+		size_t size() const;
+		const JsonValue& operator[](size_t index) const;
+		const JsonValue& operator[](std::string_view key) const;
+		bool contains(std::string_view key) const;
+
+	private:
+		friend class JsonParser;
+
+		Type valueType{ Type::Null };
+		bool boolValue{ false };
+		double numberValue{ 0.0 };
+		std::string stringValue;
+		std::vector<JsonValue> children;
+		std::vector<std::string> keys; // one per child for objects, empty for arrays
+	};
+
+	/// @brief Parses text, which has to hold exactly one JSON value
+	ErrorMessage parseJson(std::string_view text, JsonValue& value);
+}
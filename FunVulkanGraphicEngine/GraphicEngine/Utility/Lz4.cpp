@@ -0,0 +1,122 @@
+#include "GraphicEngine/Utility/Lz4.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+	constexpr size_t MinMatch = 4;
+	// The format wants the last 5 bytes as literals and no match starting in the last 12
+	constexpr size_t LastLiterals = 5;
+	constexpr size_t MatchFindLimit = 12;
+	constexpr size_t MaxOffset = 65535;
+	constexpr int HashBits = 14;
+
+	uint32_t read32(const char* data)
+	{
+		uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	uint32_t hashOf(uint32_t sequence) { return (sequence * 2654435761u) >> (32 - HashBits); }
+
+	void writeLength(std::vector<char>& output, size_t length)
+	{
+		while (length >= 255) { output.push_back(static_cast<char>(255)); length -= 255; }
+		output.push_back(static_cast<char>(length));
+	}
+
+	void writeSequence(std::vector<char>& output, const char* literals, size_t literalCount, size_t offset, size_t matchLength)
+	{
+		const size_t matchCode = matchLength >= MinMatch ? matchLength - MinMatch : 0;
+		const uint8_t token = static_cast<uint8_t>((literalCount >= 15 ? 15 : literalCount) << 4 | (matchCode >= 15 ? 15 : matchCode));
+		output.push_back(static_cast<char>(token));
+		if (literalCount >= 15) writeLength(output, literalCount - 15);
+		output.insert(output.end(), literals, literals + literalCount);
+		if (matchLength == 0) return; // last sequence has no match
+
+		output.push_back(static_cast<char>(offset & 0xff));
+		output.push_back(static_cast<char>(offset >> 8));
+		if (matchCode >= 15) writeLength(output, matchCode - 15);
+	}
+
+	/// @brief Reads the 255 continued part of a length, false when it runs past the input
+	bool readLength(const uint8_t* source, size_t sourceSize, size_t& position, size_t& length)
+	{
+		uint8_t byte;
+		do {
+			if (position >= sourceSize) return false;
+			byte = source[position++];
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+}
+
+namespace GE::Util
+{
+	size_t lz4CompressBound(size_t size) { return size + size / 255 + 16; }
+
+	std::vector<char> lz4Compress(const char* source, size_t sourceSize)
+	{
+		std::vector<char> output;
+		output.reserve(lz4CompressBound(sourceSize));
+
+		size_t anchor = 0;
+		if (sourceSize > MatchFindLimit) {
+			// Positions are stored plus one so zero means empty
+			std::vector<uint32_t> table(size_t(1) << HashBits, 0);
+			size_t position = 0;
+			while (position + MatchFindLimit <= sourceSize) {
+				const uint32_t sequence = read32(source + position);
+				uint32_t& slot = table[hashOf(sequence)];
+				const size_t candidate = slot;
+				slot = static_cast<uint32_t>(position + 1);
+
+				if (candidate == 0 || position - (candidate - 1) > MaxOffset || read32(source + candidate - 1) != sequence) { position++; continue; }
+
+				const size_t reference = candidate - 1;
+				size_t matchLength = MinMatch;
+				while (position + matchLength < sourceSize - LastLiterals && source[reference + matchLength] == source[position + matchLength]) matchLength++;
+
+				writeSequence(output, source + anchor, position - anchor, position - reference, matchLength);
+				position += matchLength;
+				anchor = position;
+			}
+		}
+		writeSequence(output, source + anchor, sourceSize - anchor, 0, 0);
+		return output;
+	}
+
+	bool lz4Decompress(const char* source, size_t sourceSize, char* destination, size_t destinationSize)
+	{
+		const auto* input = reinterpret_cast<const uint8_t*>(source);
+		size_t in = 0;
+		size_t out = 0;
+		while (in < sourceSize) {
+			const uint8_t token = input[in++];
+
+			size_t literalCount = token >> 4;
+			if (literalCount == 15 && !readLength(input, sourceSize, in, literalCount)) return false;
+			if (literalCount > sourceSize - in || literalCount > destinationSize - out) return false;
+			std::memcpy(destination + out, source + in, literalCount);
+			in += literalCount;
+			out += literalCount;
+			if (in == sourceSize) break; // last sequence is literals only
+
+			if (sourceSize - in < 2) return false;
+			const size_t offset = input[in] | (static_cast<size_t>(input[in + 1]) << 8);
+			in += 2;
+			if (offset == 0 || offset > out) return false;
+
+			size_t matchLength = token & 15;
+			if (matchLength == 15 && !readLength(input, sourceSize, in, matchLength)) return false;
+			matchLength += MinMatch;
+			if (matchLength > destinationSize - out) return false;
+			// Byte by byte, the match may overlap the bytes it is producing
+			for (size_t i = 0; i < matchLength; i++, out++) destination[out] = destination[out - offset];
+		}
+		return out == destinationSize;
+	}
+}
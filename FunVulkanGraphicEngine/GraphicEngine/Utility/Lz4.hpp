@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace GE::Util
+{
+	// In-tree LZ4 block format (no frame header, no checksums). The sizes are kept by whoever stores the block.
+	// Compression is the greedy single probe variant, decompression checks every read and write against the buffers.
+
+	/// @brief Worst case size of a compressed block
+	size_t lz4CompressBound(size_t size);
+	std::vector<char> lz4Compress(const char* source, size_t sourceSize);
+	/// @brief Returns false on corrupt input or when the output does not fill exactly destinationSize bytes
+	bool lz4Decompress(const char* source, size_t sourceSize, char* destination, size_t destinationSize);
+}
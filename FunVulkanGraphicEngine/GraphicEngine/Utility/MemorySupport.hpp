@@ -4,11 +4,13 @@
 
 namespace GE::Util
 {
-	void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue);
+	/// @brief More than one of queueFamilies shares the buffer between them without ownership transfers
+	std::string createBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory, const std::vector<uint32_t>& queueFamilies = {});
+	/// @brief A primary command buffer from commandPool, already begun for one submission. GraphicsUploadBatch submits it behind a fence
 	VkCommandBuffer beginSingleTimeCommands(VkDevice device, VkCommandPool commandPool);
-	void endSingleTimeCommands(VkCommandBuffer commandBuffer, VkDevice device, VkCommandPool commandPool, VkQueue graphicsQueue);
 
-	VkImageView CreateImageView(VkDevice, VkImage, VkFormat, VkImageAspectFlags, uint32_t);
+	/// @brief components swizzles what the shaders read, identity by default. The view covers mipLevels levels from baseMipLevel on
+	VkImageView CreateImageView(VkDevice, VkImage, VkFormat, VkImageAspectFlags, uint32_t, VkComponentMapping components = {}, uint32_t baseMipLevel = 0);
 
 	std::string createImage(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
 }
\ No newline at end of file
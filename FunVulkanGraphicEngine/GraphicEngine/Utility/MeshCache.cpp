@@ -0,0 +1,144 @@
+#include "GraphicEngine/Utility/MeshCache.hpp"
+#include "GraphicEngine/Utility/AssetPack.hpp"
+#include "GraphicEngine/Utility/Hashing.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+	constexpr uint64_t BlobAlignment = 16;
+
+	uint64_t alignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+}
+
+namespace GE::Util
+{
+	MeshCache::MeshCache() = default;
+	MeshCache::~MeshCache() = default;
+
+	std::string MeshCache::cachePathFor(std::string_view sourcePath)
+	{
+		return std::string(sourcePath) + Extension;
+	}
+
+	bool MeshCache::open(std::string_view sourcePath)
+	{
+		close();
+		const std::string cachePath = cachePathFor(sourcePath);
+
+		std::error_code errorCode;
+		if (!assetExists(cachePath)) { currentError = "no cache for " + std::string(sourcePath); return false; }
+
+		// Source could be missing when only the cache was shipped, in that case the cache is all we have
+		std::uintmax_t sourceSize = 0;
+		const bool hasSource = std::filesystem::exists(sourcePath, errorCode);
+		if (hasSource) sourceSize = std::filesystem::file_size(sourcePath, errorCode);
+
+		if (!file.open(cachePath)) { currentError = std::string(file.getError()); return false; }
+
+		if (file.size() < sizeof(MeshCacheHeader)) { currentError = "cache header is truncated"; close(); return false; }
+		const auto* candidate = reinterpret_cast<const MeshCacheHeader*>(file.data());
+		if (candidate->magic != Magic || candidate->version != Version) { currentError = "cache was written by another version"; close(); return false; }
+		if (candidate->vertexStride != sizeof(Vertex) || candidate->indexStride != sizeof(uint32_t)) { currentError = "cache vertex layout does not match"; close(); return false; }
+		if (hasSource && candidate->sourceSize != sourceSize) { currentError = "cache belongs to a different source file"; close(); return false; }
+		if (hasSource) {
+			// Modification times say nothing, copying the assets around refreshes them. Hashing the source is still far
+			// cheaper than parsing it
+			MappedFile source;
+			if (!source.open(std::string(sourcePath))) { currentError = std::string(source.getError()); close(); return false; }
+			if (hashBytes(source.data(), source.size()) != candidate->contentHash) { currentError = "cache was written for an older " + std::string(sourcePath); close(); return false; }
+		}
+
+		const uint64_t vertexEnd = candidate->vertexOffset + candidate->vertexCount * candidate->vertexStride;
+		const uint64_t indexEnd = candidate->indexOffset + candidate->indexCount * candidate->indexStride;
+		const uint64_t lodEnd = candidate->lodOffset + candidate->lodCount * sizeof(MeshLod);
+		const uint64_t clusterEnd = candidate->clusterOffset + candidate->clusterCount * sizeof(MeshCluster);
+		if (vertexEnd > file.size() || indexEnd > file.size() || lodEnd > file.size() || clusterEnd > file.size()) { currentError = "cache blobs are truncated"; close(); return false; }
+		const auto* lodTable = reinterpret_cast<const MeshLod*>(file.data() + candidate->lodOffset);
+		for (uint64_t i = 0; i < candidate->lodCount; i++) {
+			if (static_cast<uint64_t>(lodTable[i].firstIndex) + lodTable[i].indexCount > candidate->indexCount) { currentError = "cache lod range is out of bounds"; close(); return false; }
+		}
+		const auto* clusterTable = reinterpret_cast<const MeshCluster*>(file.data() + candidate->clusterOffset);
+		for (uint64_t i = 0; i < candidate->clusterCount; i++) {
+			if (static_cast<uint64_t>(clusterTable[i].firstIndex) + clusterTable[i].indexCount > candidate->indexCount) { currentError = "cache cluster range is out of bounds"; close(); return false; }
+		}
+		// The indices go to the GPU as they are, one past the vertices would read outside the vertex buffer there
+		const auto* indexBlob = reinterpret_cast<const uint32_t*>(file.data() + candidate->indexOffset);
+		uint32_t maxIndex = 0;
+		for (uint64_t i = 0; i < candidate->indexCount; i++) maxIndex = std::max(maxIndex, indexBlob[i]);
+		if (candidate->indexCount > 0 && maxIndex >= candidate->vertexCount) { currentError = "cache index " + std::to_string(maxIndex) + " is past the " + std::to_string(candidate->vertexCount) + " vertices"; close(); return false; }
+
+		header = candidate;
+		return true;
+	}
+
+	void MeshCache::close()
+	{
+		header = nullptr;
+		file.close();
+	}
+
+	const Vertex* MeshCache::vertices() const { return reinterpret_cast<const Vertex*>(file.data() + header->vertexOffset); }
+	size_t MeshCache::vertexCount() const { return header == nullptr ? 0 : static_cast<size_t>(header->vertexCount); }
+	const uint32_t* MeshCache::indices() const { return reinterpret_cast<const uint32_t*>(file.data() + header->indexOffset); }
+	size_t MeshCache::indexCount() const { return header == nullptr ? 0 : static_cast<size_t>(header->indexCount); }
+	const MeshLod* MeshCache::lods() const { return reinterpret_cast<const MeshLod*>(file.data() + header->lodOffset); }
+	size_t MeshCache::lodCount() const { return header == nullptr ? 0 : static_cast<size_t>(header->lodCount); }
+	const MeshCluster* MeshCache::clusters() const { return reinterpret_cast<const MeshCluster*>(file.data() + header->clusterOffset); }
+	size_t MeshCache::clusterCount() const { return header == nullptr ? 0 : static_cast<size_t>(header->clusterCount); }
+	uint64_t MeshCache::contentHash() const { return header == nullptr ? 0 : header->contentHash; }
+	std::string_view MeshCache::getError() const { return currentError; }
+
+	ErrorMessage MeshCache::write(std::string_view sourcePath, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshLod>& lods, const std::vector<MeshCluster>& clusters, std::string_view cachePath)
+	{
+		MappedFile source;
+		if (!source.open(std::string(sourcePath))) { return std::string(source.getError()); }
+
+		MeshCacheHeader header{};
+		header.magic = Magic;
+		header.version = Version;
+		header.vertexStride = sizeof(Vertex);
+		header.indexStride = sizeof(uint32_t);
+		header.vertexCount = vertices.size();
+		header.indexCount = indices.size();
+		header.vertexOffset = alignUp(sizeof(MeshCacheHeader), BlobAlignment);
+		header.indexOffset = alignUp(header.vertexOffset + vertices.size() * sizeof(Vertex), BlobAlignment);
+		header.lodCount = lods.size();
+		header.lodOffset = alignUp(header.indexOffset + indices.size() * sizeof(uint32_t), BlobAlignment);
+		header.clusterCount = clusters.size();
+		header.clusterOffset = alignUp(header.lodOffset + lods.size() * sizeof(MeshLod), BlobAlignment);
+		header.sourceSize = source.size();
+		header.contentHash = hashBytes(source.data(), source.size());
+		source.close();
+
+		// Write next to the real file and swap it in, so a crash never leaves a half written cache behind
+		const std::string destination = cachePath.empty() ? cachePathFor(sourcePath) : std::string(cachePath);
+		const std::string temporaryPath = destination + ".tmp";
+		{
+			std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+			if (!output.is_open()) { return "failed to create " + temporaryPath; }
+
+			const char padding[BlobAlignment]{};
+			output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			output.write(padding, header.vertexOffset - sizeof(header));
+			output.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(Vertex));
+			output.write(padding, header.indexOffset - (header.vertexOffset + vertices.size() * sizeof(Vertex)));
+			output.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(uint32_t));
+			output.write(padding, header.lodOffset - (header.indexOffset + indices.size() * sizeof(uint32_t)));
+			output.write(reinterpret_cast<const char*>(lods.data()), lods.size() * sizeof(MeshLod));
+			output.write(padding, header.clusterOffset - (header.lodOffset + lods.size() * sizeof(MeshLod)));
+			output.write(reinterpret_cast<const char*>(clusters.data()), clusters.size() * sizeof(MeshCluster));
+			if (!output.good()) { return "failed to write " + temporaryPath; }
+		}
+
+		std::error_code errorCode;
+		std::filesystem::rename(temporaryPath, destination, errorCode);
+		if (errorCode) {
+			std::filesystem::remove(temporaryPath, errorCode);
+			return "failed to replace " + destination;
+		}
+		return "";
+	}
+}
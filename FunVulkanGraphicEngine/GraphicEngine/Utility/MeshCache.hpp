@@ -0,0 +1,74 @@
+#pragma once
+
+#include "GraphicEngine/GraphicsVertex.hpp"
+#include "GraphicEngine/Utility/FileMapping.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace GE::Util
+{
+	// Layout of a mesh cache file
+	// [MeshCacheHeader][Vertex blob][uint32_t index blob][MeshLod table][MeshCluster table]
+	// Blobs are stored exactly like they are uploaded, so the mapped file can be copied directly into staging memory
+	struct MeshCacheHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t vertexStride;
+		uint32_t indexStride;
+		uint64_t vertexCount;
+		uint64_t indexCount;
+		uint64_t vertexOffset;
+		uint64_t indexOffset;
+		uint64_t sourceSize;
+		uint64_t contentHash; // hash of the source file bytes
+		uint64_t lodCount;
+		uint64_t lodOffset;
+		uint64_t clusterCount;
+		uint64_t clusterOffset;
+	};
+
+	/// @brief Binary copy of a parsed mesh, written next to its source file on first load.
+	/// Later loads map the file instead of parsing the text format again
+	class MeshCache
+	{
+	public:
+		static constexpr uint32_t Magic = 0x434d4547; // "GEMC" in little endian
+		static constexpr uint32_t Version = 4; // 2: meshes are stored after the mesh optimizer ran, 3: lod table, 4: cluster table
+		static constexpr const char* Extension = ".meshcache";
+
+		MeshCache();
+		~MeshCache();
+
+		static std::string cachePathFor(std::string_view sourcePath);
+
+		/// @brief Maps the cache of sourcePath. Fails if there is none, it was written for other source contents or by another version
+		bool open(std::string_view sourcePath);
+		void close();
+
+		const Vertex* vertices() const;
+		size_t vertexCount() const;
+		const uint32_t* indices() const;
+		size_t indexCount() const;
+		/// @brief Ranges into indices(), finest first
+		const MeshLod* lods() const;
+		size_t lodCount() const;
+		/// @brief Clusters of every level, sorted by firstIndex
+		const MeshCluster* clusters() const;
+		size_t clusterCount() const;
+		uint64_t contentHash() const;
+
+		std::string_view getError() const;
+
+		/// @brief Writes a fresh cache for sourcePath, next to it unless cachePath says otherwise. Returns an empty string on success
+		static ErrorMessage write(std::string_view sourcePath, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshLod>& lods = {}, const std::vector<MeshCluster>& clusters = {}, std::string_view cachePath = {});
+
+	private:
+		MappedFile file;
+		const MeshCacheHeader* header{ nullptr };
+		std::string currentError;
+	};
+}
@@ -0,0 +1,119 @@
+#include "GraphicEngine/Utility/MeshClusters.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	/// @brief Bounding sphere and normal cone of the triangles in indices [first, first + count)
+	GE::MeshCluster boundCluster(const std::vector<GE::Vertex>& vertices, const std::vector<uint32_t>& indices, uint32_t first, uint32_t count)
+	{
+		GE::MeshCluster cluster{ first, count };
+
+		glm::vec3 minimum = vertices[indices[first]].pos;
+		glm::vec3 maximum = minimum;
+		for (uint32_t i = first; i < first + count; i++) {
+			minimum = glm::min(minimum, vertices[indices[i]].pos);
+			maximum = glm::max(maximum, vertices[indices[i]].pos);
+		}
+		cluster.center = (minimum + maximum) * 0.5f;
+		cluster.radius = 0.0f;
+		for (uint32_t i = first; i < first + count; i++) cluster.radius = std::max(cluster.radius, glm::length(vertices[indices[i]].pos - cluster.center));
+
+		// The axis averages the unit normals, the cutoff follows from the normal furthest from it
+		std::vector<glm::vec3> normals;
+		normals.reserve(count / 3);
+		glm::vec3 axis(0.0f);
+		for (uint32_t i = first; i + 2 < first + count; i += 3) {
+			const glm::vec3& a = vertices[indices[i]].pos;
+			const glm::vec3 normal = glm::cross(vertices[indices[i + 1]].pos - a, vertices[indices[i + 2]].pos - a);
+			const float area = glm::length(normal);
+			if (area <= 0.0f) continue; // degenerate triangles face nowhere
+			normals.push_back(normal / area);
+			axis += normals.back();
+		}
+		cluster.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+		cluster.coneCutoff = 1.0f;
+		const float axisLength = glm::length(axis);
+		if (normals.empty() || axisLength <= 1e-6f) return cluster;
+		axis /= axisLength;
+
+		float minimumDot = 1.0f;
+		for (const auto& normal : normals) minimumDot = std::min(minimumDot, glm::dot(axis, normal));
+		cluster.coneAxis = axis;
+		// A cone wider than a half space can not be behind every view direction
+		if (minimumDot > 0.0f) cluster.coneCutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+		return cluster;
+	}
+
+	void clusterLevel(const std::vector<GE::Vertex>& vertices, const std::vector<uint32_t>& indices, uint32_t first, uint32_t count, uint32_t maxVertices, uint32_t maxTriangles,
+		std::vector<uint32_t>& vertexStamp, uint32_t& stamp, std::vector<GE::MeshCluster>& clusters)
+	{
+		uint32_t clusterFirst = first;
+		uint32_t clusterVertices = 0;
+		stamp++;
+		for (uint32_t triangle = first; triangle + 2 < first + count; triangle += 3) {
+			uint32_t added = 0;
+			for (uint32_t corner = 0; corner < 3; corner++) added += vertexStamp[indices[triangle + corner]] == stamp ? 0 : 1;
+
+			const uint32_t clusterTriangles = (triangle - clusterFirst) / 3;
+			if (clusterTriangles > 0 && (clusterVertices + added > maxVertices || clusterTriangles + 1 > maxTriangles)) {
+				clusters.push_back(boundCluster(vertices, indices, clusterFirst, triangle - clusterFirst));
+				clusterFirst = triangle;
+				clusterVertices = 0;
+				stamp++;
+			}
+			for (uint32_t corner = 0; corner < 3; corner++) {
+				uint32_t& mark = vertexStamp[indices[triangle + corner]];
+				if (mark != stamp) { mark = stamp; clusterVertices++; }
+			}
+		}
+		const uint32_t end = first + count / 3 * 3;
+		if (end > clusterFirst) clusters.push_back(boundCluster(vertices, indices, clusterFirst, end - clusterFirst));
+	}
+}
+
+namespace GE::Util
+{
+	std::vector<MeshCluster> buildClusters(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshLod>& lods, uint32_t maxVertices, uint32_t maxTriangles)
+	{
+		std::vector<MeshCluster> clusters;
+		if (vertices.empty() || indices.size() < 3 || maxVertices < 3 || maxTriangles == 0) return clusters;
+
+		// Stamped with the current cluster's number instead of cleared for every cluster
+		std::vector<uint32_t> vertexStamp(vertices.size(), 0);
+		uint32_t stamp = 0;
+		if (lods.empty()) clusterLevel(vertices, indices, 0, static_cast<uint32_t>(indices.size()), maxVertices, maxTriangles, vertexStamp, stamp, clusters);
+		for (const auto& lod : lods) clusterLevel(vertices, indices, lod.firstIndex, lod.indexCount, maxVertices, maxTriangles, vertexStamp, stamp, clusters);
+
+		std::sort(clusters.begin(), clusters.end(), [](const MeshCluster& a, const MeshCluster& b) { return a.firstIndex < b.firstIndex; });
+		return clusters;
+	}
+
+	ClusterCuller::ClusterCuller(const glm::mat4& modelViewProj, const glm::mat4& modelView)
+	{
+		// Planes straight from the rows of the matrix (Gribb and Hartmann), vulkan clip space has 0 <= z <= w
+		const glm::mat4 rows = glm::transpose(modelViewProj);
+		planes = { rows[3] + rows[0], rows[3] - rows[0], rows[3] + rows[1], rows[3] - rows[1], rows[2], rows[3] - rows[2] };
+		for (auto& plane : planes) {
+			const float length = glm::length(glm::vec3(plane));
+			if (length > 0.0f) plane = plane / length;
+		}
+		camera = glm::vec3(glm::inverse(modelView) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	}
+
+	bool ClusterCuller::sphereVisible(const glm::vec3& center, float radius) const
+	{
+		for (const auto& plane : planes) {
+			if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+		}
+		return true;
+	}
+
+	bool ClusterCuller::backFacing(const MeshCluster& cluster) const
+	{
+		// Conservative for the whole sphere, the view direction to any point of it is within the cutoff
+		const glm::vec3 toCenter = cluster.center - camera;
+		return glm::dot(toCenter, cluster.coneAxis) >= cluster.coneCutoff * glm::length(toCenter) + cluster.radius;
+	}
+}
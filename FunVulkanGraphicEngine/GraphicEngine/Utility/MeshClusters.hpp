@@ -0,0 +1,33 @@
+#pragma once
+
+#include "GraphicEngine/GraphicsVertex.hpp"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace GE::Util
+{
+	/// @brief Splits every level of a mesh into clusters of at most maxVertices distinct vertices and maxTriangles triangles.
+	/// Triangles are taken in index order, which the mesh optimizer left spatially coherent, so a cluster is always a
+	/// contiguous range of its level and the index buffer stays as it is. lods empty means indices is a single level
+	std::vector<MeshCluster> buildClusters(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<MeshLod>& lods,
+		uint32_t maxVertices = MESH_CLUSTER_MAX_VERTICES, uint32_t maxTriangles = MESH_CLUSTER_MAX_TRIANGLES);
+
+	/// @brief Frustum and back face tests of model space bounds against one object's camera
+	class ClusterCuller
+	{
+	public:
+		/// @brief modelViewProj takes model space to clip space, modelView to view space. Both without dequantizing
+		ClusterCuller(const glm::mat4& modelViewProj, const glm::mat4& modelView);
+
+		/// @brief False when the sphere lies entirely outside one of the frustum planes
+		bool sphereVisible(const glm::vec3& center, float radius) const;
+		/// @brief True when every triangle of cluster faces away from the camera, the rasterizer would cull them all
+		bool backFacing(const MeshCluster& cluster) const;
+
+	private:
+		std::array<glm::vec4, 6> planes; // xyz inward normal, w distance, normalized in model space
+		glm::vec3 camera; // in model space
+	};
+}
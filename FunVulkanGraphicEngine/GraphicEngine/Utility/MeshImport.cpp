@@ -0,0 +1,90 @@
+#include "GraphicEngine/Utility/MeshImport.hpp"
+#include "GraphicEngine/Utility/MeshClusters.hpp"
+#include "GraphicEngine/Utility/MeshOptimizer.hpp"
+#include "GraphicEngine/Utility/MeshSimplifier.hpp"
+#include "GraphicEngine/Utility/ObjReader.hpp"
+#include "GraphicEngine/Utility/VertexWelder.hpp"
+
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+	std::string loadObjFile(std::string_view filePath, std::vector<GE::Vertex>& vertices, std::vector<uint32_t>& indices, unsigned threadCount)
+	{
+		const auto parseStart = std::chrono::steady_clock::now();
+
+		GE::Util::ObjMesh mesh;
+		if (auto errorMessage = GE::Util::readObj(std::string(filePath), mesh, threadCount); !errorMessage.empty()) { return std::string(filePath) + ": " + errorMessage; }
+
+		const auto dedupeStart = std::chrono::steady_clock::now();
+		std::vector<GE::Vertex> corners(mesh.corners.size());
+
+		for (size_t i = 0; i < corners.size(); i++) {
+			const auto& corner = mesh.corners[i];
+			GE::Vertex& vertex = corners[i];
+
+			vertex.pos = {
+				mesh.positions[3 * corner.position + 0],
+				mesh.positions[3 * corner.position + 1],
+				mesh.positions[3 * corner.position + 2]
+			};
+
+			// Obj has the origin of the image at the bottom, vulkan at the top
+			if (corner.texcoord >= 0) {
+				vertex.texCoord = {
+					mesh.texcoords[2 * corner.texcoord + 0],
+					1.0f - mesh.texcoords[2 * corner.texcoord + 1]
+				};
+			}
+
+			vertex.color = { 1.0f, 1.0f, 1.0f };
+		}
+
+		GE::Util::weldVertices(corners, vertices, indices, threadCount);
+
+		const auto end = std::chrono::steady_clock::now();
+		if constexpr (GE::PRINT_ENGINE_STATS) std::cout << "Parsed " << filePath << " (" << mesh.corners.size() / 3 << " triangles) parse: "
+			<< std::chrono::duration<double, std::milli>(dedupeStart - parseStart).count() << " ms, dedupe: "
+			<< std::chrono::duration<double, std::milli>(end - dedupeStart).count() << " ms" << std::endl;
+		return "";
+	}
+}
+
+namespace GE::Util
+{
+	ErrorMessage importObjMesh(const std::string& filePath, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<MeshLod>& lods, std::vector<MeshCluster>& clusters, unsigned threadCount)
+	{
+		vertices.clear();
+		indices.clear();
+		lods.clear();
+		clusters.clear();
+		if (auto errorMessage = loadObjFile(filePath, vertices, indices, threadCount); !errorMessage.empty()) return errorMessage;
+
+		// Done once here, the cache stores the optimized order
+		if constexpr (OPTIMIZE_IMPORTED_MESHES) {
+			const auto optimizeStart = std::chrono::steady_clock::now();
+			const auto report = optimizeMesh(vertices, indices);
+			if constexpr (PRINT_ENGINE_STATS) std::cout << "Optimized " << filePath << " in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - optimizeStart).count()
+				<< " ms. ACMR " << report.before.acmr << " -> " << report.after.acmr << ", ATVR " << report.before.atvr << " -> " << report.after.atvr << std::endl;
+		}
+
+		// The simplified levels go behind the full one in the same index buffer
+		if constexpr (MESH_LOD_LEVELS > 0) {
+			const auto simplifyStart = std::chrono::steady_clock::now();
+			const size_t fullIndexCount = indices.size();
+			lods = buildLodChain(vertices, indices, MESH_LOD_LEVELS);
+			if constexpr (PRINT_ENGINE_STATS) {
+				std::cout << "Built " << lods.size() - 1 << " LODs for " << filePath << " in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - simplifyStart).count() << " ms. Triangles";
+				for (const auto& lod : lods) std::cout << " " << lod.indexCount / 3;
+				std::cout << " of " << fullIndexCount / 3 << std::endl;
+			}
+		}
+
+		// Last, the clusters are ranges of the final index order
+		const auto clusterStart = std::chrono::steady_clock::now();
+		clusters = buildClusters(vertices, indices, lods);
+		if constexpr (PRINT_ENGINE_STATS) std::cout << "Split " << filePath << " into " << clusters.size() << " clusters in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - clusterStart).count() << " ms" << std::endl;
+		return "";
+	}
+}
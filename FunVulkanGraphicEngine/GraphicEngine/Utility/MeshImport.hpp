@@ -0,0 +1,15 @@
+#pragma once
+
+#include "GraphicEngine/GraphicsVertex.hpp"
+
+#include <string>
+#include <vector>
+
+namespace GE::Util
+{
+	/// @brief Everything an OBJ goes through before it is cached or uploaded: parse, weld, the mesh optimizer when
+	/// OPTIMIZE_IMPORTED_MESHES is on, MESH_LOD_LEVELS simplified levels appended to indices and the clusters of every level.
+	/// Shared by the runtime fallback and the offline cooker so both produce the same cache.
+	/// threadCount is passed on to parsing and welding, 0 picks one from the hardware and the file size
+	ErrorMessage importObjMesh(const std::string& filePath, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<MeshLod>& lods, std::vector<MeshCluster>& clusters, unsigned threadCount = 0);
+}
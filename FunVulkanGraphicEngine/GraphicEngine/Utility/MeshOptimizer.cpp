@@ -0,0 +1,254 @@
+#include "GraphicEngine/Utility/MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// FIFO post transform cache. A vertex is cached while fewer than size misses happened since it was inserted
+	class FifoCache
+	{
+	public:
+		FifoCache(size_t vertexCount, uint32_t size) : insertedAt(vertexCount, 0), clock(size + 1), size(size) {}
+
+		/// @brief Returns true on a miss
+		bool touch(uint32_t vertex)
+		{
+			if (clock - insertedAt[vertex] <= size) return false;
+			insertedAt[vertex] = clock++;
+			return true;
+		}
+
+		uint32_t touchTriangle(const uint32_t* triangle) { return touch(triangle[0]) + touch(triangle[1]) + touch(triangle[2]); }
+
+		void reset() { clock += size + 1; }
+
+	private:
+		std::vector<uint32_t> insertedAt;
+		uint32_t clock;
+		uint32_t size;
+	};
+
+	// Triangles using each vertex, as one flat array plus offsets
+	struct VertexAdjacency
+	{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> triangles;
+
+		VertexAdjacency(const std::vector<uint32_t>& indices, size_t vertexCount) : offsets(vertexCount + 1, 0), triangles(indices.size())
+		{
+			for (uint32_t index : indices) offsets[index + 1]++;
+			for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+
+			std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); i++) triangles[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	};
+
+	glm::vec3 triangleNormal(const std::vector<GE::Vertex>& vertices, const uint32_t* triangle)
+	{
+		// Length is twice the area, which weights the sums below by area
+		return glm::cross(vertices[triangle[1]].pos - vertices[triangle[0]].pos, vertices[triangle[2]].pos - vertices[triangle[0]].pos);
+	}
+
+	glm::vec3 triangleCenter(const std::vector<GE::Vertex>& vertices, const uint32_t* triangle)
+	{
+		return (vertices[triangle[0]].pos + vertices[triangle[1]].pos + vertices[triangle[2]].pos) / 3.0f;
+	}
+}
+
+namespace GE::Util
+{
+	VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+	{
+		VertexCacheStats stats;
+		if (indices.size() < 3 || vertexCount == 0) return stats;
+
+		FifoCache cache(vertexCount, cacheSize);
+		std::vector<bool> referenced(vertexCount, false);
+		size_t referencedCount = 0;
+		size_t misses = 0;
+		for (uint32_t index : indices) {
+			misses += cache.touch(index);
+			if (!referenced[index]) { referenced[index] = true; referencedCount++; }
+		}
+
+		stats.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+		stats.atvr = static_cast<float>(misses) / static_cast<float>(referencedCount);
+		return stats;
+	}
+
+	void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize, std::vector<uint32_t>* clusters)
+	{
+		const size_t triangleCount = indices.size() / 3;
+		if (clusters != nullptr) clusters->assign(1, 0);
+		if (triangleCount == 0 || vertexCount == 0) return;
+
+		const VertexAdjacency adjacency(indices, vertexCount);
+		std::vector<uint32_t> liveTriangles(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++) liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+		std::vector<uint32_t> cacheTime(vertexCount, 0);
+		std::vector<bool> emitted(triangleCount, false);
+		std::vector<uint32_t> deadEnds;
+		std::vector<uint32_t> candidates;
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+
+		uint32_t time = cacheSize + 1;
+		size_t scanCursor = 0;
+		int64_t fanning = indices[0];
+
+		while (fanning >= 0) {
+			// Emit every triangle around the fanning vertex that is still left
+			candidates.clear();
+			for (uint32_t i = adjacency.offsets[fanning]; i < adjacency.offsets[fanning + 1]; i++) {
+				const uint32_t triangle = adjacency.triangles[i];
+				if (emitted[triangle]) continue;
+				emitted[triangle] = true;
+
+				for (int corner = 0; corner < 3; corner++) {
+					const uint32_t vertex = indices[triangle * 3 + corner];
+					result.push_back(vertex);
+					deadEnds.push_back(vertex);
+					candidates.push_back(vertex);
+					liveTriangles[vertex]--;
+					if (time - cacheTime[vertex] > cacheSize) cacheTime[vertex] = time++;
+				}
+			}
+
+			// Next fanning vertex is the one of the new triangles that stays in the cache longest,
+			// as long as its remaining triangles still fit before it gets evicted
+			fanning = -1;
+			int64_t bestPriority = -1;
+			for (uint32_t vertex : candidates) {
+				if (liveTriangles[vertex] == 0) continue;
+				int64_t priority = 0;
+				if (time - cacheTime[vertex] + 2 * liveTriangles[vertex] <= cacheSize) priority = time - cacheTime[vertex];
+				if (priority > bestPriority) { bestPriority = priority; fanning = vertex; }
+			}
+			if (fanning >= 0) continue;
+
+			// Dead end. Go back to recently used vertices first, then just scan for anything left
+			while (!deadEnds.empty() && fanning < 0) {
+				const uint32_t vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveTriangles[vertex] > 0) fanning = vertex;
+			}
+			while (fanning < 0 && scanCursor < vertexCount) {
+				if (liveTriangles[scanCursor] > 0) fanning = static_cast<int64_t>(scanCursor);
+				scanCursor++;
+			}
+			if (fanning >= 0 && clusters != nullptr) clusters->push_back(static_cast<uint32_t>(result.size() / 3));
+		}
+
+		indices.swap(result);
+	}
+
+	void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& clusters, float threshold, uint32_t cacheSize)
+	{
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0 || clusters.empty()) return;
+
+		// Split the dead end clusters further wherever a run already has a good miss ratio on its own,
+		// more and smaller clusters give the sort below more freedom
+		FifoCache cache(vertices.size(), cacheSize);
+		std::vector<uint32_t> softClusters;
+		for (size_t c = 0; c < clusters.size(); c++) {
+			const uint32_t begin = clusters[c];
+			const uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : static_cast<uint32_t>(triangleCount);
+
+			cache.reset();
+			uint32_t clusterMisses = 0;
+			for (uint32_t t = begin; t < end; t++) clusterMisses += cache.touchTriangle(&indices[t * 3]);
+			const float clusterRatio = static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+			cache.reset();
+			softClusters.push_back(begin);
+			uint32_t runStart = begin;
+			uint32_t runMisses = 0;
+			for (uint32_t t = begin; t < end; t++) {
+				runMisses += cache.touchTriangle(&indices[t * 3]);
+				if (t + 1 < end && static_cast<float>(runMisses) <= threshold * clusterRatio * static_cast<float>(t + 1 - runStart)) {
+					softClusters.push_back(t + 1);
+					runStart = t + 1;
+					runMisses = 0;
+					cache.reset();
+				}
+			}
+		}
+
+		glm::vec3 meshCenter(0.0f);
+		float meshArea = 0.0f;
+		for (size_t t = 0; t < triangleCount; t++) {
+			const float area = glm::length(triangleNormal(vertices, &indices[t * 3]));
+			meshCenter += triangleCenter(vertices, &indices[t * 3]) * area;
+			meshArea += area;
+		}
+		if (meshArea > 0.0f) meshCenter /= meshArea;
+
+		// Clusters facing away from the center are on the outside, drawing them first hides the inner ones
+		struct ClusterOrder
+		{
+			uint32_t begin;
+			uint32_t end;
+			float facing;
+		};
+		std::vector<ClusterOrder> order(softClusters.size());
+		for (size_t c = 0; c < softClusters.size(); c++) {
+			ClusterOrder& cluster = order[c];
+			cluster.begin = softClusters[c];
+			cluster.end = c + 1 < softClusters.size() ? softClusters[c + 1] : static_cast<uint32_t>(triangleCount);
+
+			glm::vec3 center(0.0f);
+			glm::vec3 normal(0.0f);
+			float area = 0.0f;
+			for (uint32_t t = cluster.begin; t < cluster.end; t++) {
+				const glm::vec3 faceNormal = triangleNormal(vertices, &indices[t * 3]);
+				const float faceArea = glm::length(faceNormal);
+				center += triangleCenter(vertices, &indices[t * 3]) * faceArea;
+				normal += faceNormal;
+				area += faceArea;
+			}
+			const float normalLength = glm::length(normal);
+			cluster.facing = (area > 0.0f && normalLength > 0.0f) ? glm::dot(center / area - meshCenter, normal / normalLength) : 0.0f;
+		}
+		std::stable_sort(order.begin(), order.end(), [](const ClusterOrder& a, const ClusterOrder& b) { return a.facing > b.facing; });
+
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		for (const auto& cluster : order) result.insert(result.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+		indices.swap(result);
+	}
+
+	void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		constexpr uint32_t Unassigned = UINT32_MAX;
+		std::vector<uint32_t> remap(vertices.size(), Unassigned);
+		std::vector<Vertex> ordered;
+		ordered.reserve(vertices.size());
+
+		for (uint32_t& index : indices) {
+			if (remap[index] == Unassigned) {
+				remap[index] = static_cast<uint32_t>(ordered.size());
+				ordered.push_back(vertices[index]);
+			}
+			index = remap[index];
+		}
+		vertices.swap(ordered);
+	}
+
+	MeshOptimizeReport optimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		MeshOptimizeReport report;
+		report.before = analyzeVertexCache(indices, vertices.size());
+
+		std::vector<uint32_t> clusters;
+		optimizeVertexCache(indices, vertices.size(), 16, &clusters);
+		optimizeOverdraw(indices, vertices, clusters);
+		optimizeVertexFetch(vertices, indices);
+
+		report.after = analyzeVertexCache(indices, vertices.size());
+		return report;
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "GraphicEngine/GraphicsVertex.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace GE::Util
+{
+	/// @brief Post transform cache behaviour of an index buffer, measured with a FIFO cache simulation
+	struct VertexCacheStats
+	{
+		float acmr{ 0.0f }; // average cache miss ratio, vertex shader runs per triangle. 0.5 is the floor, 3 is the worst
+		float atvr{ 0.0f }; // average transformed vertex ratio, vertex shader runs per vertex. 1 is perfect
+	};
+
+	/// @brief Simulates a FIFO post transform cache of cacheSize entries over indices
+	VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+	/// @brief Reorders the triangles for the post transform cache (Tipsify, Sander et al. 2007).
+	/// When clusters is given it receives the first triangle of every run that started from a dead end,
+	/// those runs can be reordered freely without hurting the cache much
+	void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = 16, std::vector<uint32_t>* clusters = nullptr);
+
+	/// @brief Reorders the clusters of a cache optimized index buffer so triangles facing away from the mesh center are
+	/// drawn first, which lets early depth testing reject more of what comes after. Clusters are split further as long as
+	/// their own ACMR stays within threshold times the ACMR of the cluster they came from
+	void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& clusters, float threshold = 1.05f, uint32_t cacheSize = 16);
+
+	/// @brief Sorts the vertices in the order the index buffer first references them and rewrites the indices.
+	/// Unreferenced vertices are dropped
+	void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+	struct MeshOptimizeReport
+	{
+		VertexCacheStats before;
+		VertexCacheStats after;
+	};
+
+	/// @brief Runs the cache, overdraw and fetch passes in that order and measures the cache before and after
+	MeshOptimizeReport optimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+}
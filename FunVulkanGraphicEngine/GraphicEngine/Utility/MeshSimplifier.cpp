@@ -0,0 +1,297 @@
+#include "GraphicEngine/Utility/MeshSimplifier.hpp"
+#include "GraphicEngine/Utility/MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <unordered_set>
+
+namespace
+{
+	constexpr uint32_t NoVertex = UINT32_MAX;
+
+	// Open border edges get a plane perpendicular to their face with this much weight, so the outline resists moving
+	constexpr double BorderWeight = 10.0;
+
+	struct Quadric
+	{
+		double a00{ 0 }, a11{ 0 }, a22{ 0 }, a01{ 0 }, a02{ 0 }, a12{ 0 };
+		double b0{ 0 }, b1{ 0 }, b2{ 0 };
+		double c{ 0 };
+		double weight{ 0 };
+
+		void addPlane(double nx, double ny, double nz, double d, double w)
+		{
+			a00 += w * nx * nx; a11 += w * ny * ny; a22 += w * nz * nz;
+			a01 += w * nx * ny; a02 += w * nx * nz; a12 += w * ny * nz;
+			b0 += w * nx * d; b1 += w * ny * d; b2 += w * nz * d;
+			c += w * d * d;
+			weight += w;
+		}
+
+		void add(const Quadric& other)
+		{
+			a00 += other.a00; a11 += other.a11; a22 += other.a22;
+			a01 += other.a01; a02 += other.a02; a12 += other.a12;
+			b0 += other.b0; b1 += other.b1; b2 += other.b2;
+			c += other.c;
+			weight += other.weight;
+		}
+
+		/// @brief Mean squared distance of p to the planes
+		double error(const glm::vec3& p) const
+		{
+			const double x = p.x, y = p.y, z = p.z;
+			const double squared = a00 * x * x + a11 * y * y + a22 * z * z + 2 * (a01 * x * y + a02 * x * z + a12 * y * z) + 2 * (b0 * x + b1 * y + b2 * z) + c;
+			return weight > 0 ? std::max(squared, 0.0) / weight : 0.0;
+		}
+	};
+
+	// How a position may move. Seams are positions split into two vertices by differing uvs or colors
+	enum class PositionKind : uint8_t { Manifold, Border, Seam, Locked };
+
+	// Compressed lists: items of key k are data[offsets[k]] .. data[offsets[k + 1]]
+	struct Buckets
+	{
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> data;
+
+		void build(size_t keyCount, const std::vector<uint32_t>& keys, const std::vector<uint32_t>& values)
+		{
+			offsets.assign(keyCount + 1, 0);
+			for (uint32_t key : keys) offsets[key + 1]++;
+			for (size_t k = 0; k < keyCount; k++) offsets[k + 1] += offsets[k];
+			data.resize(keys.size());
+			std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < keys.size(); i++) data[cursor[keys[i]]++] = values[i];
+		}
+	};
+
+	uint64_t edgeKey(uint32_t from, uint32_t to) { return (static_cast<uint64_t>(from) << 32) | to; }
+
+	glm::vec3 faceNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) { return glm::cross(b - a, c - a); }
+}
+
+namespace GE::Util
+{
+	std::vector<uint32_t> simplifyMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float& error)
+	{
+		error = 0.0f;
+		std::vector<uint32_t> result = indices;
+		const size_t vertexCount = vertices.size();
+		if (result.size() <= targetIndexCount || vertexCount == 0) return result;
+
+		// Vertices with the exact same position share one position id, that is the level collapses work on
+		std::vector<uint32_t> positionOf(vertexCount);
+		std::vector<glm::vec3> positions;
+		{
+			std::vector<uint32_t> order(vertexCount);
+			for (uint32_t v = 0; v < vertexCount; v++) order[v] = v;
+			auto bitsOf = [&](uint32_t v) {
+				std::array<uint32_t, 3> bits;
+				std::memcpy(bits.data(), &vertices[v].pos, sizeof(bits));
+				return bits;
+			};
+			std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return bitsOf(a) < bitsOf(b); });
+			for (size_t i = 0; i < order.size(); i++) {
+				if (i == 0 || bitsOf(order[i]) != bitsOf(order[i - 1])) positions.push_back(vertices[order[i]].pos);
+				positionOf[order[i]] = static_cast<uint32_t>(positions.size() - 1);
+			}
+		}
+		const size_t positionCount = positions.size();
+
+		// Plane quadrics of the input, weighted by area. Border edges add a plane standing on the edge
+		std::vector<Quadric> quadrics(positionCount);
+		{
+			std::unordered_set<uint64_t> directedEdges;
+			for (size_t i = 0; i + 2 < result.size(); i += 3) {
+				for (int corner = 0; corner < 3; corner++) directedEdges.insert(edgeKey(positionOf[result[i + corner]], positionOf[result[i + (corner + 1) % 3]]));
+			}
+			for (size_t i = 0; i + 2 < result.size(); i += 3) {
+				const uint32_t p[3] = { positionOf[result[i]], positionOf[result[i + 1]], positionOf[result[i + 2]] };
+				const glm::vec3 normal = faceNormal(positions[p[0]], positions[p[1]], positions[p[2]]);
+				const float doubleArea = glm::length(normal);
+				if (doubleArea <= 0.0f) continue;
+				const glm::vec3 unit = normal / doubleArea;
+				const double d = -glm::dot(unit, positions[p[0]]);
+				for (int corner = 0; corner < 3; corner++) quadrics[p[corner]].addPlane(unit.x, unit.y, unit.z, d, doubleArea * 0.5);
+
+				for (int corner = 0; corner < 3; corner++) {
+					const uint32_t from = p[corner];
+					const uint32_t to = p[(corner + 1) % 3];
+					if (directedEdges.count(edgeKey(to, from)) != 0) continue;
+					const glm::vec3 edge = positions[to] - positions[from];
+					const glm::vec3 borderNormal = glm::cross(edge, unit);
+					const float length = glm::length(borderNormal);
+					if (length <= 0.0f) continue;
+					const glm::vec3 borderUnit = borderNormal / length;
+					const double borderD = -glm::dot(borderUnit, positions[from]);
+					const double weight = BorderWeight * glm::dot(edge, edge);
+					quadrics[from].addPlane(borderUnit.x, borderUnit.y, borderUnit.z, borderD, weight);
+					quadrics[to].addPlane(borderUnit.x, borderUnit.y, borderUnit.z, borderD, weight);
+				}
+			}
+		}
+
+		struct Collapse
+		{
+			uint32_t from;
+			uint32_t to;
+			float cost;
+		};
+		std::vector<Collapse> collapses;
+		std::vector<uint32_t> keys;
+		std::vector<uint32_t> values;
+		double largestCost = 0.0; // squared distance, the error reported is the worst collapse
+
+		// Each pass collapses a set of independent edges, cheapest first, then rebuilds the topology
+		while (result.size() > targetIndexCount) {
+			const size_t triangleCount = result.size() / 3;
+
+			keys.clear(); values.clear();
+			for (size_t i = 0; i < result.size(); i++) { keys.push_back(result[i]); values.push_back(static_cast<uint32_t>(i / 3)); }
+			Buckets vertexTriangles;
+			vertexTriangles.build(vertexCount, keys, values);
+
+			keys.clear(); values.clear();
+			std::unordered_set<uint64_t> directedEdges;
+			for (size_t i = 0; i < result.size(); i++) {
+				keys.push_back(positionOf[result[i]]);
+				values.push_back(static_cast<uint32_t>(i / 3));
+				directedEdges.insert(edgeKey(positionOf[result[i]], positionOf[result[i - i % 3 + (i + 1) % 3]]));
+			}
+			Buckets positionTriangles;
+			positionTriangles.build(positionCount, keys, values);
+
+			// The vertices of a position still referenced by a triangle
+			std::vector<std::vector<uint32_t>> wedges(positionCount);
+			for (uint32_t v = 0; v < vertexCount; v++) {
+				if (vertexTriangles.offsets[v] != vertexTriangles.offsets[v + 1]) wedges[positionOf[v]].push_back(v);
+			}
+
+			std::vector<bool> onBorder(positionCount, false);
+			for (uint64_t edge : directedEdges) {
+				const uint32_t from = static_cast<uint32_t>(edge >> 32);
+				const uint32_t to = static_cast<uint32_t>(edge);
+				if (directedEdges.count(edgeKey(to, from)) == 0) { onBorder[from] = true; onBorder[to] = true; }
+			}
+			std::vector<PositionKind> kinds(positionCount, PositionKind::Locked);
+			for (size_t p = 0; p < positionCount; p++) {
+				if (wedges[p].size() == 1) kinds[p] = onBorder[p] ? PositionKind::Border : PositionKind::Manifold;
+				else if (wedges[p].size() == 2 && !onBorder[p]) kinds[p] = PositionKind::Seam;
+			}
+
+			// The vertex at position target that shares a triangle with vertex, NoVertex if there is none
+			auto neighbourAt = [&](uint32_t vertex, uint32_t target) {
+				for (uint32_t i = vertexTriangles.offsets[vertex]; i < vertexTriangles.offsets[vertex + 1]; i++) {
+					const uint32_t triangle = vertexTriangles.data[i];
+					for (int corner = 0; corner < 3; corner++) {
+						if (positionOf[result[triangle * 3 + corner]] == target) return result[triangle * 3 + corner];
+					}
+				}
+				return NoVertex;
+			};
+
+			auto allowed = [&](uint32_t from, uint32_t to) {
+				switch (kinds[from]) {
+				case PositionKind::Manifold: return true;
+				// Only along an open edge, which exists in one direction only
+				case PositionKind::Border: return kinds[to] == PositionKind::Border && directedEdges.count(edgeKey(from, to)) + directedEdges.count(edgeKey(to, from)) == 1;
+				case PositionKind::Seam:
+					if (kinds[to] != PositionKind::Seam) return false;
+					for (uint32_t wedge : wedges[from]) { if (neighbourAt(wedge, to) == NoVertex) return false; }
+					return true;
+				default: return false;
+				}
+			};
+
+			collapses.clear();
+			for (size_t i = 0; i < result.size(); i++) {
+				const uint32_t a = positionOf[result[i]];
+				const uint32_t b = positionOf[result[i - i % 3 + (i + 1) % 3]];
+				if (a == b) continue;
+				Quadric combined = quadrics[a];
+				combined.add(quadrics[b]);
+				if (allowed(a, b)) collapses.push_back({ a, b, static_cast<float>(combined.error(positions[b])) });
+				if (allowed(b, a)) collapses.push_back({ b, a, static_cast<float>(combined.error(positions[a])) });
+			}
+			std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+			std::vector<bool> touched(positionCount, false);
+			std::vector<uint32_t> vertexTarget(vertexCount);
+			for (uint32_t v = 0; v < vertexCount; v++) vertexTarget[v] = v;
+
+			const size_t trianglesToRemove = (result.size() - targetIndexCount + 2) / 3;
+			size_t removed = 0;
+			size_t applied = 0;
+			for (const Collapse& collapse : collapses) {
+				if (removed >= trianglesToRemove) break;
+				if (touched[collapse.from] || touched[collapse.to]) continue;
+
+				// Moving from onto to must not turn any remaining triangle around
+				bool flips = false;
+				size_t sharedTriangles = 0;
+				for (uint32_t i = positionTriangles.offsets[collapse.from]; i < positionTriangles.offsets[collapse.from + 1] && !flips; i++) {
+					const uint32_t triangle = positionTriangles.data[i];
+					uint32_t p[3] = { positionOf[result[triangle * 3]], positionOf[result[triangle * 3 + 1]], positionOf[result[triangle * 3 + 2]] };
+					if (p[0] == collapse.to || p[1] == collapse.to || p[2] == collapse.to) { sharedTriangles++; continue; }
+					const glm::vec3 before = faceNormal(positions[p[0]], positions[p[1]], positions[p[2]]);
+					for (auto& corner : p) if (corner == collapse.from) corner = collapse.to;
+					const glm::vec3 after = faceNormal(positions[p[0]], positions[p[1]], positions[p[2]]);
+					// More than about 75 degrees of rotation counts as well, a few of those in a row would flip it anyway
+					flips = glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after);
+				}
+				if (flips) continue;
+
+				for (uint32_t wedge : wedges[collapse.from]) vertexTarget[wedge] = neighbourAt(wedge, collapse.to);
+				quadrics[collapse.to].add(quadrics[collapse.from]);
+				largestCost = std::max(largestCost, static_cast<double>(collapse.cost));
+
+				// Everything around the collapse changed, its neighbours wait for the next pass
+				for (uint32_t i = positionTriangles.offsets[collapse.from]; i < positionTriangles.offsets[collapse.from + 1]; i++) {
+					const uint32_t triangle = positionTriangles.data[i];
+					for (int corner = 0; corner < 3; corner++) touched[positionOf[result[triangle * 3 + corner]]] = true;
+				}
+				removed += sharedTriangles;
+				applied++;
+			}
+			if (applied == 0) break;
+
+			std::vector<uint32_t> next;
+			next.reserve(result.size());
+			for (size_t t = 0; t < triangleCount; t++) {
+				const uint32_t a = vertexTarget[result[t * 3]];
+				const uint32_t b = vertexTarget[result[t * 3 + 1]];
+				const uint32_t c = vertexTarget[result[t * 3 + 2]];
+				if (positionOf[a] == positionOf[b] || positionOf[b] == positionOf[c] || positionOf[a] == positionOf[c]) continue;
+				next.push_back(a); next.push_back(b); next.push_back(c);
+			}
+			result.swap(next);
+		}
+
+		error = static_cast<float>(std::sqrt(largestCost));
+		return result;
+	}
+
+	std::vector<MeshLod> buildLodChain(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t levelCount)
+	{
+		std::vector<MeshLod> lods{ { 0, static_cast<uint32_t>(indices.size()), 0.0f } };
+		std::vector<uint32_t> current = indices;
+		float error = 0.0f;
+
+		for (uint32_t level = 1; level <= levelCount; level++) {
+			float levelError = 0.0f;
+			std::vector<uint32_t> simplified = simplifyMesh(vertices, current, current.size() / 6 * 3, levelError);
+			if (simplified.empty() || simplified.size() * 5 > current.size() * 4) break;
+
+			optimizeVertexCache(simplified, vertices.size());
+			// Every level is simplified from the one before, so the errors stack up
+			error += levelError;
+			lods.push_back({ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(simplified.size()), error });
+			indices.insert(indices.end(), simplified.begin(), simplified.end());
+			current = std::move(simplified);
+		}
+		return lods;
+	}
+}
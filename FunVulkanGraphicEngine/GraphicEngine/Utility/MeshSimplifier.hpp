@@ -0,0 +1,21 @@
+#pragma once
+
+#include "GraphicEngine/GraphicsVertex.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace GE::Util
+{
+	/// @brief Edge collapse simplification driven by quadric error metrics (Garland and Heckbert).
+	/// Vertices are only collapsed into one of their neighbours, so the result indexes the same vertex buffer.
+	/// Open borders only collapse along themselves and uv seams only along the seam, which keeps outlines and texture
+	/// islands intact. Stops at targetIndexCount or when nothing can collapse anymore.
+	/// error receives the square root of the largest quadric cost among the collapses made, in model units. That is the
+	/// worst deviation any single collapse introduced, not an average over the surface
+	std::vector<uint32_t> simplifyMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t targetIndexCount, float& error);
+
+	/// @brief Appends up to levelCount simplified levels to indices, each aiming for half the triangles of the one before.
+	/// lods[0] is the input. Stops early once a level would not remove at least a fifth of the triangles
+	std::vector<MeshLod> buildLodChain(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t levelCount);
+}
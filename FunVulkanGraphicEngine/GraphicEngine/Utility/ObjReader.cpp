@@ -0,0 +1,224 @@
+#include "GraphicEngine/Utility/ObjReader.hpp"
+#include "GraphicEngine/Utility/FileMapping.hpp"
+#include "GraphicEngine/Utility/Parallel.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+	// Below this size a chunk is not worth its own thread
+	constexpr size_t MinimumChunkSize = 1 << 20;
+
+	enum RelativeFlags : uint8_t { RelativePosition = 1, RelativeTexcoord = 2 };
+
+	// Corner as found in a chunk. Relative (negative) indices are stored relative to the start of the chunk,
+	// since the chunk does not know how many vertices came before it
+	struct RawCorner
+	{
+		int64_t position;
+		int64_t texcoord; // -1 when missing
+		uint8_t relative;
+	};
+
+	struct ChunkResult
+	{
+		std::vector<float> positions;
+		std::vector<float> texcoords;
+		std::vector<RawCorner> corners;
+		std::string error;
+	};
+
+	inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+	inline const char* skipBlanks(const char* current, const char* end)
+	{
+		while (current < end && isBlank(*current)) ++current;
+		return current;
+	}
+
+	inline bool parseFloat(const char*& current, const char* end, float& value)
+	{
+		current = skipBlanks(current, end);
+		if (current < end && *current == '+') ++current; // from_chars does not accept a leading plus
+		auto [next, errorCode] = std::from_chars(current, end, value);
+		if (errorCode != std::errc()) return false;
+		current = next;
+		return true;
+	}
+
+	inline bool parseIndex(const char*& current, const char* end, int64_t& value)
+	{
+		if (current < end && *current == '+') ++current;
+		auto [next, errorCode] = std::from_chars(current, end, value);
+		if (errorCode != std::errc() || value == 0) return false; // OBJ indices start at 1
+		current = next;
+		return true;
+	}
+
+	std::string lineError(const char* what, const char* lineStart, const char* lineEnd)
+	{
+		return std::string(what) + ": \"" + std::string(lineStart, std::min<size_t>(lineEnd - lineStart, 64)) + "\"";
+	}
+
+	void parseChunk(const char* current, const char* end, ChunkResult& result)
+	{
+		std::vector<RawCorner> polygon;
+
+		while (current < end) {
+			const char* lineStart = current;
+			const char* lineEnd = static_cast<const char*>(std::memchr(current, '\n', end - current));
+			if (lineEnd == nullptr) lineEnd = end;
+			current = lineEnd + 1;
+
+			const char* cursor = skipBlanks(lineStart, lineEnd);
+			if (lineEnd - cursor < 2) continue;
+
+			if (cursor[0] == 'v' && isBlank(cursor[1])) {
+				cursor += 2;
+				float x, y, z;
+				if (!parseFloat(cursor, lineEnd, x) || !parseFloat(cursor, lineEnd, y) || !parseFloat(cursor, lineEnd, z)) {
+					result.error = lineError("malformed vertex", lineStart, lineEnd);
+					return;
+				}
+				// Any w or vertex color after xyz is not used by the engine
+				result.positions.insert(result.positions.end(), { x, y, z });
+			}
+			else if (cursor[0] == 'v' && cursor[1] == 't' && lineEnd - cursor > 2 && isBlank(cursor[2])) {
+				cursor += 3;
+				float u, v = 0.0f;
+				if (!parseFloat(cursor, lineEnd, u)) {
+					result.error = lineError("malformed texture coordinate", lineStart, lineEnd);
+					return;
+				}
+				parseFloat(cursor, lineEnd, v); // v is optional
+				result.texcoords.insert(result.texcoords.end(), { u, v });
+			}
+			else if (cursor[0] == 'f' && isBlank(cursor[1])) {
+				cursor += 2;
+				polygon.clear();
+				const int64_t positionsSoFar = static_cast<int64_t>(result.positions.size() / 3);
+				const int64_t texcoordsSoFar = static_cast<int64_t>(result.texcoords.size() / 2);
+
+				for (cursor = skipBlanks(cursor, lineEnd); cursor < lineEnd; cursor = skipBlanks(cursor, lineEnd)) {
+					// v, v/vt, v//vn or v/vt/vn
+					RawCorner corner{ 0, -1, 0 };
+					int64_t index;
+					if (!parseIndex(cursor, lineEnd, index)) {
+						result.error = lineError("malformed face", lineStart, lineEnd);
+						return;
+					}
+					if (index < 0) { corner.position = positionsSoFar + index; corner.relative |= RelativePosition; }
+					else { corner.position = index - 1; }
+
+					if (cursor < lineEnd && *cursor == '/') {
+						++cursor;
+						if (cursor < lineEnd && *cursor != '/') {
+							if (!parseIndex(cursor, lineEnd, index)) {
+								result.error = lineError("malformed face", lineStart, lineEnd);
+								return;
+							}
+							if (index < 0) { corner.texcoord = texcoordsSoFar + index; corner.relative |= RelativeTexcoord; }
+							else { corner.texcoord = index - 1; }
+						}
+						if (cursor < lineEnd && *cursor == '/') {
+							++cursor;
+							if (!parseIndex(cursor, lineEnd, index)) {
+								result.error = lineError("malformed face", lineStart, lineEnd);
+								return;
+							}
+							// Normals are not part of our vertex layout
+						}
+					}
+					polygon.push_back(corner);
+				}
+
+				if (polygon.size() < 3) {
+					result.error = lineError("face with less than 3 corners", lineStart, lineEnd);
+					return;
+				}
+				// Fan the polygon into triangles
+				for (size_t i = 2; i < polygon.size(); i++) {
+					result.corners.push_back(polygon[0]);
+					result.corners.push_back(polygon[i - 1]);
+					result.corners.push_back(polygon[i]);
+				}
+			}
+			// Everything else (vn, o, g, s, usemtl, mtllib, comments) is skipped
+		}
+	}
+
+}
+
+namespace GE::Util
+{
+	ErrorMessage parseObj(std::string_view text, ObjMesh& mesh, unsigned threadCount)
+	{
+		mesh = ObjMesh{};
+
+		if (threadCount == 0) threadCount = pickWorkerCount(text.size(), MinimumChunkSize);
+
+		// Cut the text evenly, then push every cut forward to the next line start
+		std::vector<size_t> boundaries(threadCount + 1, text.size());
+		boundaries[0] = 0;
+		for (unsigned i = 1; i < threadCount; i++) {
+			size_t cut = std::max(boundaries[i - 1], text.size() * i / threadCount);
+			size_t newLine = text.find('\n', cut);
+			boundaries[i] = newLine == std::string_view::npos ? text.size() : newLine + 1;
+		}
+
+		std::vector<ChunkResult> chunks(threadCount);
+		runParallel(threadCount, [&](size_t i) {
+			parseChunk(text.data() + boundaries[i], text.data() + boundaries[i + 1], chunks[i]);
+		});
+
+		// Work out where each chunk lands in the merged mesh
+		std::vector<size_t> positionBase(threadCount + 1, 0), texcoordBase(threadCount + 1, 0), cornerBase(threadCount + 1, 0);
+		for (unsigned i = 0; i < threadCount; i++) {
+			if (!chunks[i].error.empty()) return chunks[i].error;
+			positionBase[i + 1] = positionBase[i] + chunks[i].positions.size();
+			texcoordBase[i + 1] = texcoordBase[i] + chunks[i].texcoords.size();
+			cornerBase[i + 1] = cornerBase[i] + chunks[i].corners.size();
+		}
+		mesh.positions.resize(positionBase[threadCount]);
+		mesh.texcoords.resize(texcoordBase[threadCount]);
+		mesh.corners.resize(cornerBase[threadCount]);
+
+		const int64_t positionCount = static_cast<int64_t>(mesh.positions.size() / 3);
+		const int64_t texcoordCount = static_cast<int64_t>(mesh.texcoords.size() / 2);
+
+		std::vector<std::string> errors(threadCount);
+		runParallel(threadCount, [&](size_t i) {
+			ChunkResult& chunk = chunks[i];
+			std::copy(chunk.positions.begin(), chunk.positions.end(), mesh.positions.begin() + positionBase[i]);
+			std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), mesh.texcoords.begin() + texcoordBase[i]);
+
+			const int64_t firstPosition = static_cast<int64_t>(positionBase[i] / 3);
+			const int64_t firstTexcoord = static_cast<int64_t>(texcoordBase[i] / 2);
+			ObjCorner* output = mesh.corners.data() + cornerBase[i];
+			for (const RawCorner& raw : chunk.corners) {
+				int64_t position = raw.position + ((raw.relative & RelativePosition) ? firstPosition : 0);
+				int64_t texcoord = raw.texcoord + ((raw.relative & RelativeTexcoord) ? firstTexcoord : 0);
+				const bool badTexcoord = texcoord >= texcoordCount || texcoord < ((raw.relative & RelativeTexcoord) ? 0 : -1);
+				if (position < 0 || position >= positionCount || badTexcoord) {
+					errors[i] = "face index out of range";
+					return;
+				}
+				*output++ = ObjCorner{ static_cast<uint32_t>(position), static_cast<int32_t>(texcoord) };
+			}
+		});
+
+		for (auto& error : errors) {
+			if (!error.empty()) return error;
+		}
+		return "";
+	}
+
+	ErrorMessage readObj(const std::string& filePath, ObjMesh& mesh, unsigned threadCount)
+	{
+		MappedFile file;
+		if (!file.open(filePath)) return std::string(file.getError());
+		return parseObj(file.view(), mesh, threadCount);
+	}
+}
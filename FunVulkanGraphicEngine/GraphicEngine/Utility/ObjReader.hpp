@@ -0,0 +1,32 @@
+#pragma once
+
+#include "GraphicEngine/ConstDefines.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace GE::Util
+{
+	/// @brief One triangle corner. Indices are already resolved to 0 based offsets into ObjMesh
+	struct ObjCorner
+	{
+		uint32_t position;
+		int32_t texcoord; // -1 when the face did not reference one
+	};
+
+	struct ObjMesh
+	{
+		std::vector<float> positions; // x,y,z
+		std::vector<float> texcoords; // u,v
+		std::vector<ObjCorner> corners; // 3 per triangle, polygons are fanned into triangles
+	};
+
+	// In-tree Wavefront OBJ reader. Only the parts the engine uses are read (v, vt, f), everything else is skipped.
+	// The text is split into line aligned chunks that are parsed on worker threads and merged back in file order,
+	// so the result is the same no matter how many threads were used.
+	// threadCount of 0 picks one from the hardware and the file size
+	ErrorMessage parseObj(std::string_view text, ObjMesh& mesh, unsigned threadCount = 0);
+	ErrorMessage readObj(const std::string& filePath, ObjMesh& mesh, unsigned threadCount = 0);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace GE::Util
+{
+	/// @brief Worker count for a job of itemCount items, where a worker is only worth it for every minimumPerWorker items
+	inline unsigned pickWorkerCount(size_t itemCount, size_t minimumPerWorker)
+	{
+		const size_t bySize = std::max<size_t>(1, itemCount / std::max<size_t>(1, minimumPerWorker));
+		return static_cast<unsigned>(std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), bySize));
+	}
+
+	/// @brief Runs function(i) for i in [0, count) with one thread each. Index 0 runs on the calling thread
+	template<typename Function>
+	void runParallel(size_t count, Function&& function)
+	{
+		std::vector<std::thread> workers;
+		workers.reserve(count);
+		for (size_t i = 1; i < count; i++) workers.emplace_back(function, i);
+		function(0);
+		for (auto& worker : workers) worker.join();
+	}
+
+	/// @brief [begin, end) of part index out of partCount even parts of itemCount
+	inline std::pair<size_t, size_t> partRange(size_t itemCount, size_t partCount, size_t index)
+	{
+		return { itemCount * index / partCount, itemCount * (index + 1) / partCount };
+	}
+}
@@ -0,0 +1,83 @@
+#include "GraphicEngine/Utility/SkylinePacker.hpp"
+
+#include <algorithm>
+
+namespace GE::Util
+{
+	SkylinePacker::SkylinePacker(uint32_t width, uint32_t height) { reset(width, height); }
+
+	void SkylinePacker::reset(uint32_t width, uint32_t height)
+	{
+		pageWidth = width;
+		pageHeight = height;
+		usedArea = 0;
+		skyline.clear();
+		if (width > 0) skyline.push_back({ 0, 0, width });
+	}
+
+	std::optional<uint32_t> SkylinePacker::restingHeight(size_t index, uint32_t width) const
+	{
+		if (skyline[index].x + width > pageWidth) return std::nullopt;
+
+		// The rectangle rests on the highest segment below its span
+		uint32_t y = 0;
+		uint32_t covered = 0;
+		for (size_t i = index; covered < width; i++) {
+			y = std::max(y, skyline[i].y);
+			covered += skyline[i].width;
+		}
+		return y;
+	}
+
+	std::optional<PackedRect> SkylinePacker::insert(uint32_t width, uint32_t height)
+	{
+		if (width == 0 || height == 0 || width > pageWidth || height > pageHeight) return std::nullopt;
+
+		size_t bestIndex = skyline.size();
+		uint32_t bestTop = UINT32_MAX;
+		uint32_t bestY = 0;
+		for (size_t i = 0; i < skyline.size(); i++) {
+			const auto y = restingHeight(i, width);
+			if (!y || *y + height > pageHeight) continue;
+			// Segments are sorted by x, so the first of equally low spots is the leftmost
+			if (*y + height < bestTop) {
+				bestTop = *y + height;
+				bestY = *y;
+				bestIndex = i;
+			}
+		}
+		if (bestIndex == skyline.size()) return std::nullopt;
+
+		const PackedRect rect{ skyline[bestIndex].x, bestY, width, height };
+
+		// The rectangle's top replaces the outline over its span, segments it only partly covers are cut
+		const Segment placed{ rect.x, bestTop, width };
+		const uint32_t right = rect.x + width;
+		size_t end = bestIndex;
+		while (end < skyline.size() && skyline[end].x + skyline[end].width <= right) end++;
+		if (end < skyline.size() && skyline[end].x < right) {
+			skyline[end].width -= right - skyline[end].x;
+			skyline[end].x = right;
+		}
+		skyline.erase(skyline.begin() + bestIndex, skyline.begin() + end);
+		skyline.insert(skyline.begin() + bestIndex, placed);
+
+		// Neighbors at the same height become one segment, fewer spots to test next time
+		for (size_t i = 0; i + 1 < skyline.size();) {
+			if (skyline[i].y == skyline[i + 1].y) {
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+			}
+			else i++;
+		}
+
+		usedArea += static_cast<uint64_t>(width) * height;
+		return rect;
+	}
+
+	float SkylinePacker::occupancy() const
+	{
+		const uint64_t pageArea = static_cast<uint64_t>(pageWidth) * pageHeight;
+		return pageArea == 0 ? 0.0f : static_cast<float>(usedArea) / static_cast<float>(pageArea);
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace GE::Util
+{
+	struct PackedRect
+	{
+		uint32_t x;
+		uint32_t y;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	/// @brief Places rectangles on a fixed size page with the skyline bottom-left heuristic.
+	/// The page is tracked as the top outline of everything placed so far, a list of horizontal segments. A new rectangle
+	/// goes where it ends up lowest, the leftmost spot among equals. Space below an overhang is given up, which keeps
+	/// inserts linear in the number of segments
+	class SkylinePacker
+	{
+	public:
+		SkylinePacker(uint32_t width = 0, uint32_t height = 0);
+
+		/// @brief Forgets every placed rectangle
+		void reset(uint32_t width, uint32_t height);
+
+		/// @brief Spot for a width x height rectangle, nothing when the page has no room left for it
+		std::optional<PackedRect> insert(uint32_t width, uint32_t height);
+
+		/// @brief Share of the page covered by placed rectangles
+		float occupancy() const;
+
+	private:
+		struct Segment
+		{
+			uint32_t x;
+			uint32_t y; // top of what was placed below this segment
+			uint32_t width;
+		};
+
+		/// @brief Lowest y a rectangle of width can rest on when its left edge sits at segment index. Nothing if it sticks out
+		std::optional<uint32_t> restingHeight(size_t index, uint32_t width) const;
+
+		std::vector<Segment> skyline;
+		uint32_t pageWidth{ 0 };
+		uint32_t pageHeight{ 0 };
+		uint64_t usedArea{ 0 };
+	};
+}
@@ -0,0 +1,212 @@
+#include "GraphicEngine/Utility/StagingRing.hpp"
+#include "GraphicEngine/Utility/MemorySupport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <numeric>
+
+namespace
+{
+	// Set by the renderer once its device exists, read by the texture loader's workers
+	std::atomic<GE::Util::StagingRing*> sharedRing{ nullptr };
+
+	VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+	std::string createMappedBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBuffer& buffer, VkDeviceMemory& memory, void*& mapped, const std::vector<uint32_t>& queueFamilies = {})
+	{
+		buffer = nullptr;
+		memory = nullptr;
+		mapped = nullptr;
+		auto errorMessage = GE::Util::createBuffer(device, physicalDevice, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, memory, queueFamilies);
+		if (errorMessage.empty() && vkMapMemory(device, memory, 0, size, 0, &mapped) != VK_SUCCESS) errorMessage = "failed to map staging buffer";
+		if (errorMessage.empty()) return "";
+
+		if (buffer != nullptr) vkDestroyBuffer(device, buffer, nullptr);
+		if (memory != nullptr) vkFreeMemory(device, memory, nullptr);
+		buffer = nullptr;
+		memory = nullptr;
+		return errorMessage;
+	}
+}
+
+namespace GE::Util
+{
+	StagingRing::StagingRing() = default;
+	StagingRing::~StagingRing() { Free(); }
+
+	bool StagingRing::init(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize capacity, std::vector<uint32_t> queueFamilies)
+	{
+		if (device == nullptr) {
+			currentError = "Must insert a valid device";
+			return false;
+		}
+		if (physicalDevice == nullptr)
+		{
+			currentError = "Must insert a valid physical device";
+			return false;
+		}
+		Free();
+		this->device = device;
+		this->physicalDevice = physicalDevice;
+		this->queueFamilies = std::move(queueFamilies);
+
+		// Buffer image copies need offsets that are a multiple of the texel block and of 4. 16 covers every format staged
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		alignment = std::lcm<VkDeviceSize>(std::max<VkDeviceSize>(properties.limits.optimalBufferCopyOffsetAlignment, 1), 16);
+
+		std::lock_guard lock(mutex);
+		if (auto errorMessage = addBlock(alignUp(std::max<VkDeviceSize>(capacity, 1), alignment)); !errorMessage.empty()) {
+			currentError = "staging ring: " + errorMessage;
+			return false;
+		}
+		return true;
+	}
+
+	void StagingRing::Free()
+	{
+		std::lock_guard lock(mutex);
+		if (bytesUsed > 0) std::cout << "WARNING staging ring freed with " << bytesUsed << " bytes still allocated" << std::endl;
+		for (auto& block : blocks) destroyBlock(*block);
+		blocks.clear();
+		bytesUsed = 0;
+	}
+
+	std::string_view StagingRing::getError() const { return currentError; }
+
+	VkDeviceSize StagingRing::capacity() const
+	{
+		std::lock_guard lock(mutex);
+		VkDeviceSize total = 0;
+		for (const auto& block : blocks) total += block->capacity;
+		return total;
+	}
+
+	VkDeviceSize StagingRing::used() const
+	{
+		std::lock_guard lock(mutex);
+		return bytesUsed;
+	}
+
+	std::string StagingRing::addBlock(VkDeviceSize capacity)
+	{
+		auto block = std::make_unique<Block>();
+		block->id = nextBlockId++;
+		block->capacity = capacity;
+		void* mapped = nullptr;
+		if (auto errorMessage = createMappedBuffer(device, physicalDevice, capacity, block->buffer, block->memory, mapped, queueFamilies); !errorMessage.empty()) return errorMessage;
+		block->mapped = static_cast<char*>(mapped);
+		blocks.push_back(std::move(block));
+		return "";
+	}
+
+	void StagingRing::destroyBlock(Block& block)
+	{
+		if (block.buffer != nullptr) vkDestroyBuffer(device, block.buffer, nullptr);
+		if (block.memory != nullptr) vkFreeMemory(device, block.memory, nullptr); // unmaps as well
+		block.buffer = nullptr;
+		block.memory = nullptr;
+		block.mapped = nullptr;
+	}
+
+	bool StagingRing::place(const Block& block, VkDeviceSize size, VkDeviceSize& offset) const
+	{
+		if (block.spans.empty()) {
+			offset = 0;
+			return size <= block.capacity;
+		}
+		const Span& oldest = block.spans.front();
+		const Span& newest = block.spans.back();
+		const VkDeviceSize start = alignUp(newest.end, alignment);
+		if (newest.offset >= oldest.offset) {
+			// Not wrapped yet, free space sits behind the newest span and in front of the oldest
+			if (start + size <= block.capacity) { offset = start; return true; }
+			if (size <= oldest.offset) { offset = 0; return true; }
+			return false;
+		}
+		// Wrapped, only the gap up to the oldest span is free
+		if (start + size <= oldest.offset) { offset = start; return true; }
+		return false;
+	}
+
+	ErrorMessage StagingRing::allocate(VkDeviceSize size, StagingAllocation& allocation)
+	{
+		if (size == 0) return "nothing to stage";
+		std::lock_guard lock(mutex);
+		if (blocks.empty()) return "staging ring was not initialized";
+
+		VkDeviceSize offset = 0;
+		if (!place(*blocks.back(), size, offset)) {
+			const VkDeviceSize grown = std::max(blocks.back()->capacity * 2, alignUp(size, alignment));
+			if (auto errorMessage = addBlock(grown); !errorMessage.empty()) return "staging ring: " + errorMessage;
+			if constexpr (PRINT_ENGINE_STATS) std::cout << "Staging ring grew to " << grown / 1024 << " KB" << std::endl;
+
+			// Drained blocks are not needed anymore, the others go once their last allocation is released
+			for (size_t i = 0; i + 1 < blocks.size();) {
+				if (!blocks[i]->spans.empty()) { i++; continue; }
+				destroyBlock(*blocks[i]);
+				blocks.erase(blocks.begin() + i);
+			}
+			offset = 0;
+		}
+
+		Block& block = *blocks.back();
+		block.spans.push_back(Span{ offset, offset + size, false });
+		bytesUsed += size;
+		allocation = StagingAllocation{ block.buffer, offset, size, block.mapped + offset, nullptr, this, block.id };
+		return "";
+	}
+
+	void StagingRing::release(StagingAllocation& allocation)
+	{
+		if (allocation.ring != this) return;
+		std::lock_guard lock(mutex);
+		auto found = std::find_if(blocks.begin(), blocks.end(), [&](const auto& block) { return block->id == allocation.block; });
+		if (found != blocks.end()) {
+			Block& block = **found;
+			for (auto& span : block.spans) {
+				if (span.offset != allocation.offset || span.released) continue;
+				span.released = true;
+				bytesUsed -= allocation.size;
+				break;
+			}
+			// Space comes back from either end, released spans between live ones wait for their neighbours
+			while (!block.spans.empty() && block.spans.front().released) block.spans.pop_front();
+			while (!block.spans.empty() && block.spans.back().released) block.spans.pop_back();
+			if (block.spans.empty() && found + 1 != blocks.end()) {
+				destroyBlock(block);
+				blocks.erase(found);
+			}
+		}
+		allocation = StagingAllocation();
+	}
+
+
+
+	void useStagingRing(StagingRing* ring) { sharedRing.store(ring); }
+	StagingRing* stagingRing() { return sharedRing.load(); }
+
+	ErrorMessage allocateStaging(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, StagingAllocation& allocation)
+	{
+		if (StagingRing* ring = sharedRing.load(); ring != nullptr) return ring->allocate(size, allocation);
+
+		allocation = StagingAllocation();
+		if (size == 0) return "nothing to stage";
+		if (auto errorMessage = createMappedBuffer(device, physicalDevice, size, allocation.buffer, allocation.memory, allocation.mapped); !errorMessage.empty()) return errorMessage;
+		allocation.size = size;
+		return "";
+	}
+
+	void freeStaging(VkDevice device, StagingAllocation& allocation)
+	{
+		if (allocation.ring != nullptr) {
+			allocation.ring->release(allocation);
+			return;
+		}
+		if (device == nullptr) return;
+		if (allocation.buffer != nullptr) vkDestroyBuffer(device, allocation.buffer, nullptr);
+		if (allocation.memory != nullptr) vkFreeMemory(device, allocation.memory, nullptr); // unmaps as well
+		allocation = StagingAllocation();
+	}
+}
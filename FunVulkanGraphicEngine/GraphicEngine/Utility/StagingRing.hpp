@@ -0,0 +1,108 @@
+#pragma once
+
+#include "GraphicEngine/ConstDefines.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace GE::Util
+{
+	class StagingRing;
+
+	/// @brief Mapped host memory a copy to the GPU reads from. A piece of a StagingRing, or a buffer of its own when no
+	/// ring is in use. Copies have to read from buffer at offset
+	struct StagingAllocation
+	{
+		VkBuffer buffer{ nullptr };
+		VkDeviceSize offset{ 0 };
+		VkDeviceSize size{ 0 };
+		/// @brief Start of the allocation, mapped for as long as it lives
+		void* mapped{ nullptr };
+		/// @brief Only set for a buffer of its own
+		VkDeviceMemory memory{ nullptr };
+		StagingRing* ring{ nullptr };
+		uint64_t block{ 0 };
+
+		bool empty() const { return buffer == nullptr; }
+	};
+
+	/// @brief One large staging buffer, mapped once and handed out front to back. Space comes back in the order it was
+	/// allocated once the submission that read it finished, so steady uploading never allocates Vulkan memory.
+	/// When a request does not fit the ring grows into a buffer twice the size and the old one goes once it drained.
+	/// Allocating and releasing are thread safe
+	class StagingRing
+	{
+	public:
+		StagingRing();
+		~StagingRing();
+		StagingRing(const StagingRing&) = delete;
+		StagingRing& operator=(const StagingRing&) = delete;
+
+		/// @brief queueFamilies are the families copies read the ring from, more than one makes it shared between them
+		bool init(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize capacity, std::vector<uint32_t> queueFamilies = {});
+		/// @brief Every allocation has to be released before
+		void Free();
+		std::string_view getError() const;
+
+		/// @brief size bytes aligned for buffer and image copies. Grows the ring when they do not fit
+		ErrorMessage allocate(VkDeviceSize size, StagingAllocation& allocation);
+		/// @brief Only once the GPU finished reading the allocation. An allocation held for long keeps the ones after it
+		/// from being reused, the ring grows around it instead
+		void release(StagingAllocation& allocation);
+
+		/// @brief Bytes of every buffer the ring holds, including ones still draining
+		VkDeviceSize capacity() const;
+		/// @brief Bytes handed out and not released yet
+		VkDeviceSize used() const;
+
+	private:
+		struct Span
+		{
+			VkDeviceSize offset;
+			VkDeviceSize end;
+			bool released;
+		};
+
+		struct Block
+		{
+			uint64_t id;
+			VkBuffer buffer{ nullptr };
+			VkDeviceMemory memory{ nullptr };
+			char* mapped{ nullptr };
+			VkDeviceSize capacity{ 0 };
+			/// @brief In allocation order, which is address order around the ring
+			std::deque<Span> spans;
+		};
+
+		std::string addBlock(VkDeviceSize capacity);
+		void destroyBlock(Block& block);
+		/// @brief False when size does not fit between the newest and the oldest span
+		bool place(const Block& block, VkDeviceSize size, VkDeviceSize& offset) const;
+
+		VkDevice device{ nullptr };
+		VkPhysicalDevice physicalDevice{ nullptr };
+		VkDeviceSize alignment{ 16 };
+		std::vector<uint32_t> queueFamilies;
+		std::string currentError;
+
+		mutable std::mutex mutex;
+		/// @brief Allocations come from the last one, the older ones are destroyed once drained
+		std::vector<std::unique_ptr<Block>> blocks;
+		uint64_t nextBlockId{ 1 };
+		VkDeviceSize bytesUsed{ 0 };
+	};
+
+	/// @brief Ring allocateStaging carves from. nullptr makes it create buffers of their own
+	void useStagingRing(StagingRing* ring);
+	StagingRing* stagingRing();
+
+	/// @brief size bytes of mapped staging memory, from the ring in use when there is one. Safe to call from worker threads
+	ErrorMessage allocateStaging(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, StagingAllocation& allocation);
+	/// @brief Gives the allocation back to wherever it came from and empties it. Does nothing for an empty one
+	void freeStaging(VkDevice device, StagingAllocation& allocation);
+}
@@ -0,0 +1,58 @@
+#include "GraphicEngine/Utility/TextureBaker.hpp"
+#include "GraphicEngine/Utility/BlockCompression.hpp"
+#include "GraphicEngine/Utility/FileMapping.hpp"
+#include "GraphicEngine/Utility/Hashing.hpp"
+
+#include <stb_image.h>
+
+namespace GE::Util
+{
+	const char* textureFormatName(TextureFormat format)
+	{
+		switch (format) {
+		case TextureFormat::BC1_SRGB: return "bc1";
+		case TextureFormat::BC3_SRGB: return "bc3";
+		default: return "rgba";
+		}
+	}
+
+	std::string bakeTexture(const std::string& inputPath, const std::string& outputPath, std::optional<TextureFormat> format, TextureBakeReport* report)
+	{
+		MappedFile file;
+		if (!file.open(inputPath)) return std::string(file.getError());
+		int width, height, channels;
+		stbi_uc* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(file.data()), static_cast<int>(file.size()), &width, &height, &channels, STBI_rgb_alpha);
+		const uint64_t sourceSize = file.size();
+		const uint64_t contentHash = hashBytes(file.data(), file.size());
+		file.close();
+		if (pixels == nullptr) return "failed to load " + inputPath;
+		auto levels = buildMipChain(pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+		stbi_image_free(pixels);
+
+		if (!format) {
+			bool hasAlpha = false;
+			const auto& base = levels.front().pixels;
+			for (size_t i = 3; i < base.size() && !hasAlpha; i += 4) hasAlpha = base[i] != 255;
+			format = hasAlpha ? TextureFormat::BC3_SRGB : TextureFormat::BC1_SRGB;
+		}
+
+		TextureBakeReport totals;
+		std::vector<std::vector<uint8_t>> encoded;
+		for (auto& level : levels) {
+			totals.uncompressedBytes += level.pixels.size();
+			if (*format == TextureFormat::BC1_SRGB) encoded.push_back(encodeBC1(level));
+			else if (*format == TextureFormat::BC3_SRGB) encoded.push_back(encodeBC3(level));
+			else encoded.push_back(std::move(level.pixels));
+			totals.encodedBytes += encoded.back().size();
+		}
+
+		if (auto errorMessage = TextureContainer::write(outputPath, *format, static_cast<uint32_t>(width), static_cast<uint32_t>(height), encoded, sourceSize, contentHash); !errorMessage.empty()) return errorMessage;
+
+		totals.width = static_cast<uint32_t>(width);
+		totals.height = static_cast<uint32_t>(height);
+		totals.levelCount = static_cast<uint32_t>(encoded.size());
+		totals.format = *format;
+		if (report != nullptr) *report = totals;
+		return "";
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "GraphicEngine/Utility/TextureContainer.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace GE::Util
+{
+	struct TextureBakeReport
+	{
+		uint32_t width{ 0 };
+		uint32_t height{ 0 };
+		uint32_t levelCount{ 0 };
+		TextureFormat format{ TextureFormat::RGBA8_SRGB };
+		size_t uncompressedBytes{ 0 };
+		size_t encodedBytes{ 0 };
+	};
+
+	const char* textureFormatName(TextureFormat format);
+
+	/// @brief Decodes an image, builds the whole mip chain, encodes it and writes it as a .gtex.
+	/// Without a format bc1 is picked for opaque images and bc3 when any pixel has alpha. Returns an empty string on success.
+	/// Offline only, whoever links it has to provide the stb_image implementation
+	std::string bakeTexture(const std::string& inputPath, const std::string& outputPath, std::optional<TextureFormat> format, TextureBakeReport* report = nullptr);
+}
@@ -0,0 +1,136 @@
+#include "GraphicEngine/Utility/TextureContainer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+	constexpr uint64_t LevelAlignment = 16;
+
+	uint64_t alignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+}
+
+namespace GE::Util
+{
+	uint32_t textureFormatBlockBytes(TextureFormat format)
+	{
+		switch (format) {
+		case TextureFormat::BC1_SRGB: return 8;
+		case TextureFormat::BC3_SRGB: return 16;
+		default: return 4;
+		}
+	}
+
+	bool isBlockCompressed(TextureFormat format) { return format == TextureFormat::BC1_SRGB || format == TextureFormat::BC3_SRGB; }
+
+	size_t textureLevelSize(TextureFormat format, uint32_t width, uint32_t height)
+	{
+		if (!isBlockCompressed(format)) return static_cast<size_t>(width) * height * textureFormatBlockBytes(format);
+		return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * textureFormatBlockBytes(format);
+	}
+
+	TextureContainer::TextureContainer() = default;
+	TextureContainer::~TextureContainer() = default;
+
+	bool TextureContainer::open(const std::string& filePath)
+	{
+		close();
+		if (!file.open(filePath)) { currentError = std::string(file.getError()); return false; }
+
+		if (file.size() < sizeof(TextureContainerHeader)) { currentError = "texture header is truncated"; close(); return false; }
+		const auto* candidate = reinterpret_cast<const TextureContainerHeader*>(file.data());
+		if (candidate->magic != Magic || candidate->version != Version) { currentError = filePath + " is not a texture container of this version"; close(); return false; }
+		if (candidate->format > static_cast<uint32_t>(TextureFormat::BC3_SRGB)) { currentError = "unknown texture format"; close(); return false; }
+		if (candidate->levelCount == 0) { currentError = "texture has no levels"; close(); return false; }
+		if (candidate->width == 0 || candidate->height == 0) { currentError = "texture is empty"; close(); return false; }
+		// A full chain halves down to 1x1, anything past it cannot be a level of this texture
+		if (candidate->levelCount > static_cast<uint32_t>(std::bit_width(std::max(candidate->width, candidate->height)))) { currentError = "texture has more levels than its size allows"; close(); return false; }
+
+		const uint64_t tableEnd = sizeof(TextureContainerHeader) + static_cast<uint64_t>(candidate->levelCount) * sizeof(TextureContainerLevel);
+		if (tableEnd > file.size()) { currentError = "texture level table is truncated"; close(); return false; }
+		const auto* table = reinterpret_cast<const TextureContainerLevel*>(file.data() + sizeof(TextureContainerHeader));
+		for (uint32_t i = 0; i < candidate->levelCount; i++) {
+			const auto& level = table[i];
+			if (level.width != std::max(1u, candidate->width >> i) || level.height != std::max(1u, candidate->height >> i)) { currentError = "texture level " + std::to_string(i) + " has the wrong extent"; close(); return false; }
+			if (level.offset % LevelAlignment != 0 || level.offset > file.size() || level.size > file.size() - level.offset) { currentError = "texture level " + std::to_string(i) + " is out of bounds"; close(); return false; }
+			if (level.size != textureLevelSize(static_cast<TextureFormat>(candidate->format), level.width, level.height)) { currentError = "texture level " + std::to_string(i) + " has the wrong size"; close(); return false; }
+		}
+
+		header = candidate;
+		levels = table;
+		return true;
+	}
+
+	void TextureContainer::close()
+	{
+		header = nullptr;
+		levels = nullptr;
+		file.close();
+	}
+
+	TextureFormat TextureContainer::format() const { return static_cast<TextureFormat>(header->format); }
+	uint32_t TextureContainer::width() const { return header->width; }
+	uint32_t TextureContainer::height() const { return header->height; }
+	uint32_t TextureContainer::levelCount() const { return header == nullptr ? 0 : header->levelCount; }
+	const TextureContainerLevel& TextureContainer::level(uint32_t index) const { return levels[index]; }
+	uint64_t TextureContainer::sourceSize() const { return header == nullptr ? 0 : header->sourceSize; }
+	uint64_t TextureContainer::contentHash() const { return header == nullptr ? 0 : header->contentHash; }
+	const char* TextureContainer::payload() const { return file.data() + payloadOffset(); }
+	size_t TextureContainer::payloadSize() const { return file.size() - static_cast<size_t>(payloadOffset()); }
+	uint64_t TextureContainer::payloadOffset() const { return levels[0].offset; }
+	std::string_view TextureContainer::getError() const { return currentError; }
+
+	std::string TextureContainer::write(const std::string& filePath, TextureFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& levelData, uint64_t sourceSize, uint64_t contentHash)
+	{
+		if (levelData.empty()) { return "no levels to write"; }
+
+		TextureContainerHeader header{};
+		header.magic = Magic;
+		header.version = Version;
+		header.format = static_cast<uint32_t>(format);
+		header.width = width;
+		header.height = height;
+		header.levelCount = static_cast<uint32_t>(levelData.size());
+		header.sourceSize = sourceSize;
+		header.contentHash = contentHash;
+
+		std::vector<TextureContainerLevel> table(levelData.size());
+		uint64_t offset = alignUp(sizeof(TextureContainerHeader) + table.size() * sizeof(TextureContainerLevel), LevelAlignment);
+		for (size_t i = 0; i < levelData.size(); i++) {
+			table[i].width = std::max(1u, width >> i);
+			table[i].height = std::max(1u, height >> i);
+			table[i].size = levelData[i].size();
+			table[i].offset = offset;
+			if (table[i].size != textureLevelSize(format, table[i].width, table[i].height)) { return "level " + std::to_string(i) + " has the wrong size"; }
+			offset = alignUp(offset + table[i].size, LevelAlignment);
+		}
+
+		// Same swap in as the mesh cache, a crash never leaves a half written texture behind
+		const std::string temporaryPath = filePath + ".tmp";
+		{
+			std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+			if (!output.is_open()) { return "failed to create " + temporaryPath; }
+
+			const char padding[LevelAlignment]{};
+			output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			output.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(TextureContainerLevel));
+			uint64_t written = sizeof(header) + table.size() * sizeof(TextureContainerLevel);
+			for (size_t i = 0; i < levelData.size(); i++) {
+				output.write(padding, table[i].offset - written);
+				output.write(reinterpret_cast<const char*>(levelData[i].data()), levelData[i].size());
+				written = table[i].offset + table[i].size;
+			}
+			if (!output.good()) { output.close(); std::filesystem::remove(temporaryPath); return "failed to write " + temporaryPath; }
+		}
+
+		std::error_code errorCode;
+		std::filesystem::rename(temporaryPath, filePath, errorCode);
+		if (errorCode) {
+			std::filesystem::remove(temporaryPath, errorCode);
+			return "failed to replace " + filePath;
+		}
+		return "";
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "GraphicEngine/Utility/FileMapping.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace GE::Util
+{
+	enum class TextureFormat : uint32_t
+	{
+		RGBA8_SRGB = 0,
+		BC1_SRGB = 1, // 4x4 block in 8 bytes, no alpha
+		BC3_SRGB = 2, // 4x4 block in 16 bytes
+	};
+
+	/// @brief Bytes per 4x4 block, or per pixel for RGBA8
+	uint32_t textureFormatBlockBytes(TextureFormat format);
+	bool isBlockCompressed(TextureFormat format);
+	size_t textureLevelSize(TextureFormat format, uint32_t width, uint32_t height);
+
+	// Layout of a texture container (.gtex), loosely modeled after KTX2
+	// [TextureContainerHeader][TextureContainerLevel x levelCount][level 0 data][level 1 data]...
+	// Level data is stored in upload order and aligned to 16 bytes, so the block from the first level to the end of the
+	// file can be copied into one staging buffer and every level becomes one region of a single vkCmdCopyBufferToImage
+	struct TextureContainerHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t format; // TextureFormat
+		uint32_t width;
+		uint32_t height;
+		uint32_t levelCount;
+		uint64_t sourceSize;
+		uint64_t contentHash; // hash of the source image bytes, 0 when baked without one
+	};
+
+	struct TextureContainerLevel
+	{
+		uint64_t offset; // from the start of the file
+		uint64_t size;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	/// @brief Read only view of a .gtex file
+	class TextureContainer
+	{
+	public:
+		static constexpr uint32_t Magic = 0x58455447; // "GTEX" in little endian
+		static constexpr uint32_t Version = 2; // 2: source size and hash
+		static constexpr const char* Extension = ".gtex";
+
+		TextureContainer();
+		~TextureContainer();
+
+		bool open(const std::string& filePath);
+		void close();
+
+		TextureFormat format() const;
+		uint32_t width() const;
+		uint32_t height() const;
+		uint32_t levelCount() const;
+		const TextureContainerLevel& level(uint32_t index) const;
+		uint64_t sourceSize() const;
+		uint64_t contentHash() const;
+
+		/// @brief Every level back to back, starting with level 0
+		const char* payload() const;
+		size_t payloadSize() const;
+		/// @brief Offset of the first level in the file. Subtract from TextureContainerLevel::offset to get the offset inside payload()
+		uint64_t payloadOffset() const;
+
+		std::string_view getError() const;
+
+		/// @brief levels[i] holds the already encoded bytes of mip level i. sourceSize and contentHash describe the image it was
+		/// baked from, loaders compare them against the image. Returns an empty string on success
+		static std::string write(const std::string& filePath, TextureFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& levels, uint64_t sourceSize = 0, uint64_t contentHash = 0);
+
+	private:
+		MappedFile file;
+		const TextureContainerHeader* header{ nullptr };
+		const TextureContainerLevel* levels{ nullptr };
+		std::string currentError;
+	};
+}
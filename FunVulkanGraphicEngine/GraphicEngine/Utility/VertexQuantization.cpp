@@ -0,0 +1,134 @@
+#include "GraphicEngine/Utility/VertexQuantization.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace
+{
+	uint16_t toUnorm16(float value) { return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f)); }
+	uint8_t toUnorm8(float value) { return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f)); }
+
+	// Rounds to nearest, ties to even. shift is how many low bits of value get dropped
+	uint32_t roundShift(uint32_t value, uint32_t shift)
+	{
+		uint32_t result = value >> shift;
+		const uint32_t remainder = value & ((1u << shift) - 1);
+		const uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (result & 1))) result++;
+		return result;
+	}
+}
+
+namespace GE::Util
+{
+	uint16_t floatToHalf(float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		const uint32_t sign = (bits >> 16) & 0x8000;
+		const uint32_t exponent = (bits >> 23) & 0xff;
+		const uint32_t mantissa = bits & 0x7fffff;
+
+		if (exponent == 0xff) return static_cast<uint16_t>(sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0)); // infinity or nan
+		const int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+		if (halfExponent >= 31) return static_cast<uint16_t>(sign | 0x7c00);
+		if (halfExponent <= 0) {
+			// Subnormal half. Anything smaller than half of the smallest one rounds to zero
+			if (halfExponent < -10) return static_cast<uint16_t>(sign);
+			return static_cast<uint16_t>(sign | roundShift(mantissa | 0x800000, static_cast<uint32_t>(14 - halfExponent)));
+		}
+		// A carry out of the mantissa bumps the exponent, which is the correctly rounded result (up to infinity)
+		return static_cast<uint16_t>(sign | roundShift((static_cast<uint32_t>(halfExponent) << 23) | mantissa, 13));
+	}
+
+	float halfToFloat(uint16_t value)
+	{
+		const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+		const uint32_t exponent = (value >> 10) & 0x1f;
+		const uint32_t mantissa = value & 0x3ff;
+
+		if (exponent == 0) {
+			const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+			return sign != 0 ? -magnitude : magnitude;
+		}
+		const uint32_t bits = exponent == 31 ? (sign | 0x7f800000 | (mantissa << 13)) : (sign | ((exponent + 112) << 23) | (mantissa << 13));
+		float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	glm::mat4 QuantizedVertices::dequantizeMatrix() const
+	{
+		return glm::scale(glm::translate(glm::mat4(1.0f), positionOffset), positionScale);
+	}
+
+	QuantizedVertices quantizeVertices(const Vertex* vertices, size_t count, VertexLayout layout)
+	{
+		std::vector<CompactVertex> packed(count);
+		QuantizedVertices result = quantizeVertices(vertices, count, layout, packed.data());
+		result.vertices = std::move(packed);
+		return result;
+	}
+
+	QuantizedVertices quantizeVertices(const Vertex* vertices, size_t count, VertexLayout layout, CompactVertex* destination)
+	{
+		QuantizedVertices result;
+		if (count == 0) return result;
+
+		glm::vec3 minimum = vertices[0].pos;
+		glm::vec3 maximum = vertices[0].pos;
+		for (size_t i = 1; i < count; i++) {
+			minimum = glm::min(minimum, vertices[i].pos);
+			maximum = glm::max(maximum, vertices[i].pos);
+		}
+		result.positionOffset = minimum;
+		result.positionScale = maximum - minimum;
+		// A flat axis stays at the offset, 0 would only divide by zero below
+		const glm::vec3 inverseScale(
+			result.positionScale.x > 0.0f ? 1.0f / result.positionScale.x : 0.0f,
+			result.positionScale.y > 0.0f ? 1.0f / result.positionScale.y : 0.0f,
+			result.positionScale.z > 0.0f ? 1.0f / result.positionScale.z : 0.0f);
+
+		for (size_t i = 0; i < count; i++) {
+			const Vertex& source = vertices[i];
+			CompactVertex& packed = destination[i];
+
+			const glm::vec3 normalized = (source.pos - minimum) * inverseScale;
+			packed.pos[0] = toUnorm16(normalized.x);
+			packed.pos[1] = toUnorm16(normalized.y);
+			packed.pos[2] = toUnorm16(normalized.z);
+			packed.pos[3] = 0;
+
+			if (layout == VertexLayout::CompactUnormUV) {
+				if (source.texCoord.x < 0.0f || source.texCoord.x > 1.0f || source.texCoord.y < 0.0f || source.texCoord.y > 1.0f) result.clampedTexCoords++;
+				packed.texCoord[0] = toUnorm16(source.texCoord.x);
+				packed.texCoord[1] = toUnorm16(source.texCoord.y);
+			}
+			else {
+				packed.texCoord[0] = floatToHalf(source.texCoord.x);
+				packed.texCoord[1] = floatToHalf(source.texCoord.y);
+			}
+
+			packed.color[0] = toUnorm8(source.color.x);
+			packed.color[1] = toUnorm8(source.color.y);
+			packed.color[2] = toUnorm8(source.color.z);
+			packed.color[3] = 255;
+		}
+		return result;
+	}
+
+	std::vector<uint16_t> narrowIndices(const uint32_t* indices, size_t count)
+	{
+		std::vector<uint16_t> narrowed(count);
+		narrowIndices(indices, count, narrowed.data());
+		return narrowed;
+	}
+
+	void narrowIndices(const uint32_t* indices, size_t count, uint16_t* destination)
+	{
+		for (size_t i = 0; i < count; i++) destination[i] = static_cast<uint16_t>(indices[i]);
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "GraphicEngine/GraphicsVertex.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace GE::Util
+{
+	/// @brief IEEE half float, rounded to nearest even. Overflow turns into infinity
+	uint16_t floatToHalf(float value);
+	float halfToFloat(uint16_t value);
+
+	struct QuantizedVertices
+	{
+		std::vector<CompactVertex> vertices;
+		// model space position = positionOffset + unorm position * positionScale
+		glm::vec3 positionOffset{ 0.0f };
+		glm::vec3 positionScale{ 1.0f };
+		/// @brief Uvs that were outside [0,1] and got clamped. Only happens with VertexLayout::CompactUnormUV
+		size_t clampedTexCoords{ 0 };
+
+		/// @brief Goes in front of the model matrix so the shader sees the original positions
+		glm::mat4 dequantizeMatrix() const;
+	};
+
+	/// @brief Packs vertices into CompactVertex. Positions are quantized inside the bounds of the mesh, colors to 8 bit
+	QuantizedVertices quantizeVertices(const Vertex* vertices, size_t count, VertexLayout layout);
+	/// @brief Same, but packs into count vertices at destination, e.g. mapped staging memory. The result's vertices stay empty
+	QuantizedVertices quantizeVertices(const Vertex* vertices, size_t count, VertexLayout layout, CompactVertex* destination);
+
+	/// @brief Only valid when every index is below 65536
+	std::vector<uint16_t> narrowIndices(const uint32_t* indices, size_t count);
+	void narrowIndices(const uint32_t* indices, size_t count, uint16_t* destination);
+}
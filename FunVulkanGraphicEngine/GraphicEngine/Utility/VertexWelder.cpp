@@ -0,0 +1,155 @@
+#include "GraphicEngine/Utility/VertexWelder.hpp"
+#include "GraphicEngine/Utility/Hashing.hpp"
+#include "GraphicEngine/Utility/Parallel.hpp"
+
+#include <cstring>
+
+namespace
+{
+	// Below this many corners the threads cost more than they save
+	constexpr size_t MinimumCornersPerWorker = 1 << 19;
+
+	inline size_t shardOf(uint64_t hash, size_t shardCount) { return static_cast<size_t>((hash >> 40) % shardCount); }
+}
+
+namespace GE::Util
+{
+	VertexWelder::VertexWelder(size_t expectedUniqueVertices)
+	{
+		size_t slotCount = 64;
+		while (slotCount < expectedUniqueVertices * 2) slotCount <<= 1;
+		slots.assign(slotCount, Slot{ 0, 0 });
+		slotMask = slotCount - 1;
+		uniqueVertices.reserve(expectedUniqueVertices);
+	}
+
+	uint32_t VertexWelder::weld(const Vertex& vertex) { return weld(vertex, hashBlock32(&vertex)); }
+
+	uint32_t VertexWelder::weld(const Vertex& vertex, uint64_t hash)
+	{
+		// Keep the table at most half full so probe chains stay short
+		if ((uniqueVertices.size() + 1) * 2 > slots.size()) rehash(slots.size() * 2);
+
+		const uint32_t tag = static_cast<uint32_t>(hash >> 32);
+		for (size_t slot = hash & slotMask;; slot = (slot + 1) & slotMask) {
+			Slot& entry = slots[slot];
+			if (entry.index == 0) {
+				uniqueVertices.push_back(vertex);
+				entry = Slot{ tag, static_cast<uint32_t>(uniqueVertices.size()) };
+				return entry.index - 1;
+			}
+			if (entry.tag == tag && std::memcmp(&uniqueVertices[entry.index - 1], &vertex, sizeof(Vertex)) == 0) {
+				return entry.index - 1;
+			}
+		}
+	}
+
+	const std::vector<Vertex>& VertexWelder::vertices() const { return uniqueVertices; }
+	std::vector<Vertex> VertexWelder::takeVertices() { return std::move(uniqueVertices); }
+
+	void VertexWelder::rehash(size_t slotCount)
+	{
+		slots.assign(slotCount, Slot{ 0, 0 });
+		slotMask = slotCount - 1;
+		for (size_t i = 0; i < uniqueVertices.size(); i++) {
+			const uint64_t hash = hashBlock32(&uniqueVertices[i]);
+			size_t slot = hash & slotMask;
+			while (slots[slot].index != 0) slot = (slot + 1) & slotMask;
+			slots[slot] = Slot{ static_cast<uint32_t>(hash >> 32), static_cast<uint32_t>(i + 1) };
+		}
+	}
+
+	void weldVertices(const std::vector<Vertex>& corners, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, unsigned threadCount)
+	{
+		const size_t count = corners.size();
+		indices.resize(count);
+		if (threadCount == 0) threadCount = pickWorkerCount(count, MinimumCornersPerWorker);
+
+		if (threadCount <= 1) {
+			VertexWelder welder(count / 4);
+			for (size_t i = 0; i < count; i++) indices[i] = welder.weld(corners[i]);
+			vertices = welder.takeVertices();
+			return;
+		}
+
+		// 1) Hash every corner once
+		std::vector<uint64_t> hashes(count);
+		runParallel(threadCount, [&](size_t part) {
+			auto [begin, end] = partRange(count, threadCount, part);
+			for (size_t i = begin; i < end; i++) hashes[i] = hashBlock32(&corners[i]);
+		});
+
+		// 2) Bucket the corners by shard with a counting sort. Every part counts its corners per shard, the buckets
+		// are laid out shard after shard and part after part inside a shard, so each bucket stays in corner order
+		std::vector<size_t> bucketOffsets(static_cast<size_t>(threadCount) * threadCount, 0); // [part][shard]
+		runParallel(threadCount, [&](size_t part) {
+			auto [begin, end] = partRange(count, threadCount, part);
+			size_t* counts = &bucketOffsets[part * threadCount];
+			for (size_t i = begin; i < end; i++) counts[shardOf(hashes[i], threadCount)]++;
+		});
+		std::vector<size_t> shardBegin(threadCount + 1, 0);
+		size_t offset = 0;
+		for (unsigned shard = 0; shard < threadCount; shard++) {
+			shardBegin[shard] = offset;
+			for (unsigned part = 0; part < threadCount; part++) {
+				const size_t partCount = bucketOffsets[part * threadCount + shard];
+				bucketOffsets[part * threadCount + shard] = offset;
+				offset += partCount;
+			}
+		}
+		shardBegin[threadCount] = offset;
+		std::vector<uint32_t> bucketed(count);
+		runParallel(threadCount, [&](size_t part) {
+			auto [begin, end] = partRange(count, threadCount, part);
+			size_t* next = &bucketOffsets[part * threadCount];
+			for (size_t i = begin; i < end; i++) bucketed[next[shardOf(hashes[i], threadCount)]++] = static_cast<uint32_t>(i);
+		});
+
+		// 3) Every shard welds its own bucket. Equal vertices always share a shard, so no shard ever needs to look at
+		// another one
+		std::vector<VertexWelder> welders;
+		welders.reserve(threadCount);
+		for (unsigned shard = 0; shard < threadCount; shard++) welders.emplace_back((shardBegin[shard + 1] - shardBegin[shard]) / 4);
+		std::vector<uint32_t> localIndices(count);
+		std::vector<uint8_t> firstUse(count, 0);
+		runParallel(threadCount, [&](size_t shard) {
+			VertexWelder& welder = welders[shard];
+			for (size_t position = shardBegin[shard]; position < shardBegin[shard + 1]; position++) {
+				const uint32_t i = bucketed[position];
+				const size_t knownVertices = welder.vertices().size();
+				localIndices[i] = welder.weld(corners[i], hashes[i]);
+				firstUse[i] = localIndices[i] == knownVertices;
+			}
+		});
+
+		// 4) Number the unique vertices by their first use, which is the order the sequential weld produces
+		std::vector<size_t> firstUseBase(threadCount + 1, 0);
+		runParallel(threadCount, [&](size_t part) {
+			auto [begin, end] = partRange(count, threadCount, part);
+			size_t firstUses = 0;
+			for (size_t i = begin; i < end; i++) firstUses += firstUse[i];
+			firstUseBase[part + 1] = firstUses;
+		});
+		for (unsigned part = 0; part < threadCount; part++) firstUseBase[part + 1] += firstUseBase[part];
+
+		vertices.resize(firstUseBase[threadCount]);
+		std::vector<std::vector<uint32_t>> shardToGlobal(threadCount);
+		for (unsigned shard = 0; shard < threadCount; shard++) shardToGlobal[shard].resize(welders[shard].vertices().size());
+
+		runParallel(threadCount, [&](size_t part) {
+			auto [begin, end] = partRange(count, threadCount, part);
+			uint32_t next = static_cast<uint32_t>(firstUseBase[part]);
+			for (size_t i = begin; i < end; i++) {
+				if (!firstUse[i]) continue;
+				shardToGlobal[shardOf(hashes[i], threadCount)][localIndices[i]] = next;
+				vertices[next++] = corners[i];
+			}
+		});
+
+		// 5) Translate every shard local index into the global one
+		runParallel(threadCount, [&](size_t part) {
+			auto [begin, end] = partRange(count, threadCount, part);
+			for (size_t i = begin; i < end; i++) indices[i] = shardToGlobal[shardOf(hashes[i], threadCount)][localIndices[i]];
+		});
+	}
+}
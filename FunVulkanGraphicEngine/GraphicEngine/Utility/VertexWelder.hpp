@@ -0,0 +1,44 @@
+#pragma once
+
+#include "GraphicEngine/GraphicsVertex.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace GE::Util
+{
+	/// @brief Merges identical vertices into one entry and hands back its index.
+	/// Vertices are compared as raw 32 byte blocks. The table is a flat open addressing array with linear probing,
+	/// so a lookup is one hash plus a few cache friendly probes instead of node hopping
+	class VertexWelder
+	{
+	public:
+		explicit VertexWelder(size_t expectedUniqueVertices = 0);
+
+		/// @brief Single find-or-insert. Returns the index of the vertex in vertices()
+		uint32_t weld(const Vertex& vertex);
+		uint32_t weld(const Vertex& vertex, uint64_t hash);
+
+		const std::vector<Vertex>& vertices() const;
+		std::vector<Vertex> takeVertices();
+
+	private:
+		struct Slot
+		{
+			uint32_t tag; // upper half of the hash, lets most probes skip comparing the vertex
+			uint32_t index; // vertex index + 1, 0 marks an empty slot
+		};
+
+		void rehash(size_t slotCount);
+
+		std::vector<Slot> slots;
+		std::vector<Vertex> uniqueVertices;
+		size_t slotMask{ 0 };
+	};
+
+	/// @brief Welds a whole corner stream (one vertex per index) into unique vertices and an index list.
+	/// Large streams are hashed and welded on worker threads, sharded by hash. The output is identical to the
+	/// sequential one: vertices keep the order in which they are first referenced.
+	/// threadCount of 0 picks one from the hardware and the stream size
+	void weldVertices(const std::vector<Vertex>& corners, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, unsigned threadCount = 0);
+}
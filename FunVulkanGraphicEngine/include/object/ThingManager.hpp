@@ -4,6 +4,8 @@
 #include <mutex>
 #include <limits>
 #include <memory>
+#include <optional>
+#include <string>
 #include <unordered_map>
 
 #include "include/object/UID.hpp"
@@ -47,10 +49,15 @@ namespace MGE
 		ThingManager();
 		~ThingManager();
 
-		UID addThing(Point point);
+		/// @brief modelFile is an .obj or a glTF binary (.glb). A .glb is drawn with the base color texture it embeds
+		UID addThing(Point point, const std::string& modelFile = "models/viking_room.obj");
 
 		UID addTile(Point point, float radius, const Color& );
 
+		/// @brief With PRINT_ENGINE_STATS on, prints one line on what the tiles added so far cost, next to one 1x1 texture tile
+		/// created and timed for comparison
+		void printTileSummary();
+
 		//void setCamera(Point point, Rotation rotation);
 		//void rotateCamera(float x1, float x2, float y1, float y2);
 		//void moveCamera(Point point);
@@ -71,6 +78,18 @@ namespace MGE
 
 		std::unique_ptr<Camera> camera;
 
+		// addThing timings, split by whether the mesh had to be parsed (cold) or came from the mesh cache (warm)
+		struct LoadTiming { double totalMs; double meshMs; };
+		std::optional<LoadTiming> coldLoad;
+		std::optional<LoadTiming> warmLoad;
+
+		// addTile totals, allocations and bytes are the device memory the tiles created
+		struct TileStats { size_t tiles{ 0 }; size_t quads{ 0 }; double totalMs{ 0.0 }; size_t allocations{ 0 }; uint64_t bytes{ 0 }; };
+		TileStats tileStats;
+
+		// Texture each .glb added so far is drawn with, so the file is only looked into once
+		std::unordered_map<std::string, std::string> modelTextures;
+
 		//Point cameraPoint;
 		//float pitch{ 0 };
 		//float yaw{ 0 };
@@ -73,6 +73,7 @@ int main(int argc, char** argv) {
 			thingManager->addTile({ (float)i*Radius*2,(float)j * Radius * 2,0 }, Radius, colors.at(colorCounter++ % colors.size()));
 		}
 	}
+	thingManager->printTileSummary();
 
 	thingManager->addThing(MGE::Point(1, 0, 0));
 	thingManager->addThing(MGE::Point(1, 1, 0));
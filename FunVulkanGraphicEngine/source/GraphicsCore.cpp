@@ -67,6 +67,9 @@ namespace MGE
 		item->impl->commandPool = core->commandPool.getCommandPool();
 		item->impl->descriptorSetLayout = core->graphicPipelines.front()->Internals().descriptorSetLayout;
 		item->impl->controller = &core->graphicObjectController;
+		item->impl->textureLoader = &core->textureLoader;
+		item->impl->uploadBatch = &core->uploadBatch;
+		item->impl->textureAtlas = &core->textureAtlas;
 
 		return item;
 	}
@@ -5,9 +5,65 @@
 #include "GraphicEngine/GraphicsObjectController.hpp"
 #include "GraphicEngine/ThingManagerPIMPL.hpp"
 #include "GraphicEngine/PipelinesIdMapping.hpp"
+#include "GraphicEngine/Utility/GlbReader.hpp"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	double elapsedMs(Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); }
+
+	// The old 1x1 tile textures were sampled as SRGB, so convert to linear to keep the same look on screen
+	float srgbToLinear(uint8_t channel)
+	{
+		const float value = channel / 255.0f;
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	/// @brief Device memory behind the uniform buffers of a material, as the driver sized it
+	VkDeviceSize uniformMemory(VkDevice device, const GE::UBOInternal& ubo)
+	{
+		VkDeviceSize total = 0;
+		for (VkBuffer buffer : ubo.uniformBuffers) {
+			VkMemoryRequirements memoryRequirements;
+			vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
+			total += memoryRequirements.size;
+		}
+		return total;
+	}
+
+	/// @brief Stages level of the material's texture on the loader workers and uploads it with the next batch. Once it is
+	/// resident the next finer level follows, so a texture gains one level per frame at most until level 0 is in
+	void streamTextureLevel(const GE::ThingManagerPIMPL& handles, std::weak_ptr<GE::GraphicsMaterial> weakMaterial, std::string textureFile, uint32_t level, Clock::time_point loadStart)
+	{
+		handles.textureLoader->requestLevel(textureFile, level, [handles, weakMaterial, textureFile, level, loadStart](GE::StagedTexture& staged) {
+			auto material = weakMaterial.lock();
+			if (!material) return; // every thing using it was removed while streaming
+
+			auto onResident = [handles, weakMaterial, textureFile, level, loadStart]() {
+				auto material = weakMaterial.lock();
+				if (!material) return;
+				auto& texture = material->textureHandle();
+				if (!texture.setResidentLevel(level, handles.physicalDevice)) {
+					std::cout << "ERROR streaming texture " << textureFile << ": " << texture.getError() << std::endl;
+					return;
+				}
+				if (level > 0) streamTextureLevel(handles, weakMaterial, textureFile, level - 1, loadStart);
+				else if constexpr (GE::PRINT_ENGINE_STATS) std::cout << "Texture " << textureFile << " fully resident after " << elapsedMs(loadStart) << " ms" << std::endl;
+			};
+			if (!handles.uploadBatch->addLevels(staged, material->textureHandle(), std::move(onResident))) {
+				std::cout << "ERROR streaming texture " << textureFile << ": " << handles.uploadBatch->getError() << std::endl;
+			}
+		});
+	}
+}
+
 namespace MGE
 {
 
@@ -29,44 +85,124 @@ namespace MGE
 	ThingManager::ThingManager() : impl(nullptr), camera(new Camera()) { camera->setScreenSize(800, 600); }
 	ThingManager::~ThingManager() = default;
 
-	UID ThingManager::addThing(Point point)
+	UID ThingManager::addThing(Point point, const std::string& modelFile)
 	{
 		if (impl == nullptr) return UID::Empty();
 
 
 		auto optionList = impl->controller->getOptions();
+		// Things use the viking room texture, leave out the solid color pipelines
+		std::erase_if(optionList, [](const auto& option) { return !option.textured; });
 		if (optionList.empty())return UID::Empty();
 
 		// Currently Random to test multiple pipelines
 		auto itemControls = optionList[ idsToPoints.size() % optionList.size()];
 
 
-		std::string objectName = "models/viking_room.obj";
+		std::string objectName = modelFile;
 		std::string textureName = "textures/viking_room.png";
+		// Embedded images go through the texture loader like files, under a path naming the image inside the .glb
+		if (GE::Util::GlbFile::isGlb(objectName)) {
+			auto [iter, inserted] = modelTextures.try_emplace(objectName, textureName);
+			if (inserted) {
+				GE::Util::GlbFile glb;
+				if (glb.open(objectName) && glb.baseColorImage() >= 0) iter->second = GE::Util::GlbFile::imagePath(objectName, static_cast<uint32_t>(glb.baseColorImage()));
+			}
+			textureName = iter->second;
+		}
 
+		const auto loadStart = Clock::now();
 		uint64_t thisId = impl->controller->createObject(itemControls.pipelineId);
 		auto objectPtr = impl->controller->retrieveObject(thisId);
 
 
 
+		// Every Thing draws the same model, so only the first one pays for parsing and uploading it
+		bool meshLoaded = false;
 		{
-			bool state = objectPtr->verticesHandle.init(objectName, impl->device, impl->physicalDevice, impl->queue, itemControls.commandPool, itemControls.descriptorSetLayout);
-			if (!state) {
+			objectPtr->verticesHandle = impl->controller->acquireMesh(GE::GraphicsMeshRegistry::keyForFile(objectName, itemControls.vertexLayout), [&](GE::VerticesHandle& mesh) {
+				meshLoaded = true;
+				return mesh.init(objectName, impl->device, impl->physicalDevice, impl->queue, itemControls.commandPool, itemControls.descriptorSetLayout, itemControls.vertexLayout);
+			});
+			if (!objectPtr->verticesHandle) {
+				std::cout << "ERROR loading mesh " << objectName << ": " << impl->controller->getMeshError() << std::endl;
+				impl->controller->remove(thisId);
 				return UID::Empty();
 			}
 		}
-
-
-		{
-			bool state = objectPtr->textureHandle.init(textureName, impl->device, impl->physicalDevice, impl->queue, itemControls.commandPool, itemControls.descriptorSetLayout);
-			if (!state) {
-				return UID::Empty();
-			}
+		const double meshMs = elapsedMs(loadStart);
+
+
+		// Things with the same pipeline and texture share one material, only the first one loads the texture.
+		// Decoding happens on the loader workers, the upload joins the render thread's batch for that frame.
+		// The material is drawn once the batch went through. Baked textures start with their small mip tail, so that
+		// takes the same time for any texture size, and stream the finer levels in afterwards
+		GE::MaterialDescription materialDescription;
+		materialDescription.pipelineId = itemControls.pipelineId;
+		materialDescription.textureFile = textureName;
+		bool materialCreated = false;
+		objectPtr->material = impl->controller->acquireMaterial(materialDescription, [&](GE::GraphicsMaterial&) { materialCreated = true; return true; });
+		if (materialCreated) {
+			// The callbacks hold a copy of the handles, this ThingManager does not have to outlive the request
+			std::weak_ptr<GE::GraphicsMaterial> weakMaterial = objectPtr->material;
+			impl->textureLoader->request(textureName, [handles = *impl, weakMaterial, itemControls, loadStart](GE::StagedTexture& staged) {
+				auto material = weakMaterial.lock();
+				if (!material) return; // every thing using it was removed while its texture was decoding
+
+				auto onReady = [handles, weakMaterial, loadStart](GE::GraphicsTextureHandle& texture) {
+					auto material = weakMaterial.lock();
+					if (!texture.isReady() || !material) {
+						if (!texture.isReady()) std::cout << "ERROR loading texture " << texture.Internals().texture.textureFile << ": " << texture.getError() << std::endl;
+						texture.Free();
+						return;
+					}
+					material->setTexture(texture);
+					const uint32_t residentLevel = texture.Internals().texture.residentLevel;
+					if constexpr (GE::PRINT_ENGINE_STATS) {
+						std::cout << "Texture " << texture.Internals().texture.textureFile << " ready after " << elapsedMs(loadStart) << " ms";
+						if (residentLevel > 0) std::cout << " (mip " << residentLevel << " and coarser, streaming the rest)";
+						std::cout << std::endl;
+					}
+					if (residentLevel > 0) streamTextureLevel(handles, weakMaterial, texture.Internals().texture.textureFile, residentLevel - 1, loadStart);
+				};
+				// Small decoded textures share atlas pages instead of getting an image each, unless they repeat
+				if (!material->description().tiling && handles.textureAtlas->accepts(staged)) {
+					if (!handles.textureAtlas->addTexture(staged, itemControls.descriptorSetLayout, std::move(onReady))) {
+						std::cout << "ERROR loading texture " << staged.textureFile << ": " << handles.textureAtlas->getError() << std::endl;
+					}
+				}
+				else if (!handles.uploadBatch->addTexture(staged, itemControls.descriptorSetLayout, std::move(onReady))) {
+					std::cout << "ERROR loading texture " << staged.textureFile << ": " << handles.uploadBatch->getError() << std::endl;
+				}
+			}, GE::TEXTURE_STREAM_TAIL_SIZE, materialDescription.usage);
+		}
+		else if constexpr (GE::PRINT_ENGINE_STATS) {
+			std::cout << "addThing reused material of " << textureName << " (" << impl->controller->materialCount() << " materials alive)" << std::endl;
 		}
 
 
 		std::cout << "Finish uploading ubo to thing " << thisId << std::endl;
 
+		if constexpr (GE::PRINT_ENGINE_STATS) {
+			if (!meshLoaded) {
+				std::cout << "addThing reused shared mesh " << objectName << " (" << impl->controller->meshCount() << " meshes alive)" << std::endl;
+			}
+			else {
+				const bool warm = objectPtr->verticesHandle->loadedFromCache();
+				(warm ? warmLoad : coldLoad) = LoadTiming{ elapsedMs(loadStart), meshMs };
+
+				auto printTiming = [](const std::optional<LoadTiming>& timing) {
+					if (!timing) { std::cout << "n/a"; return; }
+					std::cout << timing->totalMs << " ms (mesh " << timing->meshMs << " ms)";
+				};
+				std::cout << "addThing " << (warm ? "warm" : "cold") << " load. cold: ";
+				printTiming(coldLoad);
+				std::cout << " | warm: ";
+				printTiming(warmLoad);
+				std::cout << std::endl;
+			}
+		}
+
 		updateThing(UID::Create(thisId), point);
 
 		idsToPoints[UID::Create(thisId)] = point;
@@ -76,74 +212,73 @@ namespace MGE
 
 	UID ThingManager::addTile(Point point, float scale, const Color& color)
 	{
+		const auto loadStart = Clock::now();
 
+		// Tiles are a single color, so they go through the solid pipeline. The color lives in the vertices
+		// which means no image, sampler or staging upload per tile
+		auto optionList = impl->controller->getOptions();
+		auto solidOption = std::find_if(optionList.begin(), optionList.end(), [](const auto& option) { return !option.textured; });
+		if (solidOption == optionList.end()) {
+			std::cout << "ERROR no solid color pipeline to draw tiles with" << std::endl;
+			return UID::Empty();
+		}
 
 		//point.z = 0;
+		const glm::vec3 tileColor(srgbToLinear(color.red), srgbToLinear(color.green), srgbToLinear(color.blue));
 
 		//float scale = 5;
-		const std::vector<GE::Vertex> vertices = {
-			{{-scale, -scale,0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 0.0f}},
-			{{scale, -scale,0.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f}},
-			{{scale, scale,0.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f}},
-			{{-scale, scale,0.0f}, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f}},
-			
-			{{-scale, -scale, 0}, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f}},
-			{{-scale, scale, 0}, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f}},
-			{{-scale, scale, scale}, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f}},
-			{{-scale, -scale, scale}, {0.0f, 0.0f, 0.0f}, {1.0f, 1.0f}},
-
-
-
-
-
-		};
-		const std::vector<uint32_t> indices = {
+		// On the stack, the upload packs them straight into staging memory
+		const std::array<GE::Vertex, 4> vertices = { {
+			{{-scale, -scale,0.0f}, tileColor, {1.0f, 0.0f}},
+			{{scale, -scale,0.0f}, tileColor, {0.0f, 0.0f}},
+			{{scale, scale,0.0f}, tileColor, {0.0f, 1.0f}},
+			{{-scale, scale,0.0f}, tileColor, {1.0f, 1.0f}},
+		} };
+		const std::array<uint32_t, 6> indices = {
 			0, 1, 2, 2, 3, 0
-			//,
-			//4, 5, 6, 6, 7, 4
 		};
 
 
-
-
-		GE::TextureMetaData texture;
-		std::vector<unsigned char> colorD;// = { 0x00, 0xFF,0x00,0xFF };
-		color.attachTo(colorD);
-		texture.imageData = colorD.data();
-		texture.pictureHeight = 1;
-		texture.pictureWidth = 1;
-		texture.pixelSize = 4;
-
-
-		size_t indexPicked = 2;
-		auto & idsMappings = GE::PipelinesIdMapping::getInstance();
-		for (auto& metaData : idsMappings.getMetadataList())
-		{
-			if (metaData.second.pipelineName == "default")
-			{
-				indexPicked = metaData.first;
-				break;
-			}
-		}
-
-		std::string objectName = "models/viking_room.obj";
-		uint64_t thisId = impl->controller->createObject(indexPicked);
+		uint64_t thisId = impl->controller->createObject(solidOption->pipelineId);
 		auto objectPtr = impl->controller->retrieveObject(thisId);
+		bool createdMesh = false;
 		{
-			bool state = objectPtr->verticesHandle.init(vertices, indices, impl->device, impl->physicalDevice, impl->queue, impl->commandPool, impl->descriptorSetLayout);
-			if (!state) {
+			// Tiles of the same scale and color share one quad. Nothing to cull on a quad, so nothing stays on the host
+			objectPtr->verticesHandle = impl->controller->acquireMesh(GE::GraphicsMeshRegistry::keyForContent(vertices, indices, solidOption->vertexLayout, GE::MeshResidency::Discard), [&](GE::VerticesHandle& mesh) {
+				createdMesh = true;
+				return mesh.init(std::span<const GE::Vertex>(vertices), std::span<const uint32_t>(indices), impl->device, impl->physicalDevice, impl->queue, solidOption->commandPool, solidOption->descriptorSetLayout, solidOption->vertexLayout, GE::MeshResidency::Discard);
+			});
+			if (!objectPtr->verticesHandle) {
+				std::cout << "ERROR loading tile mesh: " << impl->controller->getMeshError() << std::endl;
+				impl->controller->remove(thisId);
 				return UID::Empty();
 			}
 		}
+		bool createdMaterial = false;
 		{
-			bool state = objectPtr->textureHandle.init(texture, impl->device, impl->physicalDevice, impl->queue, impl->commandPool, impl->descriptorSetLayout);
-			if (!state) {
+			// Every tile of the solid pipeline shares the material, the color is in the vertices
+			GE::MaterialDescription materialDescription;
+			materialDescription.pipelineId = solidOption->pipelineId;
+			objectPtr->material = impl->controller->acquireMaterial(materialDescription, [&](GE::GraphicsMaterial& material) {
+				createdMaterial = true;
+				return material.textureHandle().initUntextured(impl->device, impl->physicalDevice, solidOption->descriptorSetLayout);
+			});
+			if (!objectPtr->material) {
+				std::cout << "ERROR creating tile material: " << impl->controller->getMaterialError() << std::endl;
+				impl->controller->remove(thisId);
 				return UID::Empty();
 			}
 		}
 
 
-		std::cout << "Finish uploading ubo to thing " << thisId << std::endl;
+		tileStats.tiles++;
+		tileStats.totalMs += elapsedMs(loadStart);
+		if (createdMesh) tileStats.quads++;
+		if (createdMaterial) {
+			const auto& ubo = objectPtr->material->textureHandle().Internals().ubo;
+			tileStats.allocations += ubo.uniformBuffersMemory.size();
+			tileStats.bytes += uniformMemory(impl->device, ubo);
+		}
 
 
 
@@ -161,6 +296,43 @@ namespace MGE
 
 	}
 
+	void ThingManager::printTileSummary()
+	{
+		if (!GE::PRINT_ENGINE_STATS || impl == nullptr || tileStats.tiles == 0) return;
+
+		std::cout << "Tiles: " << tileStats.tiles << " in " << tileStats.totalMs << " ms (" << tileStats.totalMs / tileStats.tiles << " ms each), "
+			<< tileStats.quads << " quads, " << tileStats.allocations << " allocations of " << tileStats.bytes << " bytes for uniforms, no images";
+
+		// Tiles used to be a 1x1 texture each. Build one the way they were built and measure what it takes
+		auto optionList = impl->controller->getOptions();
+		auto texturedOption = std::find_if(optionList.begin(), optionList.end(), [](const auto& option) { return option.textured; });
+		if (texturedOption != optionList.end()) {
+			std::vector<unsigned char> pixel;
+			Color(0x00, 0xFF, 0x00, 0xFF).attachTo(pixel);
+			GE::TextureMetaData metaData;
+			metaData.imageData = pixel.data();
+			metaData.pictureWidth = 1;
+			metaData.pictureHeight = 1;
+
+			GE::GraphicsTextureHandle texture;
+			const auto textureStart = Clock::now();
+			if (texture.init(metaData, impl->device, impl->physicalDevice, impl->queue, texturedOption->commandPool, texturedOption->descriptorSetLayout)) {
+				const double textureMs = elapsedMs(textureStart);
+				const auto& internals = texture.Internals();
+				const size_t allocations = (internals.texture.textureImageMemory != VK_NULL_HANDLE ? 1 : 0) + internals.ubo.uniformBuffersMemory.size();
+				const VkDeviceSize bytes = internals.texture.memorySize + uniformMemory(impl->device, internals.ubo);
+				std::cout << ". A 1x1 texture tile takes " << textureMs << " ms, " << allocations << " allocations of " << bytes << " bytes"
+					<< " and an image view and sampler of its own, " << tileStats.tiles << " of them "
+					<< textureMs * tileStats.tiles << " ms and " << allocations * tileStats.tiles << " allocations";
+			}
+			else {
+				std::cout << ". Could not build a 1x1 texture tile to compare: " << texture.getError();
+			}
+			texture.Free();
+		}
+		std::cout << std::endl;
+	}
+
 	void ThingManager::updateThing(UID id, Point point)
 	{
 		glm::vec3 cameraUp = glm::vec3(0.0f, 0.0f, 1.0f);
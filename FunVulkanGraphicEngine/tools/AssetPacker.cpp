@@ -0,0 +1,67 @@
+// Offline builder for the engine asset pack (.gepk).
+// Walks the given directories and stores every file under its path relative to the root, so the engine finds
+// "shaders/vert.spv" in the pack exactly where it would look on disk.
+//
+// usage: AssetPacker <output.gepk> <directory>... [--root <dir>]
+// root defaults to the current directory
+
+#include "GraphicEngine/Utility/AssetPack.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	int printUsage()
+	{
+		std::cout << "usage: AssetPacker <output.gepk> <directory>... [--root <dir>]" << std::endl;
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	namespace fs = std::filesystem;
+	std::string outputPath;
+	std::vector<std::string> directories;
+	fs::path root = fs::current_path();
+	for (int i = 1; i < argc; i++) {
+		const std::string argument = argv[i];
+		if (argument == "--root" && i + 1 < argc) { root = argv[++i]; }
+		else if (outputPath.empty()) { outputPath = argument; }
+		else { directories.push_back(argument); }
+	}
+	if (outputPath.empty() || directories.empty()) return printUsage();
+
+	const auto start = std::chrono::steady_clock::now();
+
+	std::vector<GE::Util::AssetPackInput> inputs;
+	for (const auto& directory : directories) {
+		const fs::path base = root / directory;
+		std::error_code errorCode;
+		if (!fs::is_directory(base, errorCode)) {
+			std::cout << "ERROR " << base.string() << " is not a directory" << std::endl;
+			return 1;
+		}
+		for (const auto& item : fs::recursive_directory_iterator(base, errorCode)) {
+			if (!item.is_regular_file()) continue;
+			// Leftovers of an interrupted cache write
+			if (item.path().extension() == ".tmp") continue;
+			inputs.push_back({ fs::relative(item.path(), root).generic_string(), item.path().string() });
+		}
+	}
+
+	GE::Util::AssetPackReport report;
+	if (auto errorMessage = GE::Util::AssetPack::write(outputPath, std::move(inputs), &report); !errorMessage.empty()) {
+		std::cout << "ERROR " << errorMessage << std::endl;
+		return 1;
+	}
+
+	std::cout << "Packed " << report.entries << " files (" << report.compressedEntries << " compressed) into " << outputPath << ": "
+		<< report.inputBytes / 1024 << " KB -> " << report.storedBytes / 1024 << " KB in "
+		<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+	return 0;
+}
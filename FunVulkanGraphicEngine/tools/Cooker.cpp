@@ -0,0 +1,249 @@
+// Offline asset cooker. Walks an asset directory and writes everything the engine would otherwise build the first time
+// it loads an asset, so the runtime never parses text formats or generates mips:
+//   *.obj                    -> <output>/<path>.meshcache (welded, optimized, with lods)
+//   *.png *.jpg *.jpeg *.tga -> <output>/<path>.gtex (whole mip chain, block compressed)
+//   *.vert *.frag *.comp     -> <output>/shaders/<name>.spv through glslc
+// Inputs are cooked in parallel on every core. A manifest in the output directory remembers the content hash of every
+// input and the version it was cooked with, inputs where both still match are skipped.
+//
+// usage: FunVulkanGraphicEngineCooker <asset directory> <output directory> [--threads n] [--force] [--glslc path]
+
+#include "GraphicEngine/ConstDefines.hpp"
+#include "GraphicEngine/Utility/FileMapping.hpp"
+#include "GraphicEngine/Utility/Hashing.hpp"
+#include "GraphicEngine/Utility/MeshCache.hpp"
+#include "GraphicEngine/Utility/MeshImport.hpp"
+#include "GraphicEngine/Utility/TextureBaker.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+namespace
+{
+	namespace fs = std::filesystem;
+
+	// Bump whenever a cooking step changes its output. The formats carry their own versions on top of it and the
+	// ConstDefines knobs that shape a cooked mesh are part of the version too, so changing one recooks every mesh
+	constexpr uint32_t CookerVersion = 1;
+	constexpr const char* ManifestName = ".cookmanifest";
+
+	// The names the engine loads compiled shaders by, same as the compile scripts. Anything else becomes <file>.spv
+	const std::map<std::string, std::string> ShaderOutputNames = {
+		{ "shader.vert", "vert.spv" },
+		{ "shader.frag", "frag.spv" },
+		{ "shader_solid.frag", "fragSolid.spv" },
+		{ "shader_alterColor.frag", "fragAlter.spv" },
+	};
+
+	enum class JobKind { Mesh, Texture, Shader };
+
+	struct Job
+	{
+		JobKind kind;
+		fs::path source;
+		fs::path output;
+		std::string key; // path relative to the asset directory, how the manifest knows the input
+		uint64_t contentHash{ 0 };
+		bool skipped{ false };
+		std::string error;
+	};
+
+	std::string cookVersion()
+	{
+		return std::to_string(CookerVersion) + "." + std::to_string(GE::Util::MeshCache::Version) + "." + std::to_string(GE::Util::TextureContainer::Version)
+			+ ".o" + std::to_string(GE::OPTIMIZE_IMPORTED_MESHES ? 1 : 0) + ".l" + std::to_string(GE::MESH_LOD_LEVELS)
+			+ ".c" + std::to_string(GE::MESH_CLUSTER_MAX_VERTICES) + "x" + std::to_string(GE::MESH_CLUSTER_MAX_TRIANGLES);
+	}
+
+	bool classify(const fs::path& relative, const fs::path& outputDirectory, Job& job)
+	{
+		std::string extension = relative.extension().string();
+		for (auto& character : extension) character = static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+
+		if (extension == ".obj") {
+			job.kind = JobKind::Mesh;
+			job.output = outputDirectory / (relative.generic_string() + GE::Util::MeshCache::Extension);
+		}
+		else if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga") {
+			job.kind = JobKind::Texture;
+			job.output = outputDirectory / fs::path(relative).replace_extension(GE::Util::TextureContainer::Extension);
+		}
+		else if (extension == ".vert" || extension == ".frag" || extension == ".comp") {
+			job.kind = JobKind::Shader;
+			const std::string fileName = relative.filename().string();
+			const auto named = ShaderOutputNames.find(fileName);
+			job.output = outputDirectory / "shaders" / (named != ShaderOutputNames.end() ? named->second : fileName + ".spv");
+		}
+		else return false;
+		return true;
+	}
+
+	/// @brief path -> "version hash" of the last successful cook
+	std::map<std::string, std::string> readManifest(const fs::path& path)
+	{
+		std::map<std::string, std::string> entries;
+		std::ifstream input(path);
+		std::string version, hash, key;
+		// One entry per line: version, hash in hex, then the relative path which may contain spaces
+		while (input >> version >> hash && std::getline(input >> std::ws, key)) entries[key] = version + " " + hash;
+		return entries;
+	}
+
+	std::string hexOf(uint64_t value)
+	{
+		std::ostringstream stream;
+		stream << std::hex << value;
+		return stream.str();
+	}
+
+	std::string cookMesh(const Job& job)
+	{
+		std::vector<GE::Vertex> vertices;
+		std::vector<uint32_t> indices;
+		std::vector<GE::MeshLod> lods;
+		std::vector<GE::MeshCluster> clusters;
+		// Every core already cooks an input of its own, a parse or weld spreading over all of them again only oversubscribes
+		if (auto errorMessage = GE::Util::importObjMesh(job.source.string(), vertices, indices, lods, clusters, 1); !errorMessage.empty()) return errorMessage;
+		return GE::Util::MeshCache::write(job.source.string(), vertices, indices, lods, clusters, job.output.string());
+	}
+
+	std::string cookShader(const Job& job, const std::string& glslc)
+	{
+		const std::string command = "\"" + glslc + "\" \"" + job.source.string() + "\" -o \"" + job.output.string() + "\"";
+		if (std::system(command.c_str()) != 0) return "glslc failed on " + job.source.string();
+		return "";
+	}
+
+	std::string findGlslc()
+	{
+		if (const char* sdk = std::getenv("VULKAN_SDK")) {
+			for (const char* name : { "bin/glslc", "bin/glslc.exe", "Bin/glslc.exe" }) {
+				std::error_code errorCode;
+				if (fs::exists(fs::path(sdk) / name, errorCode)) return (fs::path(sdk) / name).string();
+			}
+		}
+		return "glslc"; // hope it is on the path
+	}
+
+	int printUsage()
+	{
+		std::cout << "usage: FunVulkanGraphicEngineCooker <asset directory> <output directory> [--threads n] [--force] [--glslc path]" << std::endl;
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	fs::path assetDirectory;
+	fs::path outputDirectory;
+	unsigned threadCount = 0;
+	bool force = false;
+	std::string glslc;
+	for (int i = 1; i < argc; i++) {
+		const std::string argument = argv[i];
+		if (argument == "--threads" && i + 1 < argc) { threadCount = static_cast<unsigned>(std::stoul(argv[++i])); }
+		else if (argument == "--force") { force = true; }
+		else if (argument == "--glslc" && i + 1 < argc) { glslc = argv[++i]; }
+		else if (assetDirectory.empty()) { assetDirectory = argument; }
+		else if (outputDirectory.empty()) { outputDirectory = argument; }
+		else { return printUsage(); }
+	}
+	if (assetDirectory.empty() || outputDirectory.empty()) return printUsage();
+	if (glslc.empty()) glslc = findGlslc();
+
+	const auto start = std::chrono::steady_clock::now();
+	std::error_code errorCode;
+	if (!fs::is_directory(assetDirectory, errorCode)) {
+		std::cout << "ERROR " << assetDirectory.string() << " is not a directory" << std::endl;
+		return 1;
+	}
+	const fs::path outputRoot = fs::weakly_canonical(outputDirectory, errorCode);
+
+	std::vector<Job> jobs;
+	for (const auto& item : fs::recursive_directory_iterator(assetDirectory, errorCode)) {
+		if (!item.is_regular_file()) continue;
+		// The output may sit inside the asset directory, its files are not inputs
+		const fs::path canonical = fs::weakly_canonical(item.path(), errorCode);
+		if (canonical.generic_string().rfind(outputRoot.generic_string() + "/", 0) == 0) continue;
+
+		Job job;
+		job.source = item.path();
+		const fs::path relative = fs::relative(item.path(), assetDirectory);
+		job.key = relative.generic_string();
+		if (classify(relative, outputDirectory, job)) jobs.push_back(std::move(job));
+	}
+
+	const fs::path manifestPath = outputDirectory / ManifestName;
+	const auto manifest = force ? std::map<std::string, std::string>() : readManifest(manifestPath);
+	const std::string version = cookVersion();
+
+	std::mutex printMutex;
+	std::atomic<size_t> nextJob{ 0 };
+	auto worker = [&]() {
+		for (size_t index = nextJob++; index < jobs.size(); index = nextJob++) {
+			Job& job = jobs[index];
+			GE::Util::MappedFile source;
+			if (!source.open(job.source.string())) {
+				job.error = std::string(source.getError());
+				std::lock_guard<std::mutex> lock(printMutex);
+				std::cout << "ERROR " << job.key << ": " << job.error << std::endl;
+				continue;
+			}
+			job.contentHash = GE::Util::hashBytes(source.data(), source.size());
+			source.close();
+
+			const auto known = manifest.find(job.key);
+			std::error_code existsError;
+			if (known != manifest.end() && known->second == version + " " + hexOf(job.contentHash) && fs::exists(job.output, existsError)) { job.skipped = true; continue; }
+
+			fs::create_directories(job.output.parent_path(), existsError);
+			const auto jobStart = std::chrono::steady_clock::now();
+			switch (job.kind) {
+			case JobKind::Mesh: job.error = cookMesh(job); break;
+			case JobKind::Texture: job.error = GE::Util::bakeTexture(job.source.string(), job.output.string(), std::nullopt); break;
+			case JobKind::Shader: job.error = cookShader(job, glslc); break;
+			}
+
+			std::lock_guard<std::mutex> lock(printMutex);
+			if (!job.error.empty()) std::cout << "ERROR " << job.key << ": " << job.error << std::endl;
+			else std::cout << "Cooked " << job.key << " -> " << job.output.generic_string() << " in " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - jobStart).count() << " ms" << std::endl;
+		}
+	};
+
+	if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+	threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, std::max<size_t>(1, jobs.size())));
+	std::vector<std::thread> workers;
+	for (unsigned i = 1; i < threadCount; i++) workers.emplace_back(worker);
+	worker();
+	for (auto& thread : workers) thread.join();
+
+	// Failed inputs stay out of the manifest, so the next run tries them again
+	size_t cooked = 0, skipped = 0, failed = 0;
+	fs::create_directories(outputDirectory, errorCode);
+	std::ofstream output(manifestPath, std::ios::trunc);
+	for (const auto& job : jobs) {
+		if (!job.error.empty()) { failed++; continue; }
+		job.skipped ? skipped++ : cooked++;
+		output << version << " " << hexOf(job.contentHash) << " " << job.key << "\n";
+	}
+	if (!output.good()) std::cout << "WARNING failed to write " << manifestPath.string() << ", the next run cooks everything again" << std::endl;
+
+	std::cout << "Cooked " << cooked << ", skipped " << skipped << " unchanged, " << failed << " failed on " << threadCount << " threads in "
+		<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,337 @@
+// Counts the heap allocations of creating meshes through the engine, GraphicsMeshRegistry::acquire and
+// VerticesHandle::init, without a GPU. A global operator new tallies every allocation. The vulkan entry points the mesh
+// code reaches are defined below as a fake device: objects are malloc'd records, memory is host memory and fences are
+// signaled right away, so nothing the driver would allocate shows up in the counts. The engine is set up the way the
+// renderer sets it up, with a staging ring and the shared upload batch that is flushed and polled once per frame.
+// Tiles go in the way addTile hands them over (spans of a stack array) and the way it used to (vectors taken by value),
+// a generated grid goes in both ways too. Link against glfw but not against the vulkan loader.
+//
+// usage: MeshIngestAllocations [--meshes n] [--grid n]
+
+#include "GraphicEngine/GraphicsMeshRegistry.hpp"
+#include "GraphicEngine/GraphicsUploadBatch.hpp"
+#include "GraphicEngine/Utility/StagingRing.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace
+{
+	std::atomic<size_t> allocationCount{ 0 };
+	std::atomic<size_t> allocatedBytes{ 0 };
+}
+
+void* operator new(std::size_t size)
+{
+	allocationCount++;
+	allocatedBytes += size;
+	if (void* pointer = std::malloc(size == 0 ? 1 : size)) return pointer;
+	throw std::bad_alloc();
+}
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+namespace
+{
+	std::atomic<uintptr_t> nextHandle{ 1 };
+
+	/// @brief Handles nothing looks into, a counter is enough
+	template<typename Handle>
+	Handle fakeHandle() { return (Handle)(nextHandle++); }
+
+	/// @brief Buffers and images remember their size, memory is the mapped host memory itself
+	template<typename Handle>
+	Handle recordHandle(VkDeviceSize size)
+	{
+		auto* record = static_cast<VkDeviceSize*>(std::malloc(sizeof(VkDeviceSize)));
+		*record = size;
+		return (Handle)reinterpret_cast<uintptr_t>(record);
+	}
+
+	template<typename Handle>
+	VkDeviceSize recordSize(Handle handle) { return *reinterpret_cast<VkDeviceSize*>((uintptr_t)handle); }
+
+	template<typename Handle>
+	void freeRecord(Handle handle) { if (handle != 0) std::free(reinterpret_cast<void*>((uintptr_t)handle)); }
+}
+
+// The fake device. Only what the mesh, staging and upload batch code calls does anything, the rest is there to link
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceProperties(VkPhysicalDevice, VkPhysicalDeviceProperties* pProperties)
+{
+	*pProperties = VkPhysicalDeviceProperties{};
+	pProperties->limits.optimalBufferCopyOffsetAlignment = 1;
+	pProperties->limits.nonCoherentAtomSize = 1;
+	pProperties->limits.maxSamplerAnisotropy = 1.0f;
+}
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties(VkPhysicalDevice, VkPhysicalDeviceMemoryProperties* pMemoryProperties)
+{
+	*pMemoryProperties = VkPhysicalDeviceMemoryProperties{};
+	pMemoryProperties->memoryTypeCount = 1;
+	pMemoryProperties->memoryTypes[0].propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	pMemoryProperties->memoryHeapCount = 1;
+	pMemoryProperties->memoryHeaps[0].size = 1ull << 34;
+}
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceFeatures(VkPhysicalDevice, VkPhysicalDeviceFeatures* pFeatures) { *pFeatures = VkPhysicalDeviceFeatures{}; }
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceFormatProperties(VkPhysicalDevice, VkFormat, VkFormatProperties* pFormatProperties) { *pFormatProperties = VkFormatProperties{}; }
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateInstanceExtensionProperties(const char*, uint32_t* pPropertyCount, VkExtensionProperties*) { *pPropertyCount = 0; return VK_SUCCESS; }
+VKAPI_ATTR VkResult VKAPI_CALL vkEnumerateDeviceExtensionProperties(VkPhysicalDevice, const char*, uint32_t* pPropertyCount, VkExtensionProperties*) { *pPropertyCount = 0; return VK_SUCCESS; }
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice, uint32_t* pQueueFamilyPropertyCount, VkQueueFamilyProperties*) { *pQueueFamilyPropertyCount = 0; }
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceSupportKHR(VkPhysicalDevice, uint32_t, VkSurfaceKHR, VkBool32* pSupported) { *pSupported = VK_FALSE; return VK_SUCCESS; }
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceCapabilitiesKHR(VkPhysicalDevice, VkSurfaceKHR, VkSurfaceCapabilitiesKHR* pSurfaceCapabilities) { *pSurfaceCapabilities = VkSurfaceCapabilitiesKHR{}; return VK_SUCCESS; }
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceFormatsKHR(VkPhysicalDevice, VkSurfaceKHR, uint32_t* pSurfaceFormatCount, VkSurfaceFormatKHR*) { *pSurfaceFormatCount = 0; return VK_SUCCESS; }
+VKAPI_ATTR VkResult VKAPI_CALL vkGetPhysicalDeviceSurfacePresentModesKHR(VkPhysicalDevice, VkSurfaceKHR, uint32_t* pPresentModeCount, VkPresentModeKHR*) { *pPresentModeCount = 0; return VK_SUCCESS; }
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateBuffer(VkDevice, const VkBufferCreateInfo* pCreateInfo, const VkAllocationCallbacks*, VkBuffer* pBuffer) { *pBuffer = recordHandle<VkBuffer>(pCreateInfo->size); return VK_SUCCESS; }
+VKAPI_ATTR void VKAPI_CALL vkDestroyBuffer(VkDevice, VkBuffer buffer, const VkAllocationCallbacks*) { freeRecord(buffer); }
+VKAPI_ATTR void VKAPI_CALL vkGetBufferMemoryRequirements(VkDevice, VkBuffer buffer, VkMemoryRequirements* pMemoryRequirements)
+{
+	pMemoryRequirements->size = (recordSize(buffer) + 255) / 256 * 256;
+	pMemoryRequirements->alignment = 256;
+	pMemoryRequirements->memoryTypeBits = 1;
+}
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateImage(VkDevice, const VkImageCreateInfo* pCreateInfo, const VkAllocationCallbacks*, VkImage* pImage)
+{
+	*pImage = recordHandle<VkImage>(4ull * pCreateInfo->extent.width * pCreateInfo->extent.height * 2);
+	return VK_SUCCESS;
+}
+VKAPI_ATTR void VKAPI_CALL vkDestroyImage(VkDevice, VkImage image, const VkAllocationCallbacks*) { freeRecord(image); }
+VKAPI_ATTR void VKAPI_CALL vkGetImageMemoryRequirements(VkDevice, VkImage image, VkMemoryRequirements* pMemoryRequirements)
+{
+	pMemoryRequirements->size = (recordSize(image) + 4095) / 4096 * 4096;
+	pMemoryRequirements->alignment = 4096;
+	pMemoryRequirements->memoryTypeBits = 1;
+}
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateMemory(VkDevice, const VkMemoryAllocateInfo* pAllocateInfo, const VkAllocationCallbacks*, VkDeviceMemory* pMemory)
+{
+	void* memory = std::calloc(1, static_cast<size_t>(pAllocateInfo->allocationSize));
+	if (memory == nullptr) return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+	*pMemory = (VkDeviceMemory)reinterpret_cast<uintptr_t>(memory);
+	return VK_SUCCESS;
+}
+VKAPI_ATTR void VKAPI_CALL vkFreeMemory(VkDevice, VkDeviceMemory memory, const VkAllocationCallbacks*) { freeRecord(memory); }
+VKAPI_ATTR VkResult VKAPI_CALL vkBindBufferMemory(VkDevice, VkBuffer, VkDeviceMemory, VkDeviceSize) { return VK_SUCCESS; }
+VKAPI_ATTR VkResult VKAPI_CALL vkBindImageMemory(VkDevice, VkImage, VkDeviceMemory, VkDeviceSize) { return VK_SUCCESS; }
+VKAPI_ATTR VkResult VKAPI_CALL vkMapMemory(VkDevice, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize, VkMemoryMapFlags, void** ppData)
+{
+	*ppData = reinterpret_cast<char*>((uintptr_t)memory) + offset;
+	return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateImageView(VkDevice, const VkImageViewCreateInfo*, const VkAllocationCallbacks*, VkImageView* pView) { *pView = fakeHandle<VkImageView>(); return VK_SUCCESS; }
+VKAPI_ATTR void VKAPI_CALL vkDestroyImageView(VkDevice, VkImageView, const VkAllocationCallbacks*) {}
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateSampler(VkDevice, const VkSamplerCreateInfo*, const VkAllocationCallbacks*, VkSampler* pSampler) { *pSampler = fakeHandle<VkSampler>(); return VK_SUCCESS; }
+VKAPI_ATTR void VKAPI_CALL vkDestroySampler(VkDevice, VkSampler, const VkAllocationCallbacks*) {}
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateDescriptorPool(VkDevice, const VkDescriptorPoolCreateInfo*, const VkAllocationCallbacks*, VkDescriptorPool* pDescriptorPool) { *pDescriptorPool = fakeHandle<VkDescriptorPool>(); return VK_SUCCESS; }
+VKAPI_ATTR void VKAPI_CALL vkDestroyDescriptorPool(VkDevice, VkDescriptorPool, const VkAllocationCallbacks*) {}
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateDescriptorSets(VkDevice, const VkDescriptorSetAllocateInfo* pAllocateInfo, VkDescriptorSet* pDescriptorSets)
+{
+	for (uint32_t i = 0; i < pAllocateInfo->descriptorSetCount; i++) pDescriptorSets[i] = fakeHandle<VkDescriptorSet>();
+	return VK_SUCCESS;
+}
+VKAPI_ATTR void VKAPI_CALL vkUpdateDescriptorSets(VkDevice, uint32_t, const VkWriteDescriptorSet*, uint32_t, const VkCopyDescriptorSet*) {}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateCommandPool(VkDevice, const VkCommandPoolCreateInfo*, const VkAllocationCallbacks*, VkCommandPool* pCommandPool) { *pCommandPool = fakeHandle<VkCommandPool>(); return VK_SUCCESS; }
+VKAPI_ATTR void VKAPI_CALL vkDestroyCommandPool(VkDevice, VkCommandPool, const VkAllocationCallbacks*) {}
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateCommandBuffers(VkDevice, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers)
+{
+	for (uint32_t i = 0; i < pAllocateInfo->commandBufferCount; i++) pCommandBuffers[i] = fakeHandle<VkCommandBuffer>();
+	return VK_SUCCESS;
+}
+VKAPI_ATTR void VKAPI_CALL vkFreeCommandBuffers(VkDevice, VkCommandPool, uint32_t, const VkCommandBuffer*) {}
+VKAPI_ATTR VkResult VKAPI_CALL vkBeginCommandBuffer(VkCommandBuffer, const VkCommandBufferBeginInfo*) { return VK_SUCCESS; }
+VKAPI_ATTR VkResult VKAPI_CALL vkEndCommandBuffer(VkCommandBuffer) { return VK_SUCCESS; }
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyBuffer(VkCommandBuffer, VkBuffer, VkBuffer, uint32_t, const VkBufferCopy*) {}
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyBufferToImage(VkCommandBuffer, VkBuffer, VkImage, VkImageLayout, uint32_t, const VkBufferImageCopy*) {}
+VKAPI_ATTR void VKAPI_CALL vkCmdBlitImage(VkCommandBuffer, VkImage, VkImageLayout, VkImage, VkImageLayout, uint32_t, const VkImageBlit*, VkFilter) {}
+VKAPI_ATTR void VKAPI_CALL vkCmdPipelineBarrier(VkCommandBuffer, VkPipelineStageFlags, VkPipelineStageFlags, VkDependencyFlags, uint32_t, const VkMemoryBarrier*, uint32_t, const VkBufferMemoryBarrier*,
+	uint32_t, const VkImageMemoryBarrier*) {}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateFence(VkDevice, const VkFenceCreateInfo*, const VkAllocationCallbacks*, VkFence* pFence) { *pFence = fakeHandle<VkFence>(); return VK_SUCCESS; }
+VKAPI_ATTR void VKAPI_CALL vkDestroyFence(VkDevice, VkFence, const VkAllocationCallbacks*) {}
+VKAPI_ATTR VkResult VKAPI_CALL vkGetFenceStatus(VkDevice, VkFence) { return VK_SUCCESS; }
+VKAPI_ATTR VkResult VKAPI_CALL vkWaitForFences(VkDevice, uint32_t, const VkFence*, VkBool32, uint64_t) { return VK_SUCCESS; }
+VKAPI_ATTR VkResult VKAPI_CALL vkCreateSemaphore(VkDevice, const VkSemaphoreCreateInfo*, const VkAllocationCallbacks*, VkSemaphore* pSemaphore) { *pSemaphore = fakeHandle<VkSemaphore>(); return VK_SUCCESS; }
+VKAPI_ATTR void VKAPI_CALL vkDestroySemaphore(VkDevice, VkSemaphore, const VkAllocationCallbacks*) {}
+VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(VkQueue, uint32_t, const VkSubmitInfo*, VkFence) { return VK_SUCCESS; }
+
+namespace
+{
+	/// @brief Allocations and bytes between construction and take()
+	class AllocationScope
+	{
+	public:
+		AllocationScope() : count(allocationCount.load()), bytes(allocatedBytes.load()) {}
+		std::pair<size_t, size_t> take() const { return { allocationCount.load() - count, allocatedBytes.load() - bytes }; }
+
+	private:
+		size_t count;
+		size_t bytes;
+	};
+
+	/// @brief What the renderer hands the mesh code
+	struct FakeRenderer
+	{
+		VkDevice device{ fakeHandle<VkDevice>() };
+		VkPhysicalDevice physicalDevice{ fakeHandle<VkPhysicalDevice>() };
+		VkQueue queue{ fakeHandle<VkQueue>() };
+		VkCommandPool commandPool{ fakeHandle<VkCommandPool>() };
+		VkDescriptorSetLayout descriptorSetLayout{ fakeHandle<VkDescriptorSetLayout>() };
+		GE::Util::StagingRing stagingRing;
+		GE::GraphicsUploadBatch uploadBatch;
+		GE::GraphicsMeshRegistry meshes;
+	};
+
+	std::array<GE::Vertex, 4> tileVertices(size_t tile)
+	{
+		// Every tile a color of its own, so each one is a mesh of its own
+		const glm::vec3 color(static_cast<float>(tile % 256) / 255.0f, static_cast<float>(tile / 256 % 256) / 255.0f, static_cast<float>(tile / 65536) / 255.0f);
+		return { {
+			{{-5.0f, -5.0f, 0.0f}, color, {1.0f, 0.0f}},
+			{{5.0f, -5.0f, 0.0f}, color, {0.0f, 0.0f}},
+			{{5.0f, 5.0f, 0.0f}, color, {0.0f, 1.0f}},
+			{{-5.0f, 5.0f, 0.0f}, color, {1.0f, 1.0f}},
+		} };
+	}
+	constexpr std::array<uint32_t, 6> TileIndices = { 0, 1, 2, 2, 3, 0 };
+
+	std::vector<GE::Vertex> gridVertices(size_t side)
+	{
+		std::vector<GE::Vertex> vertices;
+		for (size_t y = 0; y < side; y++) {
+			for (size_t x = 0; x < side; x++) {
+				const float u = static_cast<float>(x) / (side - 1);
+				const float v = static_cast<float>(y) / (side - 1);
+				vertices.push_back({ { u, 0.0f, v }, { 1.0f, 1.0f, 1.0f }, { u, v } });
+			}
+		}
+		return vertices;
+	}
+
+	std::vector<uint32_t> gridIndices(size_t side)
+	{
+		std::vector<uint32_t> indices;
+		for (size_t y = 0; y + 1 < side; y++) {
+			for (size_t x = 0; x + 1 < side; x++) {
+				const uint32_t a = static_cast<uint32_t>(y * side + x);
+				const uint32_t b = a + 1, c = a + static_cast<uint32_t>(side) + 1, d = a + static_cast<uint32_t>(side);
+				for (uint32_t index : { a, b, c, c, d, a }) indices.push_back(index);
+			}
+		}
+		return indices;
+	}
+
+	struct Counts
+	{
+		std::pair<size_t, size_t> create;
+		std::pair<size_t, size_t> frame;
+	};
+
+	/// @brief Creates count meshes the way addMesh does, then runs the frame that uploads them. The meshes are dropped
+	/// afterwards, outside the counts
+	template<typename AddMesh>
+	Counts run(FakeRenderer& renderer, size_t count, AddMesh addMesh)
+	{
+		std::vector<GE::MeshPtr> alive;
+		alive.reserve(count);
+		Counts counts;
+		{
+			AllocationScope scope;
+			for (size_t mesh = 0; mesh < count; mesh++) alive.push_back(addMesh(mesh));
+			counts.create = scope.take();
+		}
+		{
+			AllocationScope scope;
+			if (!renderer.uploadBatch.flush() || !renderer.uploadBatch.poll()) std::cout << "ERROR " << renderer.uploadBatch.getError() << std::endl;
+			counts.frame = scope.take();
+		}
+		for (const auto& mesh : alive) {
+			if (!mesh || !mesh->isReady()) { std::cout << "ERROR a mesh did not become drawable" << std::endl; break; }
+		}
+		return counts;
+	}
+
+	void report(const char* name, size_t meshes, const Counts& counts)
+	{
+		std::cout << "  " << name << ": " << static_cast<double>(counts.create.first) / meshes << " allocations, " << counts.create.second / meshes << " bytes per mesh, then "
+			<< counts.frame.first << " allocations (" << counts.frame.second << " bytes) for the frame that uploads all " << meshes << std::endl;
+	}
+
+	int printUsage()
+	{
+		std::cout << "usage: MeshIngestAllocations [--meshes n] [--grid n]" << std::endl;
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t meshes = 1000;
+	size_t gridSide = 64;
+	for (int i = 1; i < argc; i++) {
+		const std::string argument = argv[i];
+		if (argument == "--meshes" && i + 1 < argc) { meshes = std::max<size_t>(1, std::stoul(argv[++i])); }
+		else if (argument == "--grid" && i + 1 < argc) { gridSide = std::max<size_t>(2, std::stoul(argv[++i])); }
+		else { return printUsage(); }
+	}
+
+	FakeRenderer renderer;
+	if (!renderer.stagingRing.init(renderer.device, renderer.physicalDevice, GE::STAGING_RING_SIZE)) {
+		std::cout << "ERROR " << renderer.stagingRing.getError() << std::endl;
+		return 1;
+	}
+	GE::Util::useStagingRing(&renderer.stagingRing);
+	if (!renderer.uploadBatch.init(renderer.device, renderer.physicalDevice, renderer.queue, renderer.commandPool)) {
+		std::cout << "ERROR " << renderer.uploadBatch.getError() << std::endl;
+		return 1;
+	}
+	GE::useUploadBatch(&renderer.uploadBatch);
+
+	auto initSpans = [&renderer](std::span<const GE::Vertex> vertices, std::span<const uint32_t> indices, GE::VertexLayout layout) {
+		return renderer.meshes.acquire(GE::GraphicsMeshRegistry::keyForContent(vertices, indices, layout, GE::MeshResidency::Discard), [&](GE::VerticesHandle& mesh) {
+			return mesh.init(vertices, indices, renderer.device, renderer.physicalDevice, renderer.queue, renderer.commandPool, renderer.descriptorSetLayout, layout, GE::MeshResidency::Discard);
+		});
+	};
+	auto initVectors = [&renderer](std::vector<GE::Vertex> vertices, std::vector<uint32_t> indices, GE::VertexLayout layout) {
+		return renderer.meshes.acquire(GE::GraphicsMeshRegistry::keyForContent(vertices, indices, layout, GE::MeshResidency::Discard), [&](GE::VerticesHandle& mesh) {
+			return mesh.init(vertices, indices, renderer.device, renderer.physicalDevice, renderer.queue, renderer.commandPool, renderer.descriptorSetLayout, layout, GE::MeshResidency::Discard);
+		});
+	};
+
+	std::cout << "Tile quads, a new mesh each" << std::endl;
+	report("spans of a stack array", meshes, run(renderer, meshes, [&](size_t tile) {
+		const std::array<GE::Vertex, 4> vertices = tileVertices(tile);
+		return initSpans(vertices, TileIndices, GE::VertexLayout::Float);
+	}));
+	report("vectors by value", meshes, run(renderer, meshes, [&](size_t tile) {
+		const std::array<GE::Vertex, 4> quad = tileVertices(tile);
+		const std::vector<GE::Vertex> vertices(quad.begin(), quad.end());
+		const std::vector<uint32_t> indices(TileIndices.begin(), TileIndices.end());
+		return initVectors(vertices, indices, GE::VertexLayout::Float);
+	}));
+	{
+		const std::array<GE::Vertex, 4> vertices = tileVertices(0);
+		GE::MeshPtr shared = initSpans(vertices, TileIndices, GE::VertexLayout::Float);
+		report("spans, same quad from the registry", meshes, run(renderer, meshes, [&](size_t) { return initSpans(vertices, TileIndices, GE::VertexLayout::Float); }));
+	}
+
+	// Generated once, only handing it over is counted. The meshes share one registry entry per run, so each run creates
+	// a single mesh
+	const std::vector<GE::Vertex> vertices = gridVertices(gridSide);
+	const std::vector<uint32_t> indices = gridIndices(gridSide);
+	std::cout << "Grid " << gridSide << "x" << gridSide << ", packed to the compact layout" << std::endl;
+	report("spans", 1, run(renderer, 1, [&](size_t) { return initSpans(vertices, indices, GE::VertexLayout::Compact); }));
+	report("vectors by value", 1, run(renderer, 1, [&](size_t) { return initVectors(vertices, indices, GE::VertexLayout::Compact); }));
+
+	GE::useUploadBatch(nullptr);
+	renderer.uploadBatch.Free();
+	GE::Util::useStagingRing(nullptr);
+	renderer.stagingRing.Free();
+	return 0;
+}
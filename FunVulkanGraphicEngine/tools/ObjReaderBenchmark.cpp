@@ -0,0 +1,163 @@
+// Times the in-tree OBJ reader against tinyobjloader, which it replaced. Every input is loaded by both a few times and
+// the fastest run of each is reported, together with the triangle counts so a mismatch between the readers shows up.
+// Without inputs a synthetic OBJ of --size MB is written to the temp directory and read next to the bundled model.
+//
+// usage: ObjReaderBenchmark [model.obj ...] [--size MB] [--runs n] [--threads n]
+
+#include "GraphicEngine/Utility/ObjReader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+namespace
+{
+	namespace fs = std::filesystem;
+	using Clock = std::chrono::steady_clock;
+
+	constexpr const char* BundledModel = "models/viking_room.obj";
+
+	double elapsedMs(Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); }
+
+	/// @brief A grid of quads with positions and uvs, roughly sizeBytes of text. Quads so the readers fan polygons too
+	std::string writeSyntheticObj(const fs::path& path, size_t sizeBytes)
+	{
+		// Each grid point costs about 60 bytes of v and vt lines and each quad about 45 bytes of f line
+		const size_t side = std::max<size_t>(2, static_cast<size_t>(std::sqrt(static_cast<double>(sizeBytes) / 105.0)));
+		std::ofstream output(path, std::ios::binary | std::ios::trunc);
+		if (!output.is_open()) return "failed to create " + path.string();
+
+		char buffer[128];
+		for (size_t y = 0; y < side; y++) {
+			for (size_t x = 0; x < side; x++) {
+				const float u = static_cast<float>(x) / (side - 1);
+				const float v = static_cast<float>(y) / (side - 1);
+				const int length = std::snprintf(buffer, sizeof(buffer), "v %.6f %.6f %.6f\nvt %.6f %.6f\n", u * 100.0f, std::sin(u * 20.0f) * std::cos(v * 20.0f), v * 100.0f, u, v);
+				output.write(buffer, length);
+			}
+		}
+		for (size_t y = 0; y + 1 < side; y++) {
+			for (size_t x = 0; x + 1 < side; x++) {
+				const size_t a = y * side + x + 1; // OBJ indices start at 1
+				const size_t b = a + 1, c = a + side + 1, d = a + side;
+				const int length = std::snprintf(buffer, sizeof(buffer), "f %zu/%zu %zu/%zu %zu/%zu %zu/%zu\n", a, a, b, b, c, c, d, d);
+				output.write(buffer, length);
+			}
+		}
+		if (!output.good()) return "failed to write " + path.string();
+		return "";
+	}
+
+	struct Timing
+	{
+		double bestMs{ 0.0 };
+		size_t triangles{ 0 };
+		std::string error;
+	};
+
+	template<typename Load>
+	Timing timeRuns(int runs, Load load)
+	{
+		Timing timing;
+		timing.bestMs = 1e300;
+		for (int run = 0; run < runs && timing.error.empty(); run++) {
+			const auto start = Clock::now();
+			timing.error = load(timing.triangles);
+			timing.bestMs = std::min(timing.bestMs, elapsedMs(start));
+		}
+		return timing;
+	}
+
+	void benchmark(const std::string& path, int runs, unsigned threadCount)
+	{
+		std::error_code errorCode;
+		const double megabytes = static_cast<double>(fs::file_size(path, errorCode)) / (1024.0 * 1024.0);
+		if (errorCode) {
+			std::cout << "ERROR " << path << " does not exist" << std::endl;
+			return;
+		}
+
+		const Timing inTree = timeRuns(runs, [&](size_t& triangles) -> std::string {
+			GE::Util::ObjMesh mesh;
+			auto errorMessage = GE::Util::readObj(path, mesh, threadCount);
+			triangles = mesh.corners.size() / 3;
+			return errorMessage;
+		});
+		const Timing reference = timeRuns(runs, [&](size_t& triangles) -> std::string {
+			tinyobj::attrib_t attrib;
+			std::vector<tinyobj::shape_t> shapes;
+			std::vector<tinyobj::material_t> materials;
+			std::string warn, err;
+			if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str())) return warn + err;
+			triangles = 0;
+			for (const auto& shape : shapes) triangles += shape.mesh.indices.size() / 3;
+			return "";
+		});
+
+		auto report = [megabytes](const char* name, const Timing& timing) {
+			if (!timing.error.empty()) { std::cout << "  ERROR " << name << ": " << timing.error << std::endl; return; }
+			std::cout << "  " << name << ": " << timing.bestMs << " ms, " << megabytes / (timing.bestMs / 1000.0) << " MB/s, " << timing.triangles << " triangles" << std::endl;
+		};
+		std::cout << path << " (" << megabytes << " MB)" << std::endl;
+		report("readObj", inTree);
+		report("tinyobj::LoadObj", reference);
+		if (inTree.error.empty() && reference.error.empty()) {
+			std::cout << "  readObj is " << reference.bestMs / inTree.bestMs << "x as fast" << std::endl;
+			if (inTree.triangles != reference.triangles) std::cout << "  WARNING the readers disagree on the triangle count" << std::endl;
+		}
+	}
+
+	int printUsage()
+	{
+		std::cout << "usage: ObjReaderBenchmark [model.obj ...] [--size MB] [--runs n] [--threads n]" << std::endl;
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> inputs;
+	size_t sizeMegabytes = 50;
+	int runs = 3;
+	unsigned threadCount = 0;
+	for (int i = 1; i < argc; i++) {
+		const std::string argument = argv[i];
+		if (argument == "--size" && i + 1 < argc) { sizeMegabytes = std::stoul(argv[++i]); }
+		else if (argument == "--runs" && i + 1 < argc) { runs = std::max(1, std::stoi(argv[++i])); }
+		else if (argument == "--threads" && i + 1 < argc) { threadCount = static_cast<unsigned>(std::stoul(argv[++i])); }
+		else if (argument.rfind("--", 0) == 0) { return printUsage(); }
+		else { inputs.push_back(argument); }
+	}
+
+	fs::path synthetic;
+	if (inputs.empty()) {
+		synthetic = fs::temp_directory_path() / "ObjReaderBenchmark.obj";
+		const auto start = Clock::now();
+		if (auto errorMessage = writeSyntheticObj(synthetic, sizeMegabytes * 1024 * 1024); !errorMessage.empty()) {
+			std::cout << "ERROR " << errorMessage << std::endl;
+			return 1;
+		}
+		std::cout << "Wrote " << synthetic.string() << " in " << elapsedMs(start) << " ms" << std::endl;
+		inputs.push_back(synthetic.string());
+		std::error_code errorCode;
+		if (fs::exists(BundledModel, errorCode)) inputs.push_back(BundledModel);
+		else std::cout << "WARNING " << BundledModel << " not found, run from the bin directory to include it" << std::endl;
+	}
+
+	for (const auto& input : inputs) benchmark(input, runs, threadCount);
+
+	if (!synthetic.empty()) {
+		std::error_code errorCode;
+		fs::remove(synthetic, errorCode);
+	}
+	return 0;
+}
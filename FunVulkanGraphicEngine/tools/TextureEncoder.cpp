@@ -0,0 +1,59 @@
+// Offline encoder for the engine texture container (.gtex).
+// Bakes the whole mip chain and optionally block compresses it, so the engine can upload every level with one copy.
+//
+// usage: TextureEncoder <input image> [output.gtex] [--format auto|rgba|bc1|bc3]
+// auto picks bc1 for opaque images and bc3 when any pixel has alpha
+
+#include "GraphicEngine/Utility/TextureBaker.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+namespace
+{
+	int printUsage()
+	{
+		std::cout << "usage: TextureEncoder <input image> [output.gtex] [--format auto|rgba|bc1|bc3]" << std::endl;
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string inputPath;
+	std::string outputPath;
+	std::string formatArgument = "auto";
+	for (int i = 1; i < argc; i++) {
+		const std::string argument = argv[i];
+		if (argument == "--format" && i + 1 < argc) { formatArgument = argv[++i]; }
+		else if (inputPath.empty()) { inputPath = argument; }
+		else if (outputPath.empty()) { outputPath = argument; }
+		else { return printUsage(); }
+	}
+	if (inputPath.empty()) return printUsage();
+	if (outputPath.empty()) outputPath = std::filesystem::path(inputPath).replace_extension(GE::Util::TextureContainer::Extension).string();
+
+	std::optional<GE::Util::TextureFormat> format;
+	if (formatArgument == "rgba") format = GE::Util::TextureFormat::RGBA8_SRGB;
+	else if (formatArgument == "bc1") format = GE::Util::TextureFormat::BC1_SRGB;
+	else if (formatArgument == "bc3") format = GE::Util::TextureFormat::BC3_SRGB;
+	else if (formatArgument != "auto") return printUsage();
+
+	const auto start = std::chrono::steady_clock::now();
+	GE::Util::TextureBakeReport report;
+	if (auto errorMessage = GE::Util::bakeTexture(inputPath, outputPath, format, &report); !errorMessage.empty()) {
+		std::cout << "ERROR " << errorMessage << std::endl;
+		return 1;
+	}
+
+	std::cout << inputPath << " -> " << outputPath << " (" << report.width << "x" << report.height << ", " << report.levelCount << " levels, " << GE::Util::textureFormatName(report.format) << ") "
+		<< report.uncompressedBytes / 1024 << " KB -> " << report.encodedBytes / 1024 << " KB in "
+		<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+	return 0;
+}
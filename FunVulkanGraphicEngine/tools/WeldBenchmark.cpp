@@ -0,0 +1,164 @@
+// Times vertex welding the way mesh import does it. The std::unordered_map loop it replaced (two lookups per corner)
+// runs next to the flat welder on one thread and the sharded welder on every core. The best of a few runs is reported,
+// and the welder outputs are checked against the sequential one.
+// Inputs are the corners of the bundled model and a generated grid with --indices corners.
+//
+// usage: WeldBenchmark [model.obj ...] [--indices n] [--runs n] [--threads n]
+
+#include "GraphicEngine/Utility/ObjReader.hpp"
+#include "GraphicEngine/Utility/VertexWelder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	constexpr const char* BundledModel = "models/viking_room.obj";
+
+	double elapsedMs(Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); }
+
+	/// @brief Vertex::operator== lives with the vulkan code, the welder compares raw bytes as well
+	struct RawEqual
+	{
+		bool operator()(const GE::Vertex& a, const GE::Vertex& b) const { return std::memcmp(&a, &b, sizeof(GE::Vertex)) == 0; }
+	};
+
+	/// @brief One corner per index, built the way mesh import builds them
+	std::string objCorners(const std::string& path, std::vector<GE::Vertex>& corners)
+	{
+		GE::Util::ObjMesh mesh;
+		if (auto errorMessage = GE::Util::readObj(path, mesh); !errorMessage.empty()) return path + ": " + errorMessage;
+		corners.resize(mesh.corners.size());
+		for (size_t i = 0; i < corners.size(); i++) {
+			const auto& corner = mesh.corners[i];
+			GE::Vertex& vertex = corners[i];
+			vertex.pos = { mesh.positions[3 * corner.position + 0], mesh.positions[3 * corner.position + 1], mesh.positions[3 * corner.position + 2] };
+			if (corner.texcoord >= 0) vertex.texCoord = { mesh.texcoords[2 * corner.texcoord + 0], 1.0f - mesh.texcoords[2 * corner.texcoord + 1] };
+			vertex.color = { 1.0f, 1.0f, 1.0f };
+		}
+		return "";
+	}
+
+	/// @brief Two triangles per grid cell, so most vertices are shared by six corners like in a real mesh
+	std::vector<GE::Vertex> gridCorners(size_t indexCount)
+	{
+		const size_t side = std::max<size_t>(2, static_cast<size_t>(std::sqrt(static_cast<double>(indexCount) / 6.0)) + 1);
+		auto vertexAt = [side](size_t x, size_t y) {
+			GE::Vertex vertex{};
+			const float u = static_cast<float>(x) / (side - 1);
+			const float v = static_cast<float>(y) / (side - 1);
+			vertex.pos = { u, std::sin(u * 20.0f) * std::cos(v * 20.0f), v };
+			vertex.color = { 1.0f, 1.0f, 1.0f };
+			vertex.texCoord = { u, v };
+			return vertex;
+		};
+		std::vector<GE::Vertex> corners;
+		corners.reserve(6 * (side - 1) * (side - 1));
+		for (size_t y = 0; y + 1 < side && corners.size() < indexCount; y++) {
+			for (size_t x = 0; x + 1 < side && corners.size() < indexCount; x++) {
+				for (auto [dx, dy] : { std::pair<size_t, size_t>{ 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 0 }, { 1, 1 }, { 0, 1 } }) corners.push_back(vertexAt(x + dx, y + dy));
+			}
+		}
+		return corners;
+	}
+
+	void weldUnorderedMap(const std::vector<GE::Vertex>& corners, std::vector<GE::Vertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		std::unordered_map<GE::Vertex, uint32_t, std::hash<GE::Vertex>, RawEqual> uniqueVertices;
+		vertices.clear();
+		indices.clear();
+		for (const auto& vertex : corners) {
+			if (uniqueVertices.count(vertex) == 0) {
+				uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+				vertices.push_back(vertex);
+			}
+			indices.push_back(uniqueVertices[vertex]);
+		}
+	}
+
+	double bestOf(int runs, const std::function<void()>& run)
+	{
+		double best = 1e300;
+		for (int i = 0; i < runs; i++) {
+			const auto start = Clock::now();
+			run();
+			best = std::min(best, elapsedMs(start));
+		}
+		return best;
+	}
+
+	bool sameWeld(const std::vector<GE::Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<GE::Vertex>& expectedVertices, const std::vector<uint32_t>& expectedIndices)
+	{
+		return indices == expectedIndices && vertices.size() == expectedVertices.size()
+			&& std::memcmp(vertices.data(), expectedVertices.data(), vertices.size() * sizeof(GE::Vertex)) == 0;
+	}
+
+	void benchmark(const std::string& name, const std::vector<GE::Vertex>& corners, int runs, unsigned threadCount)
+	{
+		std::vector<GE::Vertex> expectedVertices, vertices;
+		std::vector<uint32_t> expectedIndices, indices;
+
+		const double mapMs = bestOf(runs, [&]() { weldUnorderedMap(corners, vertices, indices); });
+		GE::Util::weldVertices(corners, expectedVertices, expectedIndices, 1);
+		const bool mapMatches = sameWeld(vertices, indices, expectedVertices, expectedIndices);
+		const double flatMs = bestOf(runs, [&]() { GE::Util::weldVertices(corners, expectedVertices, expectedIndices, 1); });
+		const double shardedMs = bestOf(runs, [&]() { GE::Util::weldVertices(corners, vertices, indices, threadCount); });
+		const bool shardedMatches = sameWeld(vertices, indices, expectedVertices, expectedIndices);
+
+		std::cout << name << ": " << corners.size() << " corners, " << expectedVertices.size() << " unique vertices" << std::endl;
+		std::cout << "  unordered_map: " << mapMs << " ms" << std::endl;
+		std::cout << "  flat welder, 1 thread: " << flatMs << " ms (" << mapMs / flatMs << "x)" << std::endl;
+		std::cout << "  sharded welder, " << threadCount << " threads: " << shardedMs << " ms (" << mapMs / shardedMs << "x)" << std::endl;
+		if (!mapMatches) std::cout << "  WARNING unordered_map and the welder disagree" << std::endl;
+		if (!shardedMatches) std::cout << "  ERROR the sharded weld differs from the sequential one" << std::endl;
+	}
+
+	int printUsage()
+	{
+		std::cout << "usage: WeldBenchmark [model.obj ...] [--indices n] [--runs n] [--threads n]" << std::endl;
+		return 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> models;
+	size_t indexCount = 5'000'000;
+	int runs = 3;
+	unsigned threadCount = std::max(2u, std::thread::hardware_concurrency());
+	for (int i = 1; i < argc; i++) {
+		const std::string argument = argv[i];
+		if (argument == "--indices" && i + 1 < argc) { indexCount = std::stoul(argv[++i]); }
+		else if (argument == "--runs" && i + 1 < argc) { runs = std::max(1, std::stoi(argv[++i])); }
+		else if (argument == "--threads" && i + 1 < argc) { threadCount = std::max(1u, static_cast<unsigned>(std::stoul(argv[++i]))); }
+		else if (argument.rfind("--", 0) == 0) { return printUsage(); }
+		else { models.push_back(argument); }
+	}
+	if (models.empty()) {
+		std::error_code errorCode;
+		if (std::filesystem::exists(BundledModel, errorCode)) models.push_back(BundledModel);
+		else std::cout << "WARNING " << BundledModel << " not found, run from the bin directory to include it" << std::endl;
+	}
+
+	for (const auto& model : models) {
+		std::vector<GE::Vertex> corners;
+		if (auto errorMessage = objCorners(model, corners); !errorMessage.empty()) {
+			std::cout << "ERROR " << errorMessage << std::endl;
+			continue;
+		}
+		benchmark(model, corners, runs, threadCount);
+	}
+	benchmark("generated grid", gridCorners(indexCount), runs, threadCount);
+	return 0;
+}
@@ -12,6 +12,7 @@ C:\Libs\VulkanSDK\Bin/glslc.exe shader.vert -o compiled/vert.spv
 
 C:\Libs\VulkanSDK\Bin/glslc.exe shader_alterColor.frag -o compiled/fragAlter.spv
 C:\Libs\VulkanSDK\Bin/glslc.exe shader.frag -o compiled/frag.spv
+C:\Libs\VulkanSDK\Bin/glslc.exe shader_solid.frag -o compiled/fragSolid.spv
 
 
 
@@ -22,4 +23,17 @@ if not exist "%BinDirectory%\" (
 
 robocopy "%CompileDirectory%" "%BinDirectory%/shaders" /E
 robocopy "textures" "%BinDirectory%/textures" /E
-robocopy "models" "%BinDirectory%/models" /E
\ No newline at end of file
+robocopy "models" "%BinDirectory%/models" /E
+
+
+rem Bake meshes and textures ahead of time so the engine never builds them on first load, once the cooker is built
+if exist "%BinDirectory%/FunVulkanGraphicEngineCooker.exe" (
+    "%BinDirectory%/FunVulkanGraphicEngineCooker.exe" . "%BinDirectory%"
+)
+
+rem One pack for the engine to map instead of the loose files, once the AssetPacker tool is built
+if exist "%BinDirectory%/AssetPacker.exe" (
+    pushd "%BinDirectory%"
+    AssetPacker.exe assets.gepk shaders models textures
+    popd
+)
\ No newline at end of file
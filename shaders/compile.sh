@@ -10,6 +10,7 @@ fi
 
 /home/user/Code_Libraries/vulkan/bin/glslc shader.vert -o compiled/vert.spv
 /home/user/Code_Libraries/vulkan/bin/glslc shader.frag -o compiled/frag.spv
+/home/user/Code_Libraries/vulkan/bin/glslc shader_solid.frag -o compiled/fragSolid.spv
 
 
 
@@ -19,4 +20,14 @@ fi
 
 cp -r "$CompileDirectory" "$BinDirectory/shaders"
 cp -r "textures" "$BinDirectory/textures"
-cp -r "models" "$BinDirectory/models"
\ No newline at end of file
+cp -r "models" "$BinDirectory/models"
+
+# Bake meshes and textures ahead of time so the engine never builds them on first load, once the cooker is built
+if [ -x "$BinDirectory/FunVulkanGraphicEngineCooker" ]; then
+	"$BinDirectory/FunVulkanGraphicEngineCooker" . "$BinDirectory"
+fi
+
+# One pack for the engine to map instead of the loose files, once the AssetPacker tool is built
+if [ -x "$BinDirectory/AssetPacker" ]; then
+	(cd "$BinDirectory" && ./AssetPacker assets.gepk shaders models textures)
+fi
\ No newline at end of file
@@ -1,5 +1,9 @@
 #version 450
 
+layout(binding = 0) uniform MaterialUniforms {
+    vec4 uvScaleOffset;
+    vec4 tint;
+} material;
 layout(binding = 1) uniform sampler2D texSampler;
 
 layout(location = 0) in vec3 fragColor;
@@ -8,6 +12,6 @@ layout(location = 1) in vec2 fragTexCoord;
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = texture(texSampler, fragTexCoord);
+    outColor = texture(texSampler, fragTexCoord) * material.tint;
     //outColor = vec4(fragTexCoord, 0.0, 1.0);
 }
\ No newline at end of file
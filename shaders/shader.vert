@@ -1,12 +1,15 @@
 #version 450
 
-layout(binding = 0) uniform UniformBufferObject {
-    //vec2 foo; //dummy to show how allignment works
+layout(binding = 0) uniform MaterialUniforms {
     // Allignment is very important when allocating memory. c++ class members need to be multiple of 16
-    mat4 model;
-    mat4 view;
-    mat4 proj;
-} ubo;
+    vec4 uvScaleOffset; // where the texture sits in its atlas page, (1, 1, 0, 0) for a texture of its own
+    vec4 tint;
+} material;
+
+// Per object, pushed with every draw so all objects of a material share its descriptor set
+layout(push_constant) uniform ObjectConstants {
+    mat4 modelViewProj;
+} object;
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
@@ -16,8 +19,8 @@ layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    gl_Position = object.modelViewProj * vec4(inPosition, 1.0);
     //gl_Position = vec4(inPosition, 0.0, 1.0);
     fragColor = inColor;
-    fragTexCoord = inTexCoord;
+    fragTexCoord = inTexCoord * material.uvScaleOffset.xy + material.uvScaleOffset.zw;
 }
\ No newline at end of file
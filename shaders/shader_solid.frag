@@ -0,0 +1,16 @@
+#version 450
+
+layout(binding = 0) uniform MaterialUniforms {
+    vec4 uvScaleOffset;
+    vec4 tint;
+} material;
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+// Solid color material. No sampler is bound, the color comes from the vertices
+void main() {
+    outColor = vec4(fragColor, 1.0) * material.tint;
+}
\ No newline at end of file